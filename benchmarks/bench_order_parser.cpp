@@ -0,0 +1,83 @@
+#include <benchmark/benchmark.h>
+#include "market_data/BinaryProtocol.h"
+#include "market_data/OrderMessageParser.h"
+#include <nlohmann/json.hpp>
+#include <string>
+
+using json = nlohmann::json;
+
+namespace {
+
+const std::string kDirectOrder =
+    R"({"type":"limit","symbol":"BTC-USD","side":"buy","price":50012.35,"quantity":7})";
+
+const std::string kSubscribeEcho =
+    R"({"type":"subscribe","symbol":"{\"type\":\"limit\",\"symbol\":\"BTC-USD\",\"side\":\"buy\",\"price\":50012.35,\"quantity\":7}"})";
+
+// What the handler used to do: a DOM per frame plus map lookups per field
+ParsedOrder decode_with_dom(const json& order_data) {
+    ParsedOrder order{};
+    order.symbol_id = *SymbolTable::instance().find(order_data["symbol"].get<std::string>());
+    order.type = OrderType::LIMIT;
+    order.side = (order_data["side"] == "buy") ? OrderSide::BUY : OrderSide::SELL;
+    order.price = order_data["price"];
+    order.quantity = order_data["quantity"];
+    return order;
+}
+
+void BM_Nlohmann_DirectOrder(benchmark::State& state) {
+    SymbolTable::instance().intern("BTC-USD");
+    for (auto _ : state) {
+        json msg = json::parse(kDirectOrder);
+        benchmark::DoNotOptimize(decode_with_dom(msg));
+    }
+}
+BENCHMARK(BM_Nlohmann_DirectOrder);
+
+void BM_Parser_DirectOrder(benchmark::State& state) {
+    SymbolTable::instance().intern("BTC-USD");
+    ParsedOrder order{};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(OrderMessageParser::parse(kDirectOrder, order));
+        benchmark::DoNotOptimize(order);
+    }
+    state.counters["bytes"] = kDirectOrder.size();
+}
+BENCHMARK(BM_Parser_DirectOrder);
+
+void BM_Nlohmann_SubscribeEcho(benchmark::State& state) {
+    SymbolTable::instance().intern("BTC-USD");
+    for (auto _ : state) {
+        json msg = json::parse(kSubscribeEcho);
+        json order_data = json::parse(msg["symbol"].get<std::string>());
+        benchmark::DoNotOptimize(decode_with_dom(order_data));
+    }
+}
+BENCHMARK(BM_Nlohmann_SubscribeEcho);
+
+void BM_Parser_SubscribeEcho(benchmark::State& state) {
+    SymbolTable::instance().intern("BTC-USD");
+    ParsedOrder order{};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(OrderMessageParser::parse(kSubscribeEcho, order));
+        benchmark::DoNotOptimize(order);
+    }
+}
+BENCHMARK(BM_Parser_SubscribeEcho);
+
+// Same order as a binary frame: validate the header and copy the struct out
+void BM_Binary_NewOrder(benchmark::State& state) {
+    const SymbolId id = SymbolTable::instance().intern("BTC-USD");
+    const wire::NewOrder frame = wire::make_new_order(1, id, OrderSide::BUY, OrderType::LIMIT, 5001235, 7);
+    wire::Message msg;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(wire::decode(&frame, sizeof(frame), msg));
+        benchmark::DoNotOptimize(msg);
+    }
+    state.counters["bytes"] = sizeof(frame);
+}
+BENCHMARK(BM_Binary_NewOrder);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,680 @@
+#include <benchmark/benchmark.h>
+#include "common/LatencyHistogram.h"
+#include "common/Logger.h"
+#include "market_data/MarketDataFeed.h"
+#include "market_data/OrderMessageParser.h"
+#include "order_book/BookManager.h"
+#include "order_book/OrderBook.h"
+#include "order_book/OrderIndex.h"
+#include "persistence/Journal.h"
+#include "risk/MarkToMarket.h"
+#include "risk/RiskEngine.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Each benchmark times only the operation under test with steady_clock and
+// reports that time to Google Benchmark through UseManualTime(), so per-iteration
+// setup (re-seeding a level, replacing a cancelled order) stays out of the
+// numbers. Every operation is also recorded in a LatencyHistogram whose
+// p50/p99/p99.9 are attached as counters; they include ~20 ns of clock overhead.
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+constexpr Price kMidPrice = 100000;  // 1000.00 at the default tick
+constexpr uint64_t kOrdersPerLevel = 5;
+constexpr uint64_t kOrderQuantity = 10;
+
+SymbolId bench_symbol() {
+    static const SymbolId id = SymbolTable::instance().intern("BENCH-USD");
+    return id;
+}
+
+// Matching threads own their books, so benchmark the unlocked configuration
+OrderBookConfig bench_config(size_t levels) {
+    OrderBookConfig config;
+    config.synchronized = false;
+    config.ladder_levels = 4 * levels;
+    config.initial_order_capacity = 2 * levels * kOrdersPerLevel + 1024;
+    return config;
+}
+
+class Timer {
+public:
+    void start() { start_ = Clock::now(); }
+    // Records the elapsed time in `histogram` and returns it in seconds
+    double stop(LatencyHistogram& histogram) {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_).count();
+        histogram.record(static_cast<uint64_t>(ns));
+        return static_cast<double>(ns) * 1e-9;
+    }
+
+private:
+    Clock::time_point start_;
+};
+
+void report(benchmark::State& state, const LatencyHistogram& histogram) {
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    state.counters["p50_ns"] = static_cast<double>(histogram.percentile(50));
+    state.counters["p99_ns"] = static_cast<double>(histogram.percentile(99));
+    state.counters["p99.9_ns"] = static_cast<double>(histogram.percentile(99.9));
+}
+
+// Fills `levels` price levels on each side around kMidPrice; returns the next free order id
+uint64_t fill_book(OrderBook& book, size_t levels, uint64_t next_id = 1) {
+    for (size_t level = 1; level <= levels; ++level) {
+        for (uint64_t i = 0; i < kOrdersPerLevel; ++i) {
+            book.add_order(Order(next_id++, bench_symbol(), OrderType::LIMIT, OrderSide::BUY,
+                                 kMidPrice - static_cast<Price>(level), kOrderQuantity));
+            book.add_order(Order(next_id++, bench_symbol(), OrderType::LIMIT, OrderSide::SELL,
+                                 kMidPrice + static_cast<Price>(level), kOrderQuantity));
+        }
+    }
+    return next_id;
+}
+
+// Random passive price offsets drawn up front so the RNG stays out of the timings
+std::vector<Price> passive_offsets(size_t levels) {
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<Price> offset(1, static_cast<Price>(levels));
+    std::vector<Price> offsets(1 << 16);
+    for (Price& p : offsets) {
+        p = offset(rng);
+    }
+    return offsets;
+}
+
+// Resting order added behind existing orders at a random depth
+void BM_AddPassive(benchmark::State& state) {
+    const size_t levels = static_cast<size_t>(state.range(0));
+    OrderBook book(bench_config(levels));
+    uint64_t next_id = fill_book(book, levels);
+    const std::vector<Price> offsets = passive_offsets(levels);
+    LatencyHistogram histogram;
+    Timer timer;
+    size_t i = 0;
+
+    for (auto _ : state) {
+        const uint64_t id = next_id++;
+        const OrderSide side = (i & 1) ? OrderSide::SELL : OrderSide::BUY;
+        const Price offset = offsets[i++ & (offsets.size() - 1)];
+        const Order order(id, bench_symbol(), OrderType::LIMIT, side,
+                          side == OrderSide::BUY ? kMidPrice - offset : kMidPrice + offset, kOrderQuantity);
+        timer.start();
+        book.add_order(order);
+        state.SetIterationTime(timer.stop(histogram));
+        book.cancel_order(id);
+    }
+    report(state, histogram);
+}
+BENCHMARK(BM_AddPassive)->Arg(10)->Arg(100)->Arg(1000)->UseManualTime();
+
+// Aggressive order that fully fills the first order at the best ask
+void BM_AddCrossing(benchmark::State& state) {
+    const size_t levels = static_cast<size_t>(state.range(0));
+    OrderBook book(bench_config(levels));
+    uint64_t next_id = fill_book(book, levels);
+    LatencyHistogram histogram;
+    Timer timer;
+
+    for (auto _ : state) {
+        const Order buy(next_id++, bench_symbol(), OrderType::LIMIT, OrderSide::BUY, kMidPrice + 1, kOrderQuantity);
+        timer.start();
+        book.add_order(buy);
+        state.SetIterationTime(timer.stop(histogram));
+        // Put the consumed liquidity back at the end of the queue
+        book.add_order(Order(next_id++, bench_symbol(), OrderType::LIMIT, OrderSide::SELL, kMidPrice + 1,
+                             kOrderQuantity));
+    }
+    report(state, histogram);
+}
+BENCHMARK(BM_AddCrossing)->Arg(10)->Arg(100)->Arg(1000)->UseManualTime();
+
+// Cancel of a random live order anywhere in the book
+void BM_Cancel(benchmark::State& state) {
+    const size_t levels = static_cast<size_t>(state.range(0));
+    OrderBook book(bench_config(levels));
+    const uint64_t first_id = 1;
+    uint64_t next_id = fill_book(book, levels, first_id);
+    const std::vector<Price> offsets = passive_offsets(levels);
+
+    std::vector<uint64_t> live_ids;
+    for (uint64_t id = first_id; id < next_id; ++id) {
+        live_ids.push_back(id);
+    }
+    std::mt19937_64 rng(7);
+    std::vector<size_t> victims(1 << 16);
+    for (size_t& v : victims) {
+        v = static_cast<size_t>(rng() % live_ids.size());
+    }
+
+    LatencyHistogram histogram;
+    Timer timer;
+    size_t i = 0;
+    for (auto _ : state) {
+        const size_t slot = victims[i & (victims.size() - 1)];
+        timer.start();
+        book.cancel_order(live_ids[slot]);
+        state.SetIterationTime(timer.stop(histogram));
+
+        // Replace it so the book keeps its depth
+        const OrderSide side = (i & 1) ? OrderSide::SELL : OrderSide::BUY;
+        const Price offset = offsets[i++ & (offsets.size() - 1)];
+        live_ids[slot] = next_id++;
+        book.add_order(Order(live_ids[slot], bench_symbol(), OrderType::LIMIT, side,
+                             side == OrderSide::BUY ? kMidPrice - offset : kMidPrice + offset, kOrderQuantity));
+    }
+    report(state, histogram);
+}
+BENCHMARK(BM_Cancel)->Arg(10)->Arg(100)->Arg(1000)->UseManualTime();
+
+// fill_book() ids alternate buy/sell starting with a buy at id 1
+OrderSide fill_book_side(uint64_t id) {
+    return (id & 1) ? OrderSide::BUY : OrderSide::SELL;
+}
+
+// Same-price size reduction of a random live order, which keeps its queue position
+void BM_ModifyInPlace(benchmark::State& state) {
+    const size_t levels = static_cast<size_t>(state.range(0));
+    OrderBook book(bench_config(levels));
+    const uint64_t last_id = fill_book(book, levels) - 1;
+    std::vector<uint64_t> remaining(last_id + 1, kOrderQuantity);
+    std::vector<Price> prices(last_id + 1);
+    for (uint64_t id = 1; id <= last_id; ++id) {
+        const Price level = static_cast<Price>((id - 1) / (2 * kOrdersPerLevel) + 1);
+        prices[id] = fill_book_side(id) == OrderSide::BUY ? kMidPrice - level : kMidPrice + level;
+    }
+    std::mt19937_64 rng(7);
+    std::vector<uint64_t> targets(1 << 16);
+    for (uint64_t& id : targets) {
+        id = 1 + rng() % last_id;
+    }
+
+    LatencyHistogram histogram;
+    Timer timer;
+    size_t i = 0;
+    for (auto _ : state) {
+        const uint64_t id = targets[i++ & (targets.size() - 1)];
+        if (remaining[id] == 1) {
+            // Top the order back up; this re-queues it, outside the timing
+            book.modify_order(id, prices[id], kOrderQuantity);
+            remaining[id] = kOrderQuantity;
+        }
+        timer.start();
+        book.modify_order(id, prices[id], --remaining[id]);
+        state.SetIterationTime(timer.stop(histogram));
+    }
+    report(state, histogram);
+}
+BENCHMARK(BM_ModifyInPlace)->Arg(10)->Arg(100)->Arg(1000)->UseManualTime();
+
+// Random live order moved to a new passive price on its own side
+void BM_ModifyReprice(benchmark::State& state) {
+    const size_t levels = static_cast<size_t>(state.range(0));
+    OrderBook book(bench_config(levels));
+    const uint64_t last_id = fill_book(book, levels) - 1;
+    const std::vector<Price> offsets = passive_offsets(levels);
+    std::mt19937_64 rng(7);
+    std::vector<uint64_t> targets(1 << 16);
+    for (uint64_t& id : targets) {
+        id = 1 + rng() % last_id;
+    }
+
+    LatencyHistogram histogram;
+    Timer timer;
+    size_t i = 0;
+    for (auto _ : state) {
+        const uint64_t id = targets[i & (targets.size() - 1)];
+        const Price offset = offsets[i++ & (offsets.size() - 1)];
+        const Price price = fill_book_side(id) == OrderSide::BUY ? kMidPrice - offset : kMidPrice + offset;
+        timer.start();
+        book.modify_order(id, price, kOrderQuantity);
+        state.SetIterationTime(timer.stop(histogram));
+    }
+    report(state, histogram);
+}
+BENCHMARK(BM_ModifyReprice)->Arg(10)->Arg(100)->Arg(1000)->UseManualTime();
+
+// One order that sweeps every ask level, one resting order per level
+void BM_Sweep(benchmark::State& state) {
+    const size_t levels = static_cast<size_t>(state.range(0));
+    OrderBook book(bench_config(levels));
+    uint64_t next_id = 1;
+    LatencyHistogram histogram;
+    Timer timer;
+
+    for (auto _ : state) {
+        for (size_t level = 1; level <= levels; ++level) {
+            book.add_order(Order(next_id++, bench_symbol(), OrderType::LIMIT, OrderSide::SELL,
+                                 kMidPrice + static_cast<Price>(level), kOrderQuantity));
+        }
+        const Order sweep(next_id++, bench_symbol(), OrderType::LIMIT, OrderSide::BUY,
+                          kMidPrice + static_cast<Price>(levels), levels * kOrderQuantity);
+        timer.start();
+        book.add_order(sweep);
+        state.SetIterationTime(timer.stop(histogram));
+    }
+    report(state, histogram);
+    state.counters["levels_per_sec"] =
+        benchmark::Counter(static_cast<double>(state.iterations() * levels), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Sweep)->Arg(10)->Arg(100)->Arg(1000)->UseManualTime();
+
+// Top-20 depth snapshot into a caller buffer
+void BM_GetDepth(benchmark::State& state) {
+    const size_t levels = static_cast<size_t>(state.range(0));
+    OrderBook book(bench_config(levels));
+    fill_book(book, levels);
+    DepthLevel depth[20];
+    LatencyHistogram histogram;
+    Timer timer;
+    size_t i = 0;
+
+    for (auto _ : state) {
+        timer.start();
+        const size_t written = book.get_depth((i++ & 1) ? OrderSide::SELL : OrderSide::BUY, depth, 20);
+        state.SetIterationTime(timer.stop(histogram));
+        benchmark::DoNotOptimize(written);
+        benchmark::DoNotOptimize(depth);
+    }
+    report(state, histogram);
+}
+BENCHMARK(BM_GetDepth)->Arg(10)->Arg(100)->Arg(1000)->UseManualTime();
+
+// Republishing the top-20 snapshot of both sides after a change to the book,
+// as a shard does once per batch of commands
+void BM_PublishDepthSnapshot(benchmark::State& state) {
+    const size_t levels = static_cast<size_t>(state.range(0));
+    OrderBook book(bench_config(levels));
+    uint64_t next_id = fill_book(book, levels);
+    LatencyHistogram histogram;
+    Timer timer;
+
+    for (auto _ : state) {
+        book.add_order(Order(next_id, bench_symbol(), OrderType::LIMIT, OrderSide::BUY, kMidPrice - 1, kOrderQuantity));
+        timer.start();
+        book.publish_depth_snapshot();
+        state.SetIterationTime(timer.stop(histogram));
+        book.cancel_order(next_id++);
+    }
+    report(state, histogram);
+}
+BENCHMARK(BM_PublishDepthSnapshot)->Arg(10)->Arg(100)->Arg(1000)->UseManualTime();
+
+// Reader copy of the published snapshot while no store is in progress
+void BM_ReadDepthSnapshot(benchmark::State& state) {
+    OrderBook book(bench_config(100));
+    fill_book(book, 100);
+    book.publish_depth_snapshot();
+    LatencyHistogram histogram;
+    Timer timer;
+
+    for (auto _ : state) {
+        timer.start();
+        const DepthSnapshot snapshot = book.depth_snapshot();
+        state.SetIterationTime(timer.stop(histogram));
+        benchmark::DoNotOptimize(snapshot);
+    }
+    report(state, histogram);
+}
+BENCHMARK(BM_ReadDepthSnapshot)->UseManualTime();
+
+// Packing one drained batch of book updates, L2 and L3 mixed as a sweep
+// produces them, into feed packets; the sink only counts bytes
+void BM_EncodeBookUpdates(benchmark::State& state) {
+    std::vector<BookUpdate> batch(256);
+    for (size_t i = 0; i < batch.size(); ++i) {
+        BookUpdate& update = batch[i];
+        update.type = static_cast<BookUpdateType>(i % 4);
+        update.side = (i % 2 == 0) ? OrderSide::BUY : OrderSide::SELL;
+        update.symbol_id = bench_symbol();
+        update.price = kMidPrice + static_cast<Price>(i % 16);
+        update.quantity = kOrderQuantity;
+        update.order_id = i + 1;
+        update.order_count = 3;
+    }
+    size_t bytes = 0;
+    md::FeedEncoder encoder([&](const uint8_t*, size_t size) { bytes += size; });
+    LatencyHistogram histogram;
+    Timer timer;
+
+    for (auto _ : state) {
+        timer.start();
+        for (const BookUpdate& update : batch) {
+            encoder.add(update);
+        }
+        encoder.flush();
+        state.SetIterationTime(timer.stop(histogram));
+    }
+    benchmark::DoNotOptimize(bytes);
+    report(state, histogram);
+}
+BENCHMARK(BM_EncodeBookUpdates)->UseManualTime();
+
+// The book's id index against the node-based map it replaced, drawing its
+// nodes from a pool resource as the book did
+struct FlatIdIndex {
+    explicit FlatIdIndex(size_t capacity) : index(capacity, std::pmr::new_delete_resource()) {}
+    OrderHandle find(uint64_t id) const { return index.find(id); }
+    void insert(uint64_t id, OrderHandle handle) { index.insert(id, handle); }
+    void erase(uint64_t id) { index.erase(id); }
+
+    OrderIndex index;
+};
+
+struct NodeMapIdIndex {
+    explicit NodeMapIdIndex(size_t capacity) : map(&pool) { map.reserve(capacity); }
+    OrderHandle find(uint64_t id) const {
+        auto it = map.find(id);
+        return it == map.end() ? OrderHandle{} : it->second;
+    }
+    void insert(uint64_t id, OrderHandle handle) { map.emplace(id, handle); }
+    void erase(uint64_t id) { map.erase(id); }
+
+    std::pmr::unsynchronized_pool_resource pool;
+    std::pmr::unordered_map<uint64_t, OrderHandle> map;
+};
+
+// Id index holding state.range(0) live orders whose ids come from one gateway
+// counter shared by three symbols. Each iteration looks up a random live order,
+// retires the oldest and indexes a new one, the index work of a cancel plus an add.
+template <typename Index>
+void BM_OrderIdIndex(benchmark::State& state) {
+    constexpr uint64_t kIdStride = 3;
+    const size_t live = static_cast<size_t>(state.range(0));
+    Index index(live);
+    uint64_t oldest = 1;
+    uint64_t next_id = 1;
+    for (size_t i = 0; i < live; ++i, next_id += kIdStride) {
+        index.insert(next_id, OrderHandle{static_cast<uint32_t>(i), 0});
+    }
+    std::mt19937_64 rng(7);
+    std::vector<uint64_t> probes(1 << 16);
+    for (uint64_t& p : probes) {
+        p = rng() % live;
+    }
+
+    LatencyHistogram histogram;
+    Timer timer;
+    size_t i = 0;
+    for (auto _ : state) {
+        const uint64_t probe = oldest + probes[i++ & (probes.size() - 1)] * kIdStride;
+        timer.start();
+        benchmark::DoNotOptimize(index.find(probe));
+        index.erase(oldest);
+        index.insert(next_id, OrderHandle{static_cast<uint32_t>(i), 0});
+        state.SetIterationTime(timer.stop(histogram));
+        oldest += kIdStride;
+        next_id += kIdStride;
+    }
+    report(state, histogram);
+}
+// Fixed iterations so the 10M-entry tables are built once per run
+BENCHMARK_TEMPLATE(BM_OrderIdIndex, FlatIdIndex)->Arg(1000000)->Arg(10000000)->Iterations(1 << 21)->UseManualTime();
+BENCHMARK_TEMPLATE(BM_OrderIdIndex, NodeMapIdIndex)->Arg(1000000)->Arg(10000000)->Iterations(1 << 21)->UseManualTime();
+
+// Every limit a symbol and account can carry, loose enough that checks pass
+SymbolLimits bench_symbol_limits() {
+    SymbolLimits limits;
+    limits.max_order_quantity = 1000;
+    limits.max_order_notional = 1e9;
+    limits.max_position = 1000000000;
+    limits.price_collar_bps = 1000;
+    limits.max_orders_per_second = UINT32_MAX;
+    return limits;
+}
+
+// Fill of account 0 against account 1, with account 0 on `side`
+Trade bench_trade(uint64_t id, SymbolId symbol_id, OrderSide side, double price, uint64_t quantity) {
+    Trade trade(id, 1, 2, price, quantity);
+    trade.symbol_id = symbol_id;
+    trade.aggressor_side = side;
+    trade.aggressive_account = 0;
+    trade.resting_account = 1;
+    return trade;
+}
+
+// Pre-trade check against a portfolio holding `range(0)` symbols, with every
+// symbol and account limit enabled. Passing orders are released as filled
+// outside the timed region so working exposure stays flat.
+void BM_RiskCheck(benchmark::State& state) {
+    RiskEngine risk(1e9);
+    AccountLimits account_limits;
+    account_limits.max_order_quantity = 1000;
+    account_limits.max_order_notional = 1e9;
+    account_limits.max_orders_per_second = UINT32_MAX;
+    risk.set_account_limits(0, account_limits);
+    const size_t symbols = static_cast<size_t>(state.range(0));
+    for (size_t s = 0; s < symbols; ++s) {
+        const SymbolId symbol_id = SymbolTable::instance().intern("RISK-" + std::to_string(s));
+        risk.set_symbol_limits(symbol_id, bench_symbol_limits());
+        risk.update_on_trade(bench_trade(s, symbol_id, OrderSide::BUY, to_price(kMidPrice, 0.01), 10));
+    }
+    const SymbolId symbol = *SymbolTable::instance().find("RISK-0");
+    LatencyHistogram histogram;
+    Timer timer;
+    uint64_t id = 1;
+
+    for (auto _ : state) {
+        const OrderSide side = (id & 1) ? OrderSide::BUY : OrderSide::SELL;
+        const Order order(id++, symbol, OrderType::LIMIT, side, kMidPrice, 5);
+        timer.start();
+        const RejectReason reason = risk.check_pre_trade_risk(order);
+        state.SetIterationTime(timer.stop(histogram));
+        benchmark::DoNotOptimize(reason);
+        risk.release_open_quantity(0, symbol, side, order.quantity);
+    }
+    report(state, histogram);
+}
+BENCHMARK(BM_RiskCheck)->Arg(3)->Arg(100)->UseManualTime();
+
+// Pre-trade checks from several gateway threads, each on its own symbol, while
+// fills keep landing on another symbol's slot
+void BM_RiskCheckConcurrent(benchmark::State& state) {
+    static RiskEngine risk(1e9);
+    const SymbolId symbol = SymbolTable::instance().intern("RISK-GW-" + std::to_string(state.thread_index()));
+    const SymbolId filled = SymbolTable::instance().intern("RISK-GW-FILLS");
+    uint64_t id = 1;
+
+    for (auto _ : state) {
+        const OrderSide side = (id & 1) ? OrderSide::BUY : OrderSide::SELL;
+        const Order order(id++, symbol, OrderType::LIMIT, side, kMidPrice, 5);
+        benchmark::DoNotOptimize(risk.check_pre_trade_risk(order));
+        risk.release_open_quantity(0, symbol, side, order.quantity);
+        // Thread 0 doubles as the single writer for the filled symbol
+        if (state.thread_index() == 0) {
+            risk.update_on_trade(bench_trade(id, filled, side, 100.0, 1));
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_RiskCheckConcurrent)->ThreadRange(1, 8);
+
+// Position update for both counterparties, alternating buys and sells so the
+// positions stay bounded
+void BM_RiskUpdate(benchmark::State& state) {
+    RiskEngine risk(1e9);
+    const SymbolId symbol = SymbolTable::instance().intern("RISK-UPDATE");
+    LatencyHistogram histogram;
+    Timer timer;
+    uint64_t trade_id = 1;
+
+    for (auto _ : state) {
+        const OrderSide side = (trade_id & 1) ? OrderSide::BUY : OrderSide::SELL;
+        const Trade trade = bench_trade(trade_id, symbol, side, 100.0 + static_cast<double>(trade_id % 7), 10);
+        ++trade_id;
+        timer.start();
+        risk.update_on_trade(trade);
+        state.SetIterationTime(timer.stop(histogram));
+    }
+    report(state, histogram);
+}
+BENCHMARK(BM_RiskUpdate)->UseManualTime();
+
+// One quote revaluing a symbol and the portfolio totals, over `range(0)` held
+// symbols; flat in the symbol count since nothing is rescanned
+void BM_MarkToMarketQuote(benchmark::State& state) {
+    const size_t symbols = static_cast<size_t>(state.range(0));
+    MarkToMarket marks(symbols);
+    for (size_t s = 0; s < symbols; ++s) {
+        Position position;
+        position.net_position = static_cast<long long>(s % 7) - 3;
+        position.avg_entry_price = 100.0;
+        marks.on_position(static_cast<SymbolId>(s), position);
+    }
+    LatencyHistogram histogram;
+    Timer timer;
+    uint64_t tick = 0;
+
+    for (auto _ : state) {
+        QuoteUpdate quote;
+        quote.symbol_id = static_cast<SymbolId>(tick % symbols);
+        quote.best_bid = 99.0 + static_cast<double>(tick++ % 5) * 0.25;
+        quote.best_ask = quote.best_bid + 0.5;
+        quote.has_bid = quote.has_ask = true;
+        timer.start();
+        marks.on_quote(quote);
+        state.SetIterationTime(timer.stop(histogram));
+    }
+    benchmark::DoNotOptimize(marks.portfolio());
+    report(state, histogram);
+}
+BENCHMARK(BM_MarkToMarketQuote)->Arg(3)->Arg(1000)->UseManualTime();
+
+const std::string kEchoFrame =
+    R"({"type":"subscribe","symbol":"{\"type\":\"limit\",\"symbol\":\"BENCH-USD\",\"side\":\"buy\",\"price\":1000.25,\"quantity\":10}"})";
+
+// Decode of the subscribe echo the market data handler receives, fast path
+void BM_IngestDecode(benchmark::State& state) {
+    bench_symbol();
+    ParsedOrder order{};
+    LatencyHistogram histogram;
+    Timer timer;
+
+    for (auto _ : state) {
+        timer.start();
+        const bool parsed = OrderMessageParser::parse(kEchoFrame, order);
+        state.SetIterationTime(timer.stop(histogram));
+        benchmark::DoNotOptimize(parsed);
+        benchmark::DoNotOptimize(order);
+    }
+    report(state, histogram);
+}
+BENCHMARK(BM_IngestDecode)->UseManualTime();
+
+// Same frame through the nlohmann::json fallback: outer parse plus nested parse
+void BM_IngestDecodeJson(benchmark::State& state) {
+    LatencyHistogram histogram;
+    Timer timer;
+
+    for (auto _ : state) {
+        timer.start();
+        json msg = json::parse(kEchoFrame);
+        json order_data = json::parse(msg["symbol"].get<std::string>());
+        const double price = order_data["price"];
+        const uint64_t quantity = order_data["quantity"];
+        state.SetIterationTime(timer.stop(histogram));
+        benchmark::DoNotOptimize(price);
+        benchmark::DoNotOptimize(quantity);
+    }
+    report(state, histogram);
+}
+BENCHMARK(BM_IngestDecodeJson)->UseManualTime();
+
+std::string bench_journal_dir() {
+    return (std::filesystem::temp_directory_path() / "trading-bench-journal").string();
+}
+
+// One journaled order on the matching thread: a 64-byte store into the mapping
+void BM_JournalAppend(benchmark::State& state) {
+    const std::string dir = bench_journal_dir();
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    Journal journal;
+    std::string error;
+    if (!journal.open(dir + "/append.journal", error)) {
+        state.SkipWithError(error.c_str());
+        return;
+    }
+    LatencyHistogram histogram;
+    Timer timer;
+    uint64_t id = 1;
+
+    for (auto _ : state) {
+        const Order order(id++, bench_symbol(), OrderType::LIMIT, OrderSide::BUY, kMidPrice, kOrderQuantity);
+        timer.start();
+        journal.append_order(order);
+        state.SetIterationTime(timer.stop(histogram));
+    }
+    journal.close();
+    std::filesystem::remove_all(dir);
+    report(state, histogram);
+}
+BENCHMARK(BM_JournalAppend)->UseManualTime();
+
+// Rebuilding a book from a journal of `range(0)` orders, half of them crossing
+void BM_JournalRecover(benchmark::State& state) {
+    const size_t orders = static_cast<size_t>(state.range(0));
+    const std::string dir = bench_journal_dir();
+    std::filesystem::remove_all(dir);
+
+    BookManagerConfig config;
+    config.num_shards = 1;
+    config.pin_threads = false;
+    config.journal_dir = dir;
+    config.journal_config.initial_records = 2 * orders;
+    OrderBookConfig book = bench_config(1000);
+    book.initial_order_capacity = orders;
+    {
+        BookManager manager(config);
+        const SymbolId symbol = manager.add_symbol("BENCH-USD", book);
+        manager.start();
+        std::mt19937_64 rng(7);
+        for (uint64_t id = 1; id <= orders; ++id) {
+            const OrderSide side = (rng() & 1) ? OrderSide::BUY : OrderSide::SELL;
+            const Price price = kMidPrice + static_cast<Price>(rng() % 200) - 100;
+            while (!manager.submit(OrderCommand::new_order(
+                Order(id, symbol, OrderType::LIMIT, side, price, 1 + rng() % kOrderQuantity)))) {
+            }
+        }
+        manager.stop();
+    }
+
+    LatencyHistogram histogram;
+    Timer timer;
+    uint64_t records = 0;
+    for (auto _ : state) {
+        BookManager manager(config);
+        manager.add_symbol("BENCH-USD", book);
+        timer.start();
+        records = manager.recover([](const Trade&) {}).records;
+        state.SetIterationTime(timer.stop(histogram));
+    }
+    std::filesystem::remove_all(dir);
+    report(state, histogram);
+    // Throughput in journal records rather than recoveries
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * records));
+}
+BENCHMARK(BM_JournalRecover)->Arg(100000)->Arg(1000000)->UseManualTime()->Unit(benchmark::kMillisecond);
+
+} // namespace
+
+int main(int argc, char** argv) {
+    // The risk engine logs every check at INFO; keep the logger out of the measurements
+    Logger::instance().set_level(LogLevel::WARN);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
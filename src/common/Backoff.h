@@ -0,0 +1,51 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+enum class WaitStrategy {
+    BUSY_SPIN, // Never leave the core; lowest wake-up latency, burns a CPU
+    BACKOFF    // Spin, then yield, then sleep briefly while idle
+};
+
+/**
+ * @brief Idle strategy for threads polling lock-free queues.
+ *
+ * Call idle() each time a poll comes back empty and reset() once work arrives.
+ */
+class Backoff {
+public:
+    explicit Backoff(WaitStrategy strategy = WaitStrategy::BACKOFF) : strategy_(strategy), spins_(0) {}
+
+    void reset() { spins_ = 0; }
+
+    void idle() {
+        if (strategy_ == WaitStrategy::BUSY_SPIN) {
+            cpu_relax();
+        } else if (spins_ < kSpinLimit) {
+            ++spins_;
+            cpu_relax();
+        } else if (spins_ < kYieldLimit) {
+            ++spins_;
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+    static void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+private:
+    static constexpr uint32_t kSpinLimit = 1024;
+    static constexpr uint32_t kYieldLimit = kSpinLimit + 64;
+
+    WaitStrategy strategy_;
+    uint32_t spins_;
+};
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "Backoff.h"
+#include "SpscQueue.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Bounded single-producer ring that every subscriber reads in full.
+ *
+ * Each subscriber owns a read cursor on its own cache line and drains at its
+ * own pace; publishing never waits on a subscriber unless that subscriber has
+ * fallen a whole ring behind. The producer keeps a cached copy of the slowest
+ * cursor and only rescans the cursors when the ring looks full.
+ *
+ * Subscribers see everything published after they subscribe. Each cursor must
+ * be polled by a single thread at a time.
+ */
+template <typename T>
+class BroadcastRing {
+public:
+    static constexpr size_t kNoSubscriber = SIZE_MAX;
+
+    BroadcastRing(size_t capacity, size_t max_subscribers)
+        : buffer_(round_up_pow2(capacity < 2 ? 2 : capacity)),
+          mask_(buffer_.size() - 1),
+          cursors_(std::make_unique<Cursor[]>(max_subscribers)),
+          max_subscribers_(max_subscribers) {}
+
+    BroadcastRing(const BroadcastRing&) = delete;
+    BroadcastRing& operator=(const BroadcastRing&) = delete;
+
+    // Returns the new subscriber's id, or kNoSubscriber if all slots are taken
+    size_t subscribe() {
+        std::lock_guard<std::mutex> lock(subscribe_mutex_);
+        for (size_t id = 0; id < max_subscribers_; ++id) {
+            Cursor& cursor = cursors_[id];
+            if (!cursor.active.load(std::memory_order_relaxed)) {
+                // Go active before taking the start position. A producer whose
+                // scan missed this cursor could only have cached a minimum at
+                // or below the head it had then; the fences here and in
+                // min_position() guarantee the head read below is no earlier,
+                // so nothing from the start position on can be overwritten.
+                cursor.position.store(head_.load(std::memory_order_acquire), std::memory_order_relaxed);
+                cursor.active.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                cursor.position.store(head_.load(std::memory_order_acquire), std::memory_order_release);
+                return id;
+            }
+        }
+        return kNoSubscriber;
+    }
+
+    // After this the subscriber no longer holds the producer back
+    void unsubscribe(size_t id) {
+        std::lock_guard<std::mutex> lock(subscribe_mutex_);
+        cursors_[id].active.store(false, std::memory_order_release);
+    }
+
+    // Producer side. A full ring counts as one overflow event; with SPIN the
+    // producer waits for the slowest subscriber, so every subscriber must keep
+    // polling (or unsubscribe) while the producer is running.
+    template <typename U>
+    bool publish(U&& value, OverflowPolicy policy) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head - cached_min_ == buffer_.size()) {
+            cached_min_ = min_position(head);
+            if (head - cached_min_ == buffer_.size()) {
+                overflows_.store(overflows_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                if (policy == OverflowPolicy::DROP_NEWEST) {
+                    return false;
+                }
+                Backoff backoff;
+                while (head - (cached_min_ = min_position(head)) == buffer_.size()) {
+                    backoff.idle();
+                }
+            }
+        }
+        buffer_[head & mask_] = std::forward<U>(value);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Subscriber side. Copies up to max_items unread values into `out` and
+    // advances the cursor once; returns how many were copied.
+    size_t poll(size_t id, T* out, size_t max_items) {
+        Cursor& cursor = cursors_[id];
+        const size_t position = cursor.position.load(std::memory_order_relaxed);
+        const size_t available = head_.load(std::memory_order_acquire) - position;
+        const size_t count = std::min(available, max_items);
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = buffer_[(position + i) & mask_];
+        }
+        if (count > 0) {
+            cursor.position.store(position + count, std::memory_order_release);
+        }
+        return count;
+    }
+
+    // Whether subscriber `id` has read everything published so far
+    bool caught_up(size_t id) const {
+        return cursors_[id].position.load(std::memory_order_acquire) == head_.load(std::memory_order_acquire);
+    }
+
+    uint64_t published() const { return head_.load(std::memory_order_acquire); }
+    // Items subscriber `id` has polled since the ring was created
+    uint64_t position(size_t id) const { return cursors_[id].position.load(std::memory_order_acquire); }
+    size_t capacity() const { return buffer_.size(); }
+    uint64_t overflow_count() const { return overflows_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t kCacheLine = 64;
+
+    struct alignas(kCacheLine) Cursor {
+        std::atomic<size_t> position{0};
+        std::atomic<bool> active{false};
+    };
+
+    static size_t round_up_pow2(size_t n) {
+        size_t size = 1;
+        while (size < n) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    // Slowest active cursor, or `head` when nobody is subscribed
+    size_t min_position(size_t head) const {
+        // Pairs with the fence in subscribe()
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        size_t slowest = head;
+        for (size_t id = 0; id < max_subscribers_; ++id) {
+            const Cursor& cursor = cursors_[id];
+            if (cursor.active.load(std::memory_order_acquire)) {
+                slowest = std::min(slowest, cursor.position.load(std::memory_order_acquire));
+            }
+        }
+        return slowest;
+    }
+
+    std::vector<T> buffer_;
+    const size_t mask_;
+    std::unique_ptr<Cursor[]> cursors_;
+    const size_t max_subscribers_;
+    std::mutex subscribe_mutex_;
+
+    // Producer-owned
+    alignas(kCacheLine) std::atomic<size_t> head_{0};
+    size_t cached_min_ = 0;
+    std::atomic<uint64_t> overflows_{0};
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory_resource>
+
+/**
+ * @brief memory_resource that forwards to an upstream resource and counts
+ * every allocation it passes on.
+ *
+ * Components that route their storage through one of these can prove that a
+ * code path is allocation-free by comparing allocations() before and after.
+ */
+class CountingResource : public std::pmr::memory_resource {
+public:
+    explicit CountingResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : upstream_(upstream) {}
+
+    uint64_t allocations() const { return allocations_.load(std::memory_order_relaxed); }
+    uint64_t bytes_allocated() const { return bytes_allocated_.load(std::memory_order_relaxed); }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        allocations_.fetch_add(1, std::memory_order_relaxed);
+        bytes_allocated_.fetch_add(bytes, std::memory_order_relaxed);
+        return upstream_->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        upstream_->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource* upstream_;
+    std::atomic<uint64_t> allocations_{0};
+    std::atomic<uint64_t> bytes_allocated_{0};
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Fixed-size log-linear histogram of latency samples in nanoseconds.
+ *
+ * Values below 32 are counted exactly; above that each power of two is split
+ * into 32 buckets, so any reported percentile is within about 3% of the true
+ * sample. Recording is a couple of bit operations and never allocates.
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram() { reset(); }
+
+    void record(uint64_t value) {
+        ++counts_[bucket_of(value)];
+        ++count_;
+        sum_ += value;
+        min_ = value < min_ ? value : min_;
+        max_ = value > max_ ? value : max_;
+    }
+
+    // Smallest recorded bucket bound covering `p` percent of samples (0-100)
+    uint64_t percentile(double p) const;
+
+    void merge(const LatencyHistogram& other);
+    void reset();
+
+    uint64_t count() const { return count_; }
+    uint64_t min() const { return count_ ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const { return count_ ? static_cast<double>(sum_) / count_ : 0.0; }
+
+private:
+    static constexpr unsigned kSubBucketBits = 5;
+    static constexpr uint64_t kSubBuckets = 1ULL << kSubBucketBits;
+    static constexpr size_t kBucketCount = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+    static size_t bucket_of(uint64_t value) {
+        if (value < kSubBuckets) {
+            return static_cast<size_t>(value);
+        }
+        const unsigned msb = 63 - __builtin_clzll(value);
+        const unsigned shift = msb - kSubBucketBits;
+        // Top kSubBucketBits + 1 bits of the value, leading one included
+        const uint64_t sub = value >> shift;
+        return (shift + 1) * kSubBuckets + static_cast<size_t>(sub - kSubBuckets);
+    }
+
+    // Largest value that falls into `index`
+    static uint64_t bucket_upper_bound(size_t index);
+
+    std::array<uint64_t, kBucketCount> counts_;
+    uint64_t count_;
+    uint64_t sum_;
+    uint64_t min_;
+    uint64_t max_;
+};
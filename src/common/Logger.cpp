@@ -0,0 +1,145 @@
+#include "Logger.h"
+#include "Backoff.h"
+#include <algorithm>
+#include <ctime>
+
+namespace {
+
+constexpr size_t kMaxLineBytes = 512;
+constexpr size_t kMaxDrainBatch = 4096;
+
+const char* level_name(LogLevel level) {
+    switch (level) {
+        case LogLevel::TRACE: return "TRACE";
+        case LogLevel::DEBUG: return "DEBUG";
+        case LogLevel::INFO: return "INFO ";
+        case LogLevel::WARN: return "WARN ";
+        case LogLevel::ERROR: return "ERROR";
+        case LogLevel::OFF: break;
+    }
+    return "?    ";
+}
+
+// Marks the calling thread's buffer retired when the thread exits
+struct ThreadBufferOwner {
+    std::atomic<bool>* retired = nullptr;
+    ~ThreadBufferOwner() {
+        if (retired) {
+            retired->store(true, std::memory_order_release);
+        }
+    }
+};
+
+thread_local ThreadBufferOwner buffer_owner;
+
+} // namespace
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+void Logger::start(FILE* sink) {
+    if (running_.exchange(true)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(drain_mutex_);
+        sink_ = sink;
+    }
+    writer_ = std::thread(&Logger::run, this);
+}
+
+void Logger::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+}
+
+uint64_t Logger::dropped() const {
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    uint64_t total = 0;
+    for (const auto& buffer : buffers_) {
+        total += buffer->queue.overflow_count();
+    }
+    return total;
+}
+
+Logger::ThreadBuffer* Logger::register_thread() {
+    auto buffer = std::make_shared<ThreadBuffer>();
+    {
+        std::lock_guard<std::mutex> lock(buffers_mutex_);
+        buffers_.push_back(buffer);
+    }
+    buffer_owner.retired = &buffer->retired;
+    thread_buffer_ = buffer.get();
+    return thread_buffer_;
+}
+
+void Logger::run() {
+    Backoff backoff;
+    while (running_.load(std::memory_order_acquire)) {
+        if (drain() > 0) {
+            backoff.reset();
+        } else {
+            backoff.idle();
+        }
+    }
+    // Final pass for anything logged before stop()
+    while (drain() > 0) {
+    }
+}
+
+size_t Logger::drain() {
+    std::lock_guard<std::mutex> drain_lock(drain_mutex_);
+    {
+        std::lock_guard<std::mutex> lock(buffers_mutex_);
+        drain_buffers_ = buffers_;
+    }
+
+    pending_.clear();
+    for (const auto& buffer : drain_buffers_) {
+        LogRecord record;
+        while (pending_.size() < kMaxDrainBatch && buffer->queue.try_pop(record)) {
+            pending_.push_back(record);
+        }
+    }
+    // Interleave threads in the order the statements ran
+    std::stable_sort(pending_.begin(), pending_.end(), [](const LogRecord& a, const LogRecord& b) {
+        return a.timestamp_ns < b.timestamp_ns;
+    });
+
+    char line[kMaxLineBytes];
+    for (const LogRecord& record : pending_) {
+        const time_t seconds = static_cast<time_t>(record.timestamp_ns / 1000000000);
+        const long micros = static_cast<long>(record.timestamp_ns % 1000000000 / 1000);
+        tm local;
+        localtime_r(&seconds, &local);
+        int length = std::snprintf(line, sizeof(line), "%02d:%02d:%02d.%06ld %s ", local.tm_hour, local.tm_min,
+                                   local.tm_sec, micros, level_name(record.level));
+        const int body = record.format(record, line + length, sizeof(line) - length - 1);
+        // snprintf reports the untruncated length
+        length += std::min(std::max(body, 0), static_cast<int>(sizeof(line) - length - 2));
+        line[length++] = '\n';
+        std::fwrite(line, 1, static_cast<size_t>(length), sink_);
+    }
+    if (!pending_.empty()) {
+        std::fflush(sink_);
+    }
+
+    // Forget buffers whose threads have exited once they are fully drained
+    {
+        std::lock_guard<std::mutex> lock(buffers_mutex_);
+        buffers_.erase(std::remove_if(buffers_.begin(), buffers_.end(),
+                                      [](const std::shared_ptr<ThreadBuffer>& buffer) {
+                                          return buffer->retired.load(std::memory_order_acquire) &&
+                                                 buffer->queue.empty();
+                                      }),
+                       buffers_.end());
+    }
+    drain_buffers_.clear();
+    return pending_.size();
+}
@@ -0,0 +1,224 @@
+#pragma once
+
+#include "SpscQueue.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+enum class LogLevel : uint8_t {
+    TRACE,
+    DEBUG,
+    INFO,
+    WARN,
+    ERROR,
+    OFF
+};
+
+// Statements below this level are compiled out, arguments included.
+// Build with -DLOG_COMPILE_LEVEL=<n> where n is a LogLevel value.
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL 0
+#endif
+
+constexpr LogLevel kLogCompileLevel = static_cast<LogLevel>(LOG_COMPILE_LEVEL);
+
+/**
+ * @brief One log statement as captured on the calling thread.
+ *
+ * Arguments are stored in binary form; the writer thread turns the record into
+ * text through `format`, which knows the argument types of the call site.
+ */
+struct LogRecord {
+    static constexpr size_t kPayloadBytes = 192;
+    using Formatter = int (*)(const LogRecord& record, char* out, size_t size);
+
+    Formatter format = nullptr;
+    const char* fmt = nullptr; // String literal from the call site
+    int64_t timestamp_ns = 0;  // System clock
+    LogLevel level = LogLevel::INFO;
+    char payload[kPayloadBytes];
+};
+
+namespace log_detail {
+
+// Numbers and pointers are copied as-is
+template <typename T>
+struct Codec {
+    static_assert(std::is_arithmetic_v<T> || std::is_pointer_v<T>,
+                  "log arguments must be numbers, pointers or C strings");
+    static constexpr size_t kFixedBytes = sizeof(T);
+
+    static void encode(char*& pos, size_t&, T value) {
+        std::memcpy(pos, &value, sizeof(T));
+        pos += sizeof(T);
+    }
+    static T decode(const char*& pos) {
+        T value;
+        std::memcpy(&value, pos, sizeof(T));
+        pos += sizeof(T);
+        return value;
+    }
+};
+
+// C strings are copied into the record, truncated to whatever space is left
+template <>
+struct Codec<const char*> {
+    static constexpr size_t kFixedBytes = sizeof(uint16_t) + 1; // Length and terminator
+
+    static void encode(char*& pos, size_t& budget, const char* value) {
+        uint16_t length = 0;
+        if (value) {
+            while (length < budget && value[length] != '\0') {
+                ++length;
+            }
+        }
+        budget -= length;
+        std::memcpy(pos, &length, sizeof(length));
+        pos += sizeof(length);
+        std::memcpy(pos, value, length);
+        pos += length;
+        *pos++ = '\0';
+    }
+    static const char* decode(const char*& pos) {
+        uint16_t length;
+        std::memcpy(&length, pos, sizeof(length));
+        const char* value = pos + sizeof(length);
+        pos = value + length + 1;
+        return value;
+    }
+};
+
+template <>
+struct Codec<char*> : Codec<const char*> {};
+
+template <typename T>
+using CodecFor = Codec<std::decay_t<T>>;
+
+template <typename... Args>
+int format_record(const LogRecord& record, char* out, size_t size) {
+    [[maybe_unused]] const char* pos = record.payload;
+    // Braced initialisation decodes the arguments left to right
+    std::tuple<decltype(Codec<Args>::decode(pos))...> args{Codec<Args>::decode(pos)...};
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#pragma GCC diagnostic ignored "-Wformat-security"
+    return std::apply([&](auto... values) { return std::snprintf(out, size, record.fmt, values...); }, args);
+#pragma GCC diagnostic pop
+}
+
+// Never called; lets the compiler check the format string against the arguments
+[[gnu::format(printf, 1, 2)]] inline void check_format(const char*, ...) {}
+
+} // namespace log_detail
+
+/**
+ * @brief Asynchronous logger for threads that must not block on I/O.
+ *
+ * Each logging thread gets its own lock-free SPSC buffer on first use and
+ * pushes fixed-size binary records into it; a log call never formats, locks or
+ * allocates, and drops the record if its buffer is full. A background writer
+ * drains all buffers, orders records by timestamp, formats them and writes
+ * them to the sink.
+ *
+ * Use the LOG_* macros rather than write(): they check the printf-style format
+ * at compile time and skip disabled levels before evaluating any argument.
+ */
+class Logger {
+public:
+    static constexpr size_t kThreadBufferRecords = 1024;
+
+    static Logger& instance();
+
+    // Start the background writer. Records logged before start() wait in the
+    // thread buffers.
+    void start(FILE* sink = stdout);
+
+    // Write out everything logged so far and stop the writer
+    void stop();
+
+    void set_level(LogLevel level) { level_.store(level, std::memory_order_relaxed); }
+    LogLevel level() const { return level_.load(std::memory_order_relaxed); }
+    bool enabled(LogLevel level) const { return level >= level_.load(std::memory_order_relaxed); }
+
+    // Records dropped because a thread's buffer was full
+    uint64_t dropped() const;
+
+    // `fmt` must be a string literal; it is formatted later on the writer thread
+    template <size_t N, typename... Args>
+    void write(LogLevel level, const char (&fmt)[N], Args... args) {
+        constexpr size_t fixed_bytes = (size_t{0} + ... + log_detail::CodecFor<Args>::kFixedBytes);
+        static_assert(fixed_bytes <= LogRecord::kPayloadBytes, "too many log arguments for one record");
+
+        LogRecord record;
+        record.format = &log_detail::format_record<std::decay_t<Args>...>;
+        record.fmt = fmt;
+        record.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                  std::chrono::system_clock::now().time_since_epoch()).count();
+        record.level = level;
+
+        [[maybe_unused]] char* pos = record.payload;
+        [[maybe_unused]] size_t string_budget = LogRecord::kPayloadBytes - fixed_bytes;
+        (log_detail::CodecFor<Args>::encode(pos, string_budget, args), ...);
+
+        ThreadBuffer* buffer = thread_buffer_ ? thread_buffer_ : register_thread();
+        buffer->queue.push(record, OverflowPolicy::DROP_NEWEST);
+    }
+
+private:
+    struct ThreadBuffer {
+        ThreadBuffer() : queue(kThreadBufferRecords) {}
+
+        SpscQueue<LogRecord> queue;
+        std::atomic<bool> retired{false}; // Owning thread has exited
+    };
+
+    Logger() = default;
+
+    ThreadBuffer* register_thread();
+    void run();
+    // Moves every queued record to the sink; returns how many were written
+    size_t drain();
+
+    inline static thread_local ThreadBuffer* thread_buffer_ = nullptr;
+
+    std::atomic<LogLevel> level_{LogLevel::INFO};
+
+    mutable std::mutex buffers_mutex_;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+
+    // Consumer side, owned by whoever holds drain_mutex_
+    std::mutex drain_mutex_;
+    std::vector<std::shared_ptr<ThreadBuffer>> drain_buffers_;
+    std::vector<LogRecord> pending_;
+    FILE* sink_ = stdout;
+
+    std::atomic<bool> running_{false};
+    std::thread writer_;
+};
+
+#define LOG_AT(level, ...)                                                     \
+    do {                                                                       \
+        if constexpr ((level) >= kLogCompileLevel) {                          \
+            if (false) {                                                       \
+                ::log_detail::check_format(__VA_ARGS__);                       \
+            }                                                                  \
+            if (::Logger::instance().enabled(level)) {                         \
+                ::Logger::instance().write(level, __VA_ARGS__);                \
+            }                                                                  \
+        }                                                                      \
+    } while (0)
+
+#define LOG_TRACE(...) LOG_AT(LogLevel::TRACE, __VA_ARGS__)
+#define LOG_DEBUG(...) LOG_AT(LogLevel::DEBUG, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(LogLevel::INFO, __VA_ARGS__)
+#define LOG_WARN(...) LOG_AT(LogLevel::WARN, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(LogLevel::ERROR, __VA_ARGS__)
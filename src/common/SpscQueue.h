@@ -0,0 +1,131 @@
+#pragma once
+
+#include "Backoff.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Bounded lock-free single-producer/single-consumer ring buffer.
+ *
+ * Exactly one thread may push and exactly one thread may pop. Head and tail
+ * live on separate cache lines, and each side keeps a cached copy of the
+ * other's index so the shared line is only re-read when the ring looks full
+ * (producer) or empty (consumer).
+ */
+enum class OverflowPolicy {
+    DROP_NEWEST, // Discard the value being pushed
+    SPIN         // Wait for the consumer to make room
+};
+
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity)
+        : buffer_(round_up_pow2(capacity < 2 ? 2 : capacity)), mask_(buffer_.size() - 1) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer side. Returns false if the ring is full.
+    template <typename U>
+    bool try_push(U&& value) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ == buffer_.size()) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ == buffer_.size()) {
+                return false;
+            }
+        }
+        buffer_[tail & mask_] = std::forward<U>(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Producer side. Every push that finds the ring full counts as one overflow
+    // event. With SPIN the producer waits for room, so it must not be used if
+    // the consumer can stop draining while the producer is still pushing.
+    template <typename U>
+    bool push(U&& value, OverflowPolicy policy) {
+        // try_push only moves from `value` when it succeeds
+        if (try_push(std::forward<U>(value))) {
+            return true;
+        }
+        overflows_.store(overflows_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (policy == OverflowPolicy::DROP_NEWEST) {
+            return false;
+        }
+        Backoff backoff;
+        while (!try_push(std::forward<U>(value))) {
+            backoff.idle();
+        }
+        return true;
+    }
+
+    // Consumer side. Returns false if the ring is empty.
+    bool try_pop(T& out) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return false;
+            }
+        }
+        out = std::move(buffer_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Moves up to max_items into `out` with a single release of
+    // the consumed slots; returns how many were taken.
+    size_t try_pop_batch(T* out, size_t max_items) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (cached_tail_ - head < max_items) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+        }
+        const size_t available = cached_tail_ - head;
+        const size_t count = available < max_items ? available : max_items;
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = std::move(buffer_[(head + i) & mask_]);
+        }
+        if (count > 0) {
+            head_.store(head + count, std::memory_order_release);
+        }
+        return count;
+    }
+
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+    size_t size_approx() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+    size_t capacity() const { return buffer_.size(); }
+    uint64_t overflow_count() const { return overflows_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t kCacheLine = 64;
+
+    static size_t round_up_pow2(size_t n) {
+        size_t size = 1;
+        while (size < n) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    std::vector<T> buffer_;
+    const size_t mask_;
+
+    // Consumer-owned
+    alignas(kCacheLine) std::atomic<size_t> head_{0};
+    size_t cached_tail_ = 0;
+
+    // Producer-owned
+    alignas(kCacheLine) std::atomic<size_t> tail_{0};
+    size_t cached_head_ = 0;
+    std::atomic<uint64_t> overflows_{0};
+};
@@ -0,0 +1,37 @@
+#include "SymbolTable.h"
+
+SymbolTable& SymbolTable::instance() {
+    static SymbolTable table;
+    return table;
+}
+
+SymbolId SymbolTable::intern(std::string_view name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = ids_.find(name);
+    if (it != ids_.end()) {
+        return it->second;
+    }
+    const auto symbol_id = static_cast<SymbolId>(names_.size());
+    names_.emplace_back(name);
+    ids_.emplace(names_.back(), symbol_id);
+    return symbol_id;
+}
+
+std::optional<SymbolId> SymbolTable::find(std::string_view name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = ids_.find(name);
+    if (it == ids_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+const std::string& SymbolTable::name(SymbolId id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return names_.at(id);
+}
+
+size_t SymbolTable::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return names_.size();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+using SymbolId = uint32_t;
+
+/**
+ * @brief Process-wide interning of symbol names to small dense integer ids.
+ *
+ * Ids are assigned in registration order starting at 0, so they can index
+ * arrays directly. Symbols are expected to be registered up front; lookups by
+ * id return references that stay valid for the lifetime of the process.
+ */
+class SymbolTable {
+public:
+    static SymbolTable& instance();
+
+    // Returns the id for `name`, assigning the next free id on first use
+    SymbolId intern(std::string_view name);
+
+    // Looks up an already interned symbol without registering it
+    std::optional<SymbolId> find(std::string_view name) const;
+
+    const std::string& name(SymbolId id) const;
+    size_t size() const;
+
+private:
+    SymbolTable() = default;
+
+    mutable std::mutex mutex_;
+    // Keys view into names_, so lookups by string_view never allocate
+    std::unordered_map<std::string_view, SymbolId> ids_;
+    std::deque<std::string> names_; // deque keeps references stable as it grows
+};
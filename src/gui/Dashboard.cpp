@@ -7,8 +7,8 @@
 #include <iostream>
 #include <numeric>
 
-Dashboard::Dashboard(OrderBook& book, RiskEngine& risk)
-    : window_(nullptr), order_book_(book), risk_engine_(risk) {}
+Dashboard::Dashboard(const OrderBook& book, RiskEngine& risk, const MarkToMarket& marks, AccountId account)
+    : window_(nullptr), order_book_(book), risk_engine_(risk), marks_(marks), account_(account) {}
 
 Dashboard::~Dashboard() {
     cleanup();
@@ -110,8 +110,14 @@ void Dashboard::cleanup() {
 void Dashboard::render_order_book_panel() {
     ImGui::Begin("📊 Order Book");
     
-    auto bids = order_book_.get_depth(OrderSide::BUY);
-    auto asks = order_book_.get_depth(OrderSide::SELL);
+    depth_ = order_book_.depth_snapshot();
+    if (depth_.last_trade_quantity > 0) {
+        ImGui::Text("Last trade: %.2f x %lu", depth_.last_trade_price, depth_.last_trade_quantity);
+    } else {
+        ImGui::Text("Last trade: -");
+    }
+    ImGui::SameLine();
+    ImGui::TextDisabled("(book update %lu)", depth_.sequence);
 
     if (ImGui::BeginTable("OrderBookTable", 2, ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable)) {
         ImGui::TableSetupColumn("Bids", ImGuiTableColumnFlags_WidthFixed, 300.0f);
@@ -123,17 +129,21 @@ void Dashboard::render_order_book_panel() {
         
         // Bids section
         ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "BUY ORDERS");
-        if (ImGui::BeginTable("BidsTable", 2, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders)) {
+        if (ImGui::BeginTable("BidsTable", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders)) {
             ImGui::TableSetupColumn("Price", ImGuiTableColumnFlags_WidthFixed, 120.0f);
             ImGui::TableSetupColumn("Quantity", ImGuiTableColumnFlags_WidthFixed, 120.0f);
+            ImGui::TableSetupColumn("Orders", ImGuiTableColumnFlags_WidthFixed, 80.0f);
             ImGui::TableHeadersRow();
             
-            for (const auto& [price, qty] : bids) {
+            for (size_t i = 0; i < depth_.bid_count; ++i) {
+                const DepthLevel& level = depth_.bids[i];
                 ImGui::TableNextRow();
                 ImGui::TableSetColumnIndex(0);
-                ImGui::TextColored(ImVec4(0.0f, 0.8f, 0.0f, 1.0f), "%.2f", price);
+                ImGui::TextColored(ImVec4(0.0f, 0.8f, 0.0f, 1.0f), "%.2f", level.price);
                 ImGui::TableSetColumnIndex(1);
-                ImGui::Text("%lu", qty);
+                ImGui::Text("%lu", level.quantity);
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%u", level.order_count);
             }
             ImGui::EndTable();
         }
@@ -142,17 +152,21 @@ void Dashboard::render_order_book_panel() {
         
         // Asks section
         ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "SELL ORDERS");
-        if (ImGui::BeginTable("AsksTable", 2, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders)) {
+        if (ImGui::BeginTable("AsksTable", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders)) {
             ImGui::TableSetupColumn("Price", ImGuiTableColumnFlags_WidthFixed, 120.0f);
             ImGui::TableSetupColumn("Quantity", ImGuiTableColumnFlags_WidthFixed, 120.0f);
+            ImGui::TableSetupColumn("Orders", ImGuiTableColumnFlags_WidthFixed, 80.0f);
             ImGui::TableHeadersRow();
             
-            for (const auto& [price, qty] : asks) {
+            for (size_t i = 0; i < depth_.ask_count; ++i) {
+                const DepthLevel& level = depth_.asks[i];
                 ImGui::TableNextRow();
                 ImGui::TableSetColumnIndex(0);
-                ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "%.2f", price);
+                ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "%.2f", level.price);
                 ImGui::TableSetColumnIndex(1);
-                ImGui::Text("%lu", qty);
+                ImGui::Text("%lu", level.quantity);
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%u", level.order_count);
             }
             ImGui::EndTable();
         }
@@ -164,7 +178,7 @@ void Dashboard::render_order_book_panel() {
 void Dashboard::render_pnl_position_panel() {
     ImGui::Begin("💼 Portfolio & Risk");
     
-    auto pos = risk_engine_.get_position("BTC-USD");
+    auto pos = risk_engine_.get_position(account_, "BTC-USD");
     if (pos) {
         ImGui::TextColored(ImVec4(0.0f, 1.0f, 1.0f, 1.0f), "Symbol: %s", pos->symbol.c_str());
         
@@ -176,6 +190,8 @@ void Dashboard::render_pnl_position_panel() {
         ImGui::TextColored(pos_color, "Net Position: %lld", pos->net_position);
         ImGui::Text("Avg Entry: %.2f", pos->avg_entry_price);
         ImGui::Text("Realized P&L: %.2f", pos->realized_pnl);
+        const SymbolMark mark = marks_.symbol(SymbolTable::instance().intern("BTC-USD"));
+        ImGui::Text("Mark: %.2f  Unrealized P&L: %.2f", mark.mark_price, mark.unrealized_pnl);
         
         // Position status
         ImGui::Separator();
@@ -190,6 +206,13 @@ void Dashboard::render_pnl_position_panel() {
         ImGui::TextColored(ImVec4(0.8f, 0.8f, 0.8f, 1.0f), "No position for BTC-USD");
     }
     
+    const PortfolioMark portfolio = marks_.portfolio();
+    ImGui::Separator();
+    ImGui::Text("Portfolio P&L: %.2f (unrealized %.2f)", portfolio.realized_pnl + portfolio.unrealized_pnl,
+                portfolio.unrealized_pnl);
+    ImGui::Text("Gross / Net Exposure: %.2f / %.2f", portfolio.gross_exposure, portfolio.net_exposure);
+    ImGui::Text("Drawdown: %.2f (max %.2f)", portfolio.drawdown, portfolio.max_drawdown);
+
     ImGui::Separator();
     ImGui::Text("🛡️ Risk Management:");
     ImGui::Text("Max Position Limit: %.0f", 80.0); // We know this from our setup
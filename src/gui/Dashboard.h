@@ -1,6 +1,7 @@
 #pragma once
 
 #include "order_book/OrderBook.h"
+#include "risk/MarkToMarket.h"
 #include "risk/RiskEngine.h"
 #include <vector>
 #include <mutex>
@@ -10,7 +11,8 @@ struct GLFWwindow;
 
 class Dashboard {
 public:
-    Dashboard(OrderBook& book, RiskEngine& risk);
+    // Positions shown are those of `account`
+    Dashboard(const OrderBook& book, RiskEngine& risk, const MarkToMarket& marks, AccountId account = 0);
     ~Dashboard();
 
     // The main entry point to start the GUI
@@ -28,9 +30,14 @@ private:
     void render_pnl_position_panel();
     void render_trade_history_panel();
 
+    // Copied from the book's published snapshot every frame, without its lock
+    DepthSnapshot depth_;
+
     GLFWwindow* window_;
-    OrderBook& order_book_;
+    const OrderBook& order_book_;
     RiskEngine& risk_engine_;
+    const MarkToMarket& marks_;
+    AccountId account_;
 
     std::vector<Trade> trade_history_;
     std::mutex history_mutex_;
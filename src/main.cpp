@@ -1,7 +1,12 @@
-#include "order_book/OrderBook.h"
+#include "order_book/BookManager.h"
+#include "market_data/MarketDataPublisher.h"
 #include "market_data/WebSocketClient.h"
+#include "risk/MarkToMarket.h"
+#include "risk/OrderReservations.h"
 #include "risk/RiskEngine.h"
 #include "gui/Dashboard.h"
+#include "common/Logger.h"
+#include <cinttypes>
 #include <iostream>
 #include <thread>
 #include <chrono>
@@ -10,92 +15,217 @@
 
 // A counter for generating unique order IDs
 std::atomic<uint64_t> order_id_counter = 1;
+// The simulator trades from two accounts; the dashboard and marks follow the house one
+constexpr AccountId kHouseAccount = 1;
+constexpr AccountId kSecondDeskAccount = 2;
 
 /**
- * @brief Processes messages from the WebSocket and updates the OrderBook.
+ * @brief Risk-checks an order and routes it to the shard owning its book.
+ * @param books The BookManager owning one OrderBook per symbol.
+ * @param risk The RiskEngine for position tracking and limits.
+ * @param book The target book, used to print the price.
+ * @param order The order, priced in ticks of `book`.
+ */
+void route_order(BookManager& books, RiskEngine& risk, const OrderBook& book, const Order& order) {
+    // **PRE-TRADE RISK CHECK**
+    LOG_INFO("[DATA HANDLER] Checking risk for: %s %" PRIu64 " @ %.2f", order.side == OrderSide::BUY ? "buy" : "sell",
+             order.quantity, to_price(order.price, book.tick_size()));
+    const RejectReason reason = risk.check_pre_trade_risk(order);
+    if (reason != RejectReason::NONE) {
+        LOG_INFO("[DATA HANDLER] Order REJECTED by risk engine: %s.", to_string(reason));
+        return;
+    }
+    if (books.submit(OrderCommand::new_order(order))) {
+        LOG_INFO("[DATA HANDLER] Order APPROVED and routed to matching shard %zu.", books.shard_of(order.symbol_id));
+    } else {
+        LOG_WARN("[DATA HANDLER] Order DROPPED: matching shard queue is full.");
+        if (RiskEngine::reserves_open_quantity(order)) {
+            risk.release_open_quantity(order.account_id, order.symbol_id, order.side, order.quantity);
+        }
+    }
+}
+
+/**
+ * @brief Assigns an id to a decoded limit order and routes it.
+ * @param parsed The decoded order fields.
+ */
+void route_limit_order(BookManager& books, RiskEngine& risk, const ParsedOrder& parsed) {
+    OrderBook* book = books.book(parsed.symbol_id);
+    if (!book) {
+        LOG_WARN("[DATA HANDLER] No order book for symbol %s", SymbolTable::instance().name(parsed.symbol_id).c_str());
+        return;
+    }
+
+    Order order(
+        order_id_counter++, 
+        parsed.symbol_id,
+        OrderType::LIMIT, 
+        parsed.side, 
+        to_ticks(parsed.price, book->tick_size()), 
+        parsed.quantity
+    );
+    order.account_id = parsed.account_id;
+    order.self_trade_prevention = parsed.self_trade_prevention;
+    route_order(books, risk, *book, order);
+}
+
+/**
+ * @brief Handles one binary protocol message. Prices and order ids arrive ready to use.
+ * @param msg The decoded binary message.
+ */
+void process_binary_message(const wire::Message& msg, BookManager& books, RiskEngine& risk) {
+    switch (msg.header.type) {
+        case wire::MessageType::NEW_ORDER: {
+            const wire::NewOrder& m = msg.new_order;
+            OrderBook* book = books.book(m.symbol_id);
+            if (!book) {
+                LOG_WARN("[DATA HANDLER] No order book for symbol id %u", m.symbol_id);
+                return;
+            }
+            Order order(m.order_id, m.symbol_id, static_cast<OrderType>(m.order_type), static_cast<OrderSide>(m.side),
+                        m.price, m.quantity);
+            order.time_in_force = static_cast<TimeInForce>(m.time_in_force);
+            order.account_id = m.account_id;
+            order.self_trade_prevention = static_cast<SelfTradePrevention>(m.self_trade_prevention);
+            route_order(books, risk, *book, order);
+            break;
+        }
+        case wire::MessageType::CANCEL:
+            if (!books.submit(OrderCommand::cancel(msg.cancel.symbol_id, msg.cancel.order_id))) {
+                LOG_WARN("[DATA HANDLER] Cancel for order %" PRIu64 " DROPPED.", msg.cancel.order_id);
+            }
+            break;
+        case wire::MessageType::REPLACE: {
+            // Applied as an in-place modify: a smaller size at the same price keeps
+            // its queue position, anything else moves the order to the back. The
+            // new size is checked and reserved as a fresh GTC order; the order's
+            // status report then trades that for the old reservation.
+            const wire::Replace& m = msg.replace;
+            OrderBook* book = books.book(m.symbol_id);
+            if (!book) {
+                LOG_WARN("[DATA HANDLER] No order book for symbol id %u", m.symbol_id);
+                return;
+            }
+            Order order(m.order_id, m.symbol_id, OrderType::LIMIT, static_cast<OrderSide>(m.side), m.price, m.quantity);
+            order.account_id = m.account_id;
+            const RejectReason reason = risk.check_pre_trade_risk(order);
+            if (reason != RejectReason::NONE) {
+                LOG_INFO("[DATA HANDLER] Replace of order %" PRIu64 " REJECTED by risk engine: %s.", m.order_id,
+                         to_string(reason));
+                return;
+            }
+            OrderCommand modify = OrderCommand::modify(m.symbol_id, m.order_id, m.price, m.quantity);
+            modify.account_id = order.account_id;
+            modify.side = order.side;
+            if (!books.submit(modify)) {
+                risk.release_open_quantity(order.account_id, order.symbol_id, order.side, order.quantity);
+                LOG_WARN("[DATA HANDLER] Replace of order %" PRIu64 " DROPPED: matching shard queue is full.", m.order_id);
+            }
+            break;
+        }
+        case wire::MessageType::EXEC_REPORT:
+            LOG_INFO("[DATA HANDLER] Execution report for order %" PRIu64 ": %" PRIu64 " filled, %" PRIu64 " left",
+                     msg.exec_report.order_id, msg.exec_report.last_quantity, msg.exec_report.leaves_quantity);
+            break;
+    }
+}
+
+/**
+ * @brief Routes a limit order the fast parser could not decode, e.g. one for an unknown symbol.
+ * @param order_data JSON object holding the limit order fields.
+ */
+void route_json_limit_order(const json& order_data, BookManager& books, RiskEngine& risk) {
+    const std::string symbol = order_data.at("symbol");
+    auto symbol_id = SymbolTable::instance().find(symbol);
+    if (!symbol_id) {
+        LOG_WARN("[DATA HANDLER] No order book for symbol %s", symbol.c_str());
+        return;
+    }
+
+    ParsedOrder parsed{};
+    parsed.symbol_id = *symbol_id;
+    parsed.type = OrderType::LIMIT;
+    parsed.side = (order_data.at("side") == "buy") ? OrderSide::BUY : OrderSide::SELL;
+    parsed.price = order_data.at("price");
+    parsed.quantity = order_data.at("quantity");
+    parsed.account_id = order_data.value("account", 0u);
+    parsed.self_trade_prevention = SelfTradePrevention::NONE;
+    if (order_data.contains("stp") &&
+        !parse_self_trade_prevention(order_data["stp"].get<std::string>(), parsed.self_trade_prevention)) {
+        LOG_WARN("[DATA HANDLER] Unknown self-trade prevention mode in order for %s", symbol.c_str());
+        return;
+    }
+    route_limit_order(books, risk, parsed);
+}
+
+/**
+ * @brief Routes one market data message, decoding it with nlohmann::json only
+ * if the client did not already recognise it as a binary or JSON order.
+ * @param msg The message from the WebSocket client.
+ * @param books The BookManager owning the per-symbol OrderBooks.
+ * @param risk The RiskEngine for position tracking and limits.
+ */
+void process_message(InboundMessage& msg, BookManager& books, RiskEngine& risk) {
+    if (msg.kind == InboundKind::BINARY) {
+        process_binary_message(msg.binary, books, risk);
+        return;
+    }
+    if (msg.kind == InboundKind::ORDER) {
+        route_limit_order(books, risk, msg.order);
+        return;
+    }
+
+    json& doc = msg.document;
+    try {
+        // Check if this is our echoed subscription message
+        if (doc.contains("type") && doc["type"] == "subscribe" && doc.contains("symbol")) {
+            // Parse the actual order data from the symbol field
+            json order_data = json::parse(doc["symbol"].get<std::string>());
+            
+            if (order_data.contains("type") && order_data["type"] == "limit") {
+                route_json_limit_order(order_data, books, risk);
+            } else {
+                LOG_WARN("[DATA HANDLER] Nested message doesn't contain valid limit order data.");
+            }
+        }
+        // Direct limit order format (for future real feeds)
+        else if (doc.contains("type") && doc["type"] == "limit") {
+            route_json_limit_order(doc, books, risk);
+        } else {
+            LOG_WARN("[DATA HANDLER] Message doesn't contain valid order data.");
+        }
+    } catch (const std::exception& e) {
+        LOG_ERROR("[DATA HANDLER] Error processing message: %s | Message: %s", e.what(), doc.dump().c_str());
+    }
+}
+
+/**
+ * @brief Processes messages from the WebSocket and feeds orders to the matching shards.
  * Now includes pre-trade risk checking.
  * @param client The WebSocket client to pull messages from.
- * @param book The OrderBook to update.
+ * @param books The BookManager owning the per-symbol OrderBooks.
  * @param risk The RiskEngine for position tracking and limits.
  * @param running An atomic flag to signal when to stop.
  */
-void market_data_handler(WebSocketClient& client, OrderBook& book, RiskEngine& risk, std::atomic<bool>& running) {
-    std::cout << "[DATA HANDLER] Market data handler started with risk management..." << std::endl;
-    json msg;
+void market_data_handler(WebSocketClient& client, BookManager& books, RiskEngine& risk, std::atomic<bool>& running) {
+    LOG_INFO("[DATA HANDLER] Market data handler started with risk management...");
+    // Drain the client's queue in batches so each wakeup handles many messages
+    std::vector<InboundMessage> batch(64);
     int processed_count = 0;
     
-    while (running && client.get_message(msg)) {
-        processed_count++;
-        std::cout << "[DATA HANDLER] Processing message #" << processed_count << std::endl;
-        
-        try {
-            // Check if this is our echoed subscription message
-            if (msg.contains("type") && msg["type"] == "subscribe" && msg.contains("symbol")) {
-                // Parse the actual order data from the symbol field
-                json order_data = json::parse(msg["symbol"].get<std::string>());
-                
-                if (order_data.contains("type") && order_data["type"] == "limit") {
-                    std::string symbol_str = order_data["symbol"];
-                    std::string side_str = order_data["side"];
-                    double price = order_data["price"];
-                    uint64_t quantity = order_data["quantity"];
-
-                    OrderSide side = (side_str == "buy") ? OrderSide::BUY : OrderSide::SELL;
-                    
-                    auto order = std::make_shared<Order>(
-                        order_id_counter++, 
-                        symbol_str,
-                        OrderType::LIMIT, 
-                        side, 
-                        price, 
-                        quantity
-                    );
-
-                    // **PRE-TRADE RISK CHECK**
-                    std::cout << "[DATA HANDLER] Checking risk for: " << side_str << " " << quantity << " @ " << price << std::endl;
-                    if (risk.check_pre_trade_risk(*order)) {
-                        std::cout << "[DATA HANDLER] Order APPROVED and added to book." << std::endl;
-                        book.add_order(order);
-                    } else {
-                        std::cout << "[DATA HANDLER] Order REJECTED by risk engine." << std::endl;
-                    }
-                } else {
-                    std::cout << "[DATA HANDLER] Nested message doesn't contain valid limit order data." << std::endl;
-                }
-            }
-            // Direct limit order format (for future real feeds)
-            else if (msg.contains("type") && msg["type"] == "limit") {
-                std::string symbol_str = msg["symbol"];
-                std::string side_str = msg["side"];
-                double price = msg["price"];
-                uint64_t quantity = msg["quantity"];
-
-                OrderSide side = (side_str == "buy") ? OrderSide::BUY : OrderSide::SELL;
-                
-                auto order = std::make_shared<Order>(
-                    order_id_counter++, 
-                    symbol_str,
-                    OrderType::LIMIT, 
-                    side, 
-                    price, 
-                    quantity
-                );
-
-                // **PRE-TRADE RISK CHECK**
-                if (risk.check_pre_trade_risk(*order)) {
-                    std::cout << "[DATA HANDLER] Order APPROVED and added to book." << std::endl;
-                    book.add_order(order);
-                } else {
-                    std::cout << "[DATA HANDLER] Order REJECTED by risk engine." << std::endl;
-                }
-            } else {
-                std::cout << "[DATA HANDLER] Message doesn't contain valid order data." << std::endl;
-            }
-        } catch (const std::exception& e) {
-            std::cerr << "[DATA HANDLER] Error processing message: " << e.what() << " | Message: " << msg.dump() << std::endl;
+    while (running) {
+        const size_t batch_size = client.get_messages(batch.data(), batch.size());
+        if (batch_size == 0) {
+            break; // Disconnected and drained
+        }
+        for (size_t i = 0; i < batch_size; ++i) {
+            processed_count++;
+            LOG_DEBUG("[DATA HANDLER] Processing message #%d", processed_count);
+            process_message(batch[i], books, risk);
         }
     }
-    std::cout << "[DATA HANDLER] Market data handler thread finished. Processed " << processed_count << " messages." << std::endl;
+    LOG_INFO("[DATA HANDLER] Market data handler thread finished. Processed %d messages, %" PRIu64
+             " dropped on queue overflow.", processed_count, client.overflow_count());
 }
 
 /**
@@ -104,7 +234,7 @@ void market_data_handler(WebSocketClient& client, OrderBook& book, RiskEngine& r
  * @param running An atomic flag to signal when to stop.
  */
 void simulate_exchange_feed(WebSocketClient& client, std::atomic<bool>& running) {
-    std::cout << "[SIMULATOR] Starting 30-second demo exchange feed simulation..." << std::endl;
+    LOG_INFO("[SIMULATOR] Starting 30-second demo exchange feed simulation...");
     
     int cycle = 0;
     double base_price = 50000.0; // Starting BTC price
@@ -117,7 +247,7 @@ void simulate_exchange_feed(WebSocketClient& client, std::atomic<bool>& running)
     while(running) {
         auto elapsed = std::chrono::steady_clock::now() - start_time;
         if (elapsed >= demo_duration) {
-            std::cout << "[SIMULATOR] 30-second demo completed!" << std::endl;
+            LOG_INFO("[SIMULATOR] 30-second demo completed!");
             break;
         }
         
@@ -131,8 +261,12 @@ void simulate_exchange_feed(WebSocketClient& client, std::atomic<bool>& running)
         double buy_price = symbol_base + price_variation;
         double sell_price = buy_price + (symbol_base * 0.001); // Small spread
         
-        std::cout << "[SIMULATOR] Cycle " << cycle << " - Trading " << symbol 
-                  << " at ~$" << (int)buy_price << std::endl;
+        // Alternate desks each cycle, so crossing orders meet both the other
+        // desk (a real trade) and the same desk (cancelled by self-trade prevention)
+        const AccountId account = (cycle % 2 == 0) ? kHouseAccount : kSecondDeskAccount;
+
+        LOG_INFO("[SIMULATOR] Cycle %d - Account %u trading %s at ~$%d", cycle, account, symbol.c_str(),
+                 (int)buy_price);
         
         // Simulate a buy order with varying quantities
         json buy_order;
@@ -141,6 +275,8 @@ void simulate_exchange_feed(WebSocketClient& client, std::atomic<bool>& running)
         buy_order["side"] = "buy";
         buy_order["price"] = buy_price;
         buy_order["quantity"] = 10 + (cycle % 50); // 10-60 quantity range
+        buy_order["account"] = account;
+        buy_order["stp"] = "cancel_resting";
         client.subscribe(buy_order.dump());
         
         std::this_thread::sleep_for(std::chrono::milliseconds(800)); // Slower for demo
@@ -154,6 +290,8 @@ void simulate_exchange_feed(WebSocketClient& client, std::atomic<bool>& running)
         sell_order["side"] = "sell";
         sell_order["price"] = sell_price;
         sell_order["quantity"] = 5 + (cycle % 25); // 5-30 quantity range
+        sell_order["account"] = account;
+        sell_order["stp"] = "cancel_resting";
         client.subscribe(sell_order.dump());
 
         std::this_thread::sleep_for(std::chrono::milliseconds(1200)); // Slower for demo
@@ -166,67 +304,229 @@ void simulate_exchange_feed(WebSocketClient& client, std::atomic<bool>& running)
             large_order["side"] = (cycle % 10 == 0) ? "buy" : "sell";
             large_order["price"] = (cycle % 10 == 0) ? buy_price - 1 : sell_price + 1;
             large_order["quantity"] = 100; // Large order to potentially trigger risk limits
+            large_order["account"] = account;
+            large_order["stp"] = "decrement";
             
-            std::cout << "[SIMULATOR] Sending LARGE " << large_order["side"] 
-                      << " order for " << symbol << " - quantity: 100" << std::endl;
+            LOG_INFO("[SIMULATOR] Sending LARGE %s order for %s - quantity: 100",
+                     (cycle % 10 == 0) ? "buy" : "sell", symbol.c_str());
             client.subscribe(large_order.dump());
             
             std::this_thread::sleep_for(std::chrono::milliseconds(500));
         }
     }
-    std::cout << "[SIMULATOR] Exchange feed simulation completed after " << cycle << " cycles." << std::endl;
+    LOG_INFO("[SIMULATOR] Exchange feed simulation completed after %d cycles.", cycle);
+}
+
+
+/**
+ * @brief Polls one batch from `feed` into `batch` and hands each item to `handle`.
+ * @return The number of items handled.
+ */
+template <typename T, typename Handler>
+size_t drain(FeedSubscription<T>& feed, std::vector<T>& batch, Handler&& handle) {
+    const size_t count = feed.poll(batch.data(), batch.size());
+    for (size_t i = 0; i < count; ++i) {
+        handle(batch[i]);
+    }
+    return count;
+}
+
+/**
+ * @brief Calls `drain_feeds` until `running` clears and a pass finds nothing
+ *        left, backing off while the feeds are idle.
+ */
+template <typename DrainFeeds>
+void consume_feeds(std::atomic<bool>& running, DrainFeeds drain_feeds) {
+    Backoff backoff;
+    for (;;) {
+        if (drain_feeds() == 0) {
+            if (!running) {
+                return;
+            }
+            backoff.idle();
+            continue;
+        }
+        backoff.reset();
+    }
 }
 
+// Snapshot the books and positions periodically so a restart replays only the
+// journal written since the last one
+void snapshot_books(BookManager& books, const BookManager::SnapshotCapture& capture, std::atomic<bool>& running) {
+    const auto interval = std::chrono::seconds(30);
+    auto next = std::chrono::steady_clock::now() + interval;
+    while (running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (std::chrono::steady_clock::now() < next) {
+            continue;
+        }
+        next += interval;
+        std::string error;
+        if (!books.save_snapshot(capture, error)) {
+            LOG_WARN("[SNAPSHOT] Failed: %s", error.c_str());
+        }
+    }
+}
 
 int main() {
     std::cout << "=== Real-Time Trading System with GUI Dashboard ===" << std::endl;
+    // Hot-path threads log through per-thread buffers; this thread does the I/O
+    Logger::instance().start();
     
     // 1. Initialize components
-    auto order_book = std::make_shared<OrderBook>();
+    // One book per symbol, spread across matching shards. The dashboard reads the
+    // BTC book's published depth snapshot, so the books run without locks.
+    BookManagerConfig book_config;
+    book_config.num_shards = 2;
+    // Every order and trade is journaled; a restart replays it to rebuild state
+    book_config.journal_dir = "journal";
+    // Command outcomes let the risk thread keep each order's reservation exact
+    book_config.report_order_status = true;
+    // Level and per-order changes feed the local market-data socket
+    book_config.book_feed = BookFeedDepth::ORDERS;
+    auto book_manager = std::make_shared<BookManager>(book_config);
+    for (const char* symbol : {"BTC-USD", "ETH-USD", "SOL-USD"}) {
+        book_manager->add_symbol(symbol);
+    }
     auto ws_client = std::make_shared<WebSocketClient>();
     auto risk_engine = std::make_shared<RiskEngine>(80.0); // Set max position size to 80
-    auto dashboard = std::make_shared<Dashboard>(*order_book, *risk_engine);
+    for (const char* symbol : {"BTC-USD", "ETH-USD", "SOL-USD"}) {
+        const SymbolId symbol_id = SymbolTable::instance().intern(symbol);
+        SymbolLimits limits;
+        limits.max_position = 80;
+        limits.max_order_quantity = 200;
+        limits.price_collar_bps = 500; // 5% either side of the last trade
+        limits.max_orders_per_second = 50;
+        limits.tick_size = book_manager->book(symbol_id)->tick_size();
+        risk_engine->set_symbol_limits(symbol_id, limits);
+    }
+    const SymbolId btc_usd = SymbolTable::instance().intern("BTC-USD");
+    auto marks = std::make_shared<MarkToMarket>();
+    auto dashboard = std::make_shared<Dashboard>(*book_manager->book(btc_usd), *risk_engine, *marks, kHouseAccount);
     
     std::atomic<bool> running(true);
 
-    std::cout << "1. Setting up trade callback with GUI and risk engine..." << std::endl;
-    // 2. Set up the trade callback to update both the risk engine and dashboard
-    order_book->on_trade([&](const Trade& trade) {
-        std::cout << "\n>>> TRADE EXECUTED <<<" << std::endl;
-        std::cout << "   Price: " << trade.price << ", Quantity: " << trade.quantity << std::endl;
-        std::cout << "   Resting Order ID: " << trade.resting_order_id << ", Aggressive Order ID: " << trade.aggressive_order_id << std::endl;
-        
-        // Update risk engine and dashboard
-        risk_engine->update_on_trade(trade, OrderSide::BUY, "BTC-USD");
-        dashboard->add_trade_to_history(trade);
-        std::cout << "~~~~~~~~~~~~~~~~~~~~~~\n" << std::endl;
+    LOG_INFO("1. Subscribing the risk engine and GUI to executions...");
+    // 2. Risk and the dashboard each drain fills on their own thread, so neither
+    // holds up matching. The risk thread also marks positions to the best bid/ask.
+    ExecutionSubscription risk_feed = book_manager->subscribe_executions();
+    QuoteSubscription quote_feed = book_manager->subscribe_quotes();
+    ExecutionSubscription gui_feed = book_manager->subscribe_executions();
+    std::atomic<bool> consumers_running(true);
+    // Owned by the risk thread once the books start
+    OrderReservations reservations(*risk_engine);
+    // Downstream consumers get the books' L2/L3 changes over a UNIX socket.
+    // Dropping the publisher also drops its subscription, so a socket that
+    // cannot be opened never leaves the shards waiting on an undrained ring.
+    auto md_publisher = std::make_unique<MarketDataPublisher>(*book_manager);
+    std::string md_error;
+    if (!md_publisher->start("market_data.sock", md_error)) {
+        LOG_WARN("[MD PUBLISHER] Market data feed disabled: %s", md_error.c_str());
+        md_publisher.reset();
+    }
+    auto on_execution = [&](const ExecutionReport& report) {
+        reservations.on_execution(report);
+        if (report.type == ExecutionType::ORDER_STATUS) {
+            return;
+        }
+        if (report.type == ExecutionType::SELF_TRADE_CANCEL) {
+            const SelfTradeCancel& cancel = report.cancel;
+            LOG_INFO(">>> SELF-TRADE PREVENTED <<< Order ID: %" PRIu64 ", Account: %u, Quantity cancelled: %" PRIu64,
+                     cancel.order_id, cancel.account_id, cancel.quantity);
+            return;
+        }
+        const Trade& trade = report.trade;
+        LOG_INFO(">>> TRADE EXECUTED <<< Price: %.2f, Quantity: %" PRIu64 ", Resting Order ID: %" PRIu64
+                 ", Aggressive Order ID: %" PRIu64, trade.price, trade.quantity, trade.resting_order_id,
+                 trade.aggressive_order_id);
+        risk_engine->update_on_trade(trade);
+        if (auto position = risk_engine->get_position(kHouseAccount, trade.symbol_id)) {
+            marks->on_position(trade.symbol_id, *position);
+        }
+    };
+    // Execution reports the risk thread has finished applying
+    std::atomic<uint64_t> risk_applied(0);
+    std::thread risk_thread([&]() {
+        std::vector<ExecutionReport> fills(256);
+        std::vector<QuoteUpdate> quotes(256);
+        consume_feeds(consumers_running, [&]() {
+            const size_t applied = drain(risk_feed, fills, on_execution);
+            risk_applied.store(risk_applied.load(std::memory_order_relaxed) + applied, std::memory_order_release);
+            return applied + drain(quote_feed, quotes, [&](const QuoteUpdate& quote) { marks->on_quote(quote); });
+        });
+    });
+    std::thread gui_thread([&]() {
+        std::vector<ExecutionReport> fills(256);
+        consume_feeds(consumers_running, [&]() {
+            return drain(gui_feed, fills, [&](const ExecutionReport& report) {
+                if (report.type == ExecutionType::TRADE) {
+                    dashboard->add_trade_to_history(report.trade);
+                }
+            });
+        });
     });
+    // The shards are paused while this runs, so nothing more is published.
+    // Polling moves the feed's cursors before the fills are applied, so wait
+    // for the risk thread's applied count rather than the cursors; then the
+    // positions cover exactly the journal records the snapshot says they do.
+    auto capture_positions = [&](Snapshot& snapshot) {
+        while (risk_applied.load(std::memory_order_acquire) < risk_feed.published()) {
+            std::this_thread::yield();
+        }
+        snapshot.positions = risk_engine->positions();
+    };
+
+    // Rebuild the books and positions from the previous session's journal
+    const RecoveryStats recovered = book_manager->recover(
+        [&](const Trade& trade) {
+            risk_engine->update_on_trade(trade);
+            dashboard->add_trade_to_history(trade);
+        },
+        [&](const Snapshot& snapshot) { risk_engine->restore_positions(snapshot.positions); });
+    // Nothing reaches the risk thread before start(), so this thread can seed the marks
+    for (const Position& position : risk_engine->positions()) {
+        if (position.account_id != kHouseAccount) {
+            continue;
+        }
+        marks->on_position(SymbolTable::instance().intern(position.symbol), position);
+    }
+    // Recovered resting orders are working again, so reserve what each has left
+    for (const char* symbol : {"BTC-USD", "ETH-USD", "SOL-USD"}) {
+        reservations.reserve_resting(*book_manager->book(SymbolTable::instance().intern(symbol)));
+    }
+    if (recovered.records > 0) {
+        // Keep new order ids clear of the recovered ones
+        order_id_counter = recovered.max_order_id + 1;
+        LOG_INFO("Recovered %" PRIu64 " journal records", recovered.records);
+    }
+    book_manager->start();
 
-    std::cout << "2. Connecting to WebSocket server..." << std::endl;
+    LOG_INFO("2. Connecting to WebSocket server...");
     // 3. Connect to the WebSocket server
     ws_client->connect("ws://echo.websocket.events");
     std::this_thread::sleep_for(std::chrono::seconds(2)); // Wait for connection
 
-    std::cout << "3. Starting market data handler with risk management..." << std::endl;
+    LOG_INFO("3. Starting market data handler with risk management...");
     // 4. Start the thread that processes incoming data and updates the order book
-    std::thread handler_thread(market_data_handler, std::ref(*ws_client), std::ref(*order_book), std::ref(*risk_engine), std::ref(running));
+    std::thread handler_thread(market_data_handler, std::ref(*ws_client), std::ref(*book_manager), std::ref(*risk_engine), std::ref(running));
     
-    std::cout << "4. Starting exchange feed simulator..." << std::endl;
+    LOG_INFO("4. Starting exchange feed simulator...");
     // 5. Start a thread to simulate the exchange sending us data
     std::thread simulator_thread(simulate_exchange_feed, std::ref(*ws_client), std::ref(running));
+    std::thread snapshot_thread(snapshot_books, std::ref(*book_manager), capture_positions, std::ref(running));
 
-    std::cout << "5. Launching GUI Dashboard..." << std::endl;
-    std::cout << "   Close the GUI window to shutdown the trading system." << std::endl;
+    LOG_INFO("5. Launching GUI Dashboard...");
+    LOG_INFO("   Close the GUI window to shutdown the trading system.");
     
     // 6. Run the GUI - This will block until the window is closed
     try {
         dashboard->run();
     } catch (const std::exception& e) {
-        std::cerr << "Dashboard error: " << e.what() << std::endl;
+        LOG_ERROR("Dashboard error: %s", e.what());
     }
 
     // 7. Clean up after GUI closes
-    std::cout << "Dashboard closed. Shutting down backend threads..." << std::endl;
+    LOG_INFO("Dashboard closed. Shutting down backend threads...");
     running = false;
     ws_client->close();
 
@@ -236,6 +536,23 @@ int main() {
     if (simulator_thread.joinable()) {
         simulator_thread.join();
     }
+    if (snapshot_thread.joinable()) {
+        snapshot_thread.join();
+    }
+    // A final snapshot leaves the next start only a short journal tail to replay
+    std::string snapshot_error;
+    if (!book_manager->save_snapshot(capture_positions, snapshot_error)) {
+        LOG_WARN("[SNAPSHOT] Final snapshot failed: %s", snapshot_error.c_str());
+    }
+    book_manager->stop();
+    if (md_publisher) {
+        md_publisher->stop();
+    }
+    // Executions published while the shards drained are still delivered
+    consumers_running = false;
+    risk_thread.join();
+    gui_thread.join();
+    Logger::instance().stop();
     
     std::cout << "All threads stopped. Main application finished." << std::endl;
     return 0;
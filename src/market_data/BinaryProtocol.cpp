@@ -0,0 +1,51 @@
+#include "BinaryProtocol.h"
+#include <cstring>
+
+namespace wire {
+
+namespace {
+
+size_t expected_size(MessageType type) {
+    switch (type) {
+        case MessageType::NEW_ORDER: return sizeof(NewOrder);
+        case MessageType::CANCEL: return sizeof(Cancel);
+        case MessageType::REPLACE: return sizeof(Replace);
+        case MessageType::EXEC_REPORT: return sizeof(ExecReport);
+    }
+    return 0;
+}
+
+bool valid_side(uint8_t side) {
+    return side <= static_cast<uint8_t>(OrderSide::SELL);
+}
+
+bool valid_fields(const Message& msg) {
+    switch (msg.header.type) {
+        case MessageType::NEW_ORDER:
+            return valid_side(msg.new_order.side) && msg.new_order.order_type <= static_cast<uint8_t>(OrderType::MARKET) &&
+                   msg.new_order.time_in_force <= static_cast<uint8_t>(TimeInForce::FOK) &&
+                   msg.new_order.self_trade_prevention <= static_cast<uint8_t>(SelfTradePrevention::DECREMENT);
+        case MessageType::REPLACE: return valid_side(msg.replace.side);
+        case MessageType::EXEC_REPORT:
+            return valid_side(msg.exec_report.side) && msg.exec_report.exec_type <= ExecType::REJECTED;
+        case MessageType::CANCEL: return true;
+    }
+    return false;
+}
+
+} // namespace
+
+bool decode(const void* data, size_t size, Message& out) {
+    if (size < sizeof(MessageHeader)) {
+        return false;
+    }
+    MessageHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.version != kProtocolVersion || header.length != size || expected_size(header.type) != size) {
+        return false;
+    }
+    std::memcpy(&out, data, size);
+    return valid_fields(out);
+}
+
+} // namespace wire
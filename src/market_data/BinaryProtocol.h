@@ -0,0 +1,134 @@
+#pragma once
+
+#include "common/SymbolTable.h"
+#include "order_book/Order.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Fixed-layout binary order entry messages for internal flow.
+ *
+ * Every message is a packed little-endian struct that starts with a
+ * MessageHeader and travels alone in one binary WebSocket frame. Symbols are
+ * the SymbolIds registered with the BookManager and prices are integer ticks of
+ * the target book, so decoding is a length check and a memcpy. JSON text frames
+ * stay available for debugging.
+ */
+namespace wire {
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "wire messages are encoded in host byte order");
+
+constexpr uint8_t kProtocolVersion = 3;
+
+enum class MessageType : uint8_t {
+    NEW_ORDER = 1,
+    CANCEL = 2,
+    REPLACE = 3,
+    EXEC_REPORT = 4
+};
+
+enum class ExecType : uint8_t {
+    ACCEPTED = 0,
+    PARTIAL_FILL = 1,
+    FILL = 2,
+    CANCELED = 3,
+    REJECTED = 4
+};
+
+#pragma pack(push, 1)
+
+struct MessageHeader {
+    MessageType type;
+    uint8_t version;
+    uint16_t length; // Whole message, header included
+};
+
+struct NewOrder {
+    MessageHeader header;
+    uint64_t order_id;
+    SymbolId symbol_id;
+    uint8_t side;       // OrderSide
+    uint8_t order_type; // OrderType
+    uint8_t time_in_force; // TimeInForce
+    int64_t price; // Ticks; ignored for MARKET orders
+    uint64_t quantity;
+    AccountId account_id;
+    uint8_t self_trade_prevention; // SelfTradePrevention
+};
+
+struct Cancel {
+    MessageHeader header;
+    uint64_t order_id;
+    SymbolId symbol_id;
+};
+
+// Replaces the price and quantity of a resting order, keeping its id, side and account
+struct Replace {
+    MessageHeader header;
+    uint64_t order_id;
+    SymbolId symbol_id;
+    uint8_t side; // OrderSide
+    int64_t price; // Ticks
+    uint64_t quantity;
+    AccountId account_id;
+};
+
+struct ExecReport {
+    MessageHeader header;
+    uint64_t order_id;
+    uint64_t trade_id;
+    SymbolId symbol_id;
+    ExecType exec_type;
+    uint8_t side; // OrderSide
+    int64_t last_price; // Ticks
+    uint64_t last_quantity;
+    uint64_t leaves_quantity;
+};
+
+#pragma pack(pop)
+
+// Any decoded message, tagged by header.type
+union Message {
+    MessageHeader header;
+    NewOrder new_order;
+    Cancel cancel;
+    Replace replace;
+    ExecReport exec_report;
+};
+
+// Copy a frame into `out`. Returns false on an unknown type, an unsupported
+// version, a frame whose size does not match its type, or an out-of-range enum.
+bool decode(const void* data, size_t size, Message& out);
+
+template <typename Msg>
+constexpr MessageHeader header_for(MessageType type) {
+    return MessageHeader{type, kProtocolVersion, static_cast<uint16_t>(sizeof(Msg))};
+}
+
+inline NewOrder make_new_order(uint64_t order_id, SymbolId symbol_id, OrderSide side, OrderType order_type,
+                               int64_t price, uint64_t quantity, TimeInForce time_in_force = TimeInForce::GTC,
+                               AccountId account_id = 0,
+                               SelfTradePrevention self_trade_prevention = SelfTradePrevention::NONE) {
+    return NewOrder{header_for<NewOrder>(MessageType::NEW_ORDER), order_id, symbol_id, static_cast<uint8_t>(side),
+                    static_cast<uint8_t>(order_type), static_cast<uint8_t>(time_in_force), price, quantity,
+                    account_id, static_cast<uint8_t>(self_trade_prevention)};
+}
+
+inline Cancel make_cancel(uint64_t order_id, SymbolId symbol_id) {
+    return Cancel{header_for<Cancel>(MessageType::CANCEL), order_id, symbol_id};
+}
+
+inline Replace make_replace(uint64_t order_id, SymbolId symbol_id, OrderSide side, int64_t price, uint64_t quantity,
+                            AccountId account_id = 0) {
+    return Replace{header_for<Replace>(MessageType::REPLACE), order_id, symbol_id, static_cast<uint8_t>(side), price,
+                   quantity, account_id};
+}
+
+inline ExecReport make_exec_report(uint64_t order_id, uint64_t trade_id, SymbolId symbol_id, ExecType exec_type,
+                                   OrderSide side, int64_t last_price, uint64_t last_quantity,
+                                   uint64_t leaves_quantity) {
+    return ExecReport{header_for<ExecReport>(MessageType::EXEC_REPORT), order_id, trade_id, symbol_id, exec_type,
+                      static_cast<uint8_t>(side), last_price, last_quantity, leaves_quantity};
+}
+
+} // namespace wire
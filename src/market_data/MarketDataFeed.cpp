@@ -0,0 +1,145 @@
+#include "MarketDataFeed.h"
+#include <cstring>
+#include <utility>
+
+namespace md {
+
+namespace {
+
+size_t message_size(FeedMessageType type) {
+    switch (type) {
+        case FeedMessageType::LEVEL: return sizeof(LevelMessage);
+        case FeedMessageType::ORDER_ADD:
+        case FeedMessageType::ORDER_MODIFY: return sizeof(OrderMessage);
+        case FeedMessageType::ORDER_DELETE: return sizeof(OrderDeleteMessage);
+        case FeedMessageType::BOOK_RESET: return sizeof(BookResetMessage);
+    }
+    return 0;
+}
+
+} // namespace
+
+FeedEncoder::FeedEncoder(PacketSink sink, size_t max_packet_size)
+    : sink_(std::move(sink)),
+      packet_(max_packet_size),
+      size_(sizeof(PacketHeader)),
+      message_count_(0),
+      next_sequence_(1) {}
+
+void FeedEncoder::add(const BookUpdate& update) {
+    const uint8_t side = static_cast<uint8_t>(update.side);
+    switch (update.type) {
+        case BookUpdateType::LEVEL:
+            append(LevelMessage{FeedMessageType::LEVEL, side, update.symbol_id, update.price, update.quantity,
+                                update.order_count});
+            break;
+        case BookUpdateType::ORDER_ADD:
+            append(OrderMessage{FeedMessageType::ORDER_ADD, side, update.symbol_id, update.order_id, update.price,
+                                update.quantity});
+            break;
+        case BookUpdateType::ORDER_MODIFY:
+            append(OrderMessage{FeedMessageType::ORDER_MODIFY, side, update.symbol_id, update.order_id, update.price,
+                                update.quantity});
+            break;
+        case BookUpdateType::ORDER_DELETE:
+            append(OrderDeleteMessage{FeedMessageType::ORDER_DELETE, side, update.symbol_id, update.order_id});
+            break;
+        case BookUpdateType::BOOK_RESET:
+            append(BookResetMessage{FeedMessageType::BOOK_RESET, 0, update.symbol_id});
+            break;
+    }
+}
+
+template <typename Msg>
+void FeedEncoder::append(const Msg& msg) {
+    if (size_ + sizeof(Msg) > packet_.size()) {
+        flush();
+    }
+    std::memcpy(packet_.data() + size_, &msg, sizeof(Msg));
+    size_ += sizeof(Msg);
+    ++message_count_;
+}
+
+void FeedEncoder::flush() {
+    if (message_count_ == 0) {
+        return;
+    }
+    const PacketHeader header{kFeedVersion, 0, message_count_, static_cast<uint16_t>(size_), next_sequence_};
+    std::memcpy(packet_.data(), &header, sizeof(header));
+    sink_(packet_.data(), size_);
+    next_sequence_ += message_count_;
+    size_ = sizeof(PacketHeader);
+    message_count_ = 0;
+}
+
+void FeedEncoder::skip(uint64_t count) {
+    flush();
+    next_sequence_ += count;
+}
+
+bool decode_packet(const void* data, size_t size, uint64_t& first_sequence, std::vector<BookUpdate>& out) {
+    if (size < sizeof(PacketHeader)) {
+        return false;
+    }
+    PacketHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.version != kFeedVersion || header.length != size) {
+        return false;
+    }
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    const size_t first = out.size();
+    size_t offset = sizeof(PacketHeader);
+    for (uint16_t i = 0; i < header.message_count; ++i) {
+        const size_t length = offset < size ? message_size(static_cast<FeedMessageType>(bytes[offset])) : 0;
+        if (length == 0 || offset + length > size || bytes[offset + 1] > static_cast<uint8_t>(OrderSide::SELL)) {
+            out.resize(first);
+            return false;
+        }
+        BookUpdate update;
+        switch (static_cast<FeedMessageType>(bytes[offset])) {
+            case FeedMessageType::LEVEL: {
+                LevelMessage msg;
+                std::memcpy(&msg, bytes + offset, sizeof(msg));
+                update.type = BookUpdateType::LEVEL;
+                update.price = msg.price;
+                update.quantity = msg.quantity;
+                update.order_count = msg.order_count;
+                break;
+            }
+            case FeedMessageType::ORDER_ADD:
+            case FeedMessageType::ORDER_MODIFY: {
+                OrderMessage msg;
+                std::memcpy(&msg, bytes + offset, sizeof(msg));
+                update.type = (msg.type == FeedMessageType::ORDER_ADD) ? BookUpdateType::ORDER_ADD
+                                                                       : BookUpdateType::ORDER_MODIFY;
+                update.order_id = msg.order_id;
+                update.price = msg.price;
+                update.quantity = msg.quantity;
+                break;
+            }
+            case FeedMessageType::ORDER_DELETE: {
+                OrderDeleteMessage msg;
+                std::memcpy(&msg, bytes + offset, sizeof(msg));
+                update.type = BookUpdateType::ORDER_DELETE;
+                update.order_id = msg.order_id;
+                break;
+            }
+            case FeedMessageType::BOOK_RESET:
+                update.type = BookUpdateType::BOOK_RESET;
+                break;
+        }
+        update.side = static_cast<OrderSide>(bytes[offset + 1]);
+        std::memcpy(&update.symbol_id, bytes + offset + 2, sizeof(update.symbol_id));
+        out.push_back(update);
+        offset += length;
+    }
+    if (offset != size) {
+        out.resize(first);
+        return false;
+    }
+    first_sequence = header.first_sequence;
+    return true;
+}
+
+} // namespace md
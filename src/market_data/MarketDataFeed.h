@@ -0,0 +1,127 @@
+#pragma once
+
+#include "order_book/BookUpdate.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief Compact binary encoding of book updates for downstream consumers.
+ *
+ * Updates travel in packets: a PacketHeader followed by message_count
+ * variable-size messages, each a packed little-endian struct whose first byte
+ * is its FeedMessageType. Every message carries the next number of one
+ * feed-wide sequence; the header holds the first one, so a consumer detects a
+ * gap by comparing first_sequence with the number it expected. Prices are
+ * integer ticks of the book and symbols are the publisher's SymbolIds.
+ *
+ * LEVEL messages are coalesced, but never held past a later order message of
+ * the same book: a level's change is sent before the next ORDER_* message, so
+ * no order message is followed by a level change that happened before it.
+ *
+ * A BOOK_RESET starts a fresh copy of one book: the messages after it restate
+ * the book's levels (and orders) as of that sequence number, and later ones
+ * change it from there. A consumer that joins late, or sees a gap, discards
+ * its copy of a book and applies that book's messages from its next reset.
+ */
+namespace md {
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "feed messages are encoded in host byte order");
+
+constexpr uint8_t kFeedVersion = 2;
+// Small enough for one datagram or SOCK_SEQPACKET record on any platform
+constexpr size_t kMaxPacketSize = 4096;
+
+enum class FeedMessageType : uint8_t {
+    LEVEL = 1,
+    ORDER_ADD = 2,
+    ORDER_MODIFY = 3,
+    ORDER_DELETE = 4,
+    BOOK_RESET = 5
+};
+
+#pragma pack(push, 1)
+
+struct PacketHeader {
+    uint8_t version;
+    uint8_t reserved;
+    uint16_t message_count;
+    uint16_t length;         // Whole packet, header included
+    uint64_t first_sequence; // Sequence number of the first message
+};
+
+// New aggregate of one price level; zero quantity removes the level
+struct LevelMessage {
+    FeedMessageType type;
+    uint8_t side; // OrderSide
+    SymbolId symbol_id;
+    int64_t price;
+    uint64_t quantity;
+    uint32_t order_count;
+};
+
+// ORDER_ADD and ORDER_MODIFY; quantity is what the order has left
+struct OrderMessage {
+    FeedMessageType type;
+    uint8_t side; // OrderSide
+    SymbolId symbol_id;
+    uint64_t order_id;
+    int64_t price;
+    uint64_t quantity;
+};
+
+struct OrderDeleteMessage {
+    FeedMessageType type;
+    uint8_t side; // OrderSide
+    SymbolId symbol_id;
+    uint64_t order_id;
+};
+
+// The book's state follows; side is always 0
+struct BookResetMessage {
+    FeedMessageType type;
+    uint8_t side;
+    SymbolId symbol_id;
+};
+
+#pragma pack(pop)
+
+/**
+ * @brief Packs book updates into numbered packets.
+ *
+ * add() appends one message to the packet being built and hands the packet to
+ * the sink first if the message would not fit; flush() hands over whatever is
+ * buffered. Not thread-safe; one encoder serves one feed.
+ */
+class FeedEncoder {
+public:
+    using PacketSink = std::function<void(const uint8_t* data, size_t size)>;
+
+    explicit FeedEncoder(PacketSink sink, size_t max_packet_size = kMaxPacketSize);
+
+    void add(const BookUpdate& update);
+    void flush();
+    // Flush, then leave `count` sequence numbers unused, so consumers see a
+    // gap where updates were lost before reaching the encoder
+    void skip(uint64_t count);
+
+    // Sequence number the next message will be given
+    uint64_t next_sequence() const { return next_sequence_; }
+
+private:
+    template <typename Msg>
+    void append(const Msg& msg);
+
+    PacketSink sink_;
+    std::vector<uint8_t> packet_;
+    size_t size_;
+    uint16_t message_count_;
+    uint64_t next_sequence_;
+};
+
+// Decode one packet into `out` (appending). Returns false, having appended
+// nothing, on a bad version or length, or on a truncated or unknown message.
+bool decode_packet(const void* data, size_t size, uint64_t& first_sequence, std::vector<BookUpdate>& out);
+
+} // namespace md
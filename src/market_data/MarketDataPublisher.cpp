@@ -0,0 +1,145 @@
+#include "MarketDataPublisher.h"
+#include "common/Logger.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+MarketDataPublisher::MarketDataPublisher(BookManager& books, const MarketDataPublisherConfig& config)
+    : config_(config),
+      books_(books),
+      subscription_(books.subscribe_book_updates()),
+      encoder_([this](const uint8_t* data, size_t size) { send_packet(data, size); }),
+      listen_fd_(-1),
+      running_(false) {}
+
+MarketDataPublisher::~MarketDataPublisher() {
+    stop();
+}
+
+bool MarketDataPublisher::start(const std::string& path, std::string& error) {
+    if (running_.load()) {
+        return true;
+    }
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path)) {
+        error = "socket path too long: " + path;
+        return false;
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    listen_fd_ = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK, 0);
+    if (listen_fd_ < 0) {
+        error = std::string("socket: ") + std::strerror(errno);
+        return false;
+    }
+    ::unlink(path.c_str());
+    if (::bind(listen_fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listen_fd_, static_cast<int>(config_.max_clients)) != 0) {
+        error = "cannot listen on " + path + ": " + std::strerror(errno);
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    path_ = path;
+    running_.store(true);
+    thread_ = std::thread(&MarketDataPublisher::run, this);
+    return true;
+}
+
+void MarketDataPublisher::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    for (int fd : client_fds_) {
+        ::close(fd);
+    }
+    client_fds_.clear();
+    client_count_.store(0, std::memory_order_relaxed);
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+    ::unlink(path_.c_str());
+}
+
+void MarketDataPublisher::run() {
+    std::vector<BookUpdate> batch(config_.batch_size);
+    Backoff backoff(config_.wait_strategy);
+    for (;;) {
+        accept_clients();
+        const size_t count = subscription_.poll(batch.data(), batch.size());
+        if (count > 0) {
+            backoff.reset();
+            for (size_t i = 0; i < count; ++i) {
+                encode(batch[i]);
+            }
+            encoder_.flush();
+            continue;
+        }
+        if (!running_.load(std::memory_order_acquire)) {
+            return;
+        }
+        backoff.idle();
+    }
+}
+
+// The first update of a book only sets where its numbering starts, since the
+// subscription may have begun mid-stream
+void MarketDataPublisher::encode(const BookUpdate& update) {
+    if (update.symbol_id >= book_sequences_.size()) {
+        book_sequences_.resize(update.symbol_id + 1, 0);
+    }
+    uint64_t& last = book_sequences_[update.symbol_id];
+    if (last != 0 && update.sequence > last + 1) {
+        const uint64_t lost = update.sequence - last - 1;
+        encoder_.skip(lost);
+        updates_lost_.fetch_add(lost, std::memory_order_relaxed);
+    }
+    last = update.sequence;
+    encoder_.add(update);
+}
+
+// One state request covers every client accepted in the same pass
+void MarketDataPublisher::accept_clients() {
+    bool accepted = false;
+    for (;;) {
+        const int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            break;
+        }
+        if (client_fds_.size() >= config_.max_clients) {
+            LOG_WARN("[MD PUBLISHER] Client limit of %zu reached, closing new connection", config_.max_clients);
+            ::close(fd);
+            continue;
+        }
+        client_fds_.push_back(fd);
+        client_count_.store(client_fds_.size(), std::memory_order_relaxed);
+        LOG_INFO("[MD PUBLISHER] Client connected (%zu connected)", client_fds_.size());
+        accepted = true;
+    }
+    if (accepted) {
+        books_.request_book_state();
+    }
+}
+
+void MarketDataPublisher::send_packet(const uint8_t* data, size_t size) {
+    for (size_t i = 0; i < client_fds_.size();) {
+        if (::send(client_fds_[i], data, size, MSG_DONTWAIT | MSG_NOSIGNAL) == static_cast<ssize_t>(size)) {
+            ++i;
+            continue;
+        }
+        // Full buffer or closed peer; either way this client would miss packets
+        LOG_WARN("[MD PUBLISHER] Dropping client: %s", std::strerror(errno));
+        ::close(client_fds_[i]);
+        client_fds_[i] = client_fds_.back();
+        client_fds_.pop_back();
+        clients_dropped_.fetch_add(1, std::memory_order_relaxed);
+        client_count_.store(client_fds_.size(), std::memory_order_relaxed);
+    }
+    packets_sent_.fetch_add(1, std::memory_order_relaxed);
+}
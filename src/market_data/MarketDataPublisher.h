@@ -0,0 +1,78 @@
+#pragma once
+
+#include "MarketDataFeed.h"
+#include "common/Backoff.h"
+#include "order_book/BookManager.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct MarketDataPublisherConfig {
+    // Connected clients served at once; further connections are closed
+    size_t max_clients = 16;
+    // Book updates drained from the subscription per encoding pass
+    size_t batch_size = 1024;
+    WaitStrategy wait_strategy = WaitStrategy::BACKOFF;
+};
+
+/**
+ * @brief Serves a BookManager's book updates to local consumers over a UNIX
+ *        SOCK_SEQPACKET socket.
+ *
+ * A background thread drains the subscription in batches, encodes each batch
+ * with an md::FeedEncoder and sends every packet to every connected client as
+ * one record. Sends never block: a client whose socket buffer is full is
+ * disconnected rather than allowed to stall the feed or silently miss packets.
+ * Updates the manager dropped because this publisher fell a ring behind are
+ * given feed sequence numbers all the same, so clients see the gap.
+ *
+ * Each new connection asks the manager to report every book again, so a
+ * client joining mid-stream, or reconnecting after a gap, receives a
+ * BOOK_RESET and the current state of each book in sequence with the live
+ * changes. Clients already connected receive the same resets and simply
+ * rebuild each book as it stands.
+ */
+class MarketDataPublisher {
+public:
+    // Subscribes to `books` at once; the manager must outlive the publisher
+    MarketDataPublisher(BookManager& books, const MarketDataPublisherConfig& config = MarketDataPublisherConfig());
+    ~MarketDataPublisher();
+
+    MarketDataPublisher(const MarketDataPublisher&) = delete;
+    MarketDataPublisher& operator=(const MarketDataPublisher&) = delete;
+
+    // Listen at `path`, replacing any stale socket file, and start publishing
+    bool start(const std::string& path, std::string& error);
+
+    // Send every update published so far, then close every socket
+    void stop();
+
+    uint64_t packets_sent() const { return packets_sent_.load(std::memory_order_relaxed); }
+    uint64_t clients_dropped() const { return clients_dropped_.load(std::memory_order_relaxed); }
+    // Book updates the manager dropped before this publisher could read them
+    uint64_t updates_lost() const { return updates_lost_.load(std::memory_order_relaxed); }
+    size_t clients() const { return client_count_.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+    void accept_clients();
+    void send_packet(const uint8_t* data, size_t size);
+    void encode(const BookUpdate& update);
+
+    MarketDataPublisherConfig config_;
+    BookManager& books_;
+    BookUpdateSubscription subscription_;
+    md::FeedEncoder encoder_;
+    std::string path_;
+    int listen_fd_;
+    std::vector<int> client_fds_; // Touched only by the publishing thread once started
+    // Last update sequence seen per book, indexed by SymbolId; 0 until the first
+    std::vector<uint64_t> book_sequences_;
+    std::thread thread_;
+    std::atomic<bool> running_;
+    std::atomic<uint64_t> packets_sent_{0};
+    std::atomic<uint64_t> clients_dropped_{0};
+    std::atomic<uint64_t> updates_lost_{0};
+    std::atomic<size_t> client_count_{0};
+};
@@ -0,0 +1,283 @@
+#include "OrderMessageParser.h"
+#include <charconv>
+#include <cstring>
+#include <optional>
+
+namespace {
+
+// Largest escaped order accepted from a subscribe echo; it is unescaped on the stack
+constexpr size_t kMaxNestedPayload = 512;
+
+// Per-thread cache of resolved symbol names. An id never changes once interned,
+// so a hit skips the SymbolTable mutex; only a thread's first sight of a symbol,
+// and symbols that are not interned, take the lock.
+constexpr size_t kSymbolCacheSlots = 16;
+constexpr size_t kMaxCachedSymbolLength = 23;
+
+struct CachedSymbol {
+    uint8_t length = 0; // 0 marks an empty slot
+    char name[kMaxCachedSymbolLength];
+    SymbolId id = 0;
+};
+
+enum class TokenKind {
+    STRING,
+    NUMBER
+};
+
+struct Token {
+    std::string_view text; // Raw bytes, without quotes for strings
+    TokenKind kind = TokenKind::STRING;
+    bool escaped = false;  // String contains backslash escapes
+    bool present = false;
+};
+
+std::optional<SymbolId> resolve_symbol(std::string_view name) {
+    if (name.empty() || name.size() > kMaxCachedSymbolLength) {
+        return SymbolTable::instance().find(name);
+    }
+    thread_local CachedSymbol cache[kSymbolCacheSlots];
+    uint32_t hash = 2166136261u; // FNV-1a
+    for (char c : name) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+    }
+    CachedSymbol& slot = cache[hash % kSymbolCacheSlots];
+    if (slot.length == name.size() && std::memcmp(slot.name, name.data(), name.size()) == 0) {
+        return slot.id;
+    }
+    const std::optional<SymbolId> symbol_id = SymbolTable::instance().find(name);
+    if (symbol_id) {
+        std::memcpy(slot.name, name.data(), name.size());
+        slot.length = static_cast<uint8_t>(name.size());
+        slot.id = *symbol_id;
+    }
+    return symbol_id;
+}
+
+struct OrderFields {
+    Token type;
+    Token symbol;
+    Token side;
+    Token price;
+    Token quantity;
+    Token account;
+    Token stp;
+};
+
+class Scanner {
+public:
+    explicit Scanner(std::string_view text) : pos_(text.data()), end_(text.data() + text.size()) {}
+
+    bool consume(char c) {
+        skip_whitespace();
+        if (pos_ < end_ && *pos_ == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    bool at_end() {
+        skip_whitespace();
+        return pos_ == end_;
+    }
+
+    // A string or number value; objects, arrays and literals are not part of the schema
+    bool value(Token& token) {
+        skip_whitespace();
+        if (pos_ < end_ && *pos_ == '"') {
+            return string(token);
+        }
+        const char* start = pos_;
+        while (pos_ < end_ && is_number_char(*pos_)) {
+            ++pos_;
+        }
+        token = Token{std::string_view(start, static_cast<size_t>(pos_ - start)), TokenKind::NUMBER, false, true};
+        return pos_ != start;
+    }
+
+    bool string(Token& token) {
+        if (!consume('"')) {
+            return false;
+        }
+        const char* start = pos_;
+        bool escaped = false;
+        while (pos_ < end_ && *pos_ != '"') {
+            if (*pos_ == '\\') {
+                escaped = true;
+                if (++pos_ == end_) {
+                    return false;
+                }
+            }
+            ++pos_;
+        }
+        if (pos_ == end_) {
+            return false;
+        }
+        token = Token{std::string_view(start, static_cast<size_t>(pos_ - start)), TokenKind::STRING, escaped, true};
+        ++pos_;
+        return true;
+    }
+
+private:
+    static bool is_number_char(char c) {
+        return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+    }
+
+    void skip_whitespace() {
+        while (pos_ < end_ && (*pos_ == ' ' || *pos_ == '\t' || *pos_ == '\n' || *pos_ == '\r')) {
+            ++pos_;
+        }
+    }
+
+    const char* pos_;
+    const char* end_;
+};
+
+bool scan_object(std::string_view text, OrderFields& fields) {
+    Scanner in(text);
+    if (!in.consume('{')) {
+        return false;
+    }
+    do {
+        Token key;
+        Token value;
+        if (!in.string(key) || key.escaped || !in.consume(':') || !in.value(value)) {
+            return false;
+        }
+        if (key.text == "type") {
+            fields.type = value;
+        } else if (key.text == "symbol") {
+            fields.symbol = value;
+        } else if (key.text == "side") {
+            fields.side = value;
+        } else if (key.text == "price") {
+            fields.price = value;
+        } else if (key.text == "quantity") {
+            fields.quantity = value;
+        } else if (key.text == "account") {
+            fields.account = value;
+        } else if (key.text == "stp") {
+            fields.stp = value;
+        }
+        // Other scalar keys are ignored
+    } while (in.consume(','));
+    return in.consume('}') && in.at_end();
+}
+
+bool is_plain_string(const Token& token) {
+    return token.present && token.kind == TokenKind::STRING && !token.escaped;
+}
+
+bool is_number(const Token& token) {
+    return token.present && token.kind == TokenKind::NUMBER;
+}
+
+template <typename T>
+bool parse_number(std::string_view text, T& value) {
+    const char* end = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), end, value);
+    return ec == std::errc() && ptr == end;
+}
+
+// Undo JSON string escapes into `buffer`; \u sequences are left to the fallback parser
+bool unescape(std::string_view text, char* buffer, size_t capacity, size_t& length) {
+    length = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (length == capacity) {
+            return false;
+        }
+        char c = text[i];
+        if (c == '\\') {
+            switch (text[++i]) {
+                case '"': c = '"'; break;
+                case '\\': c = '\\'; break;
+                case '/': c = '/'; break;
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                case 'n': c = '\n'; break;
+                case 'r': c = '\r'; break;
+                case 't': c = '\t'; break;
+                default: return false;
+            }
+        }
+        buffer[length++] = c;
+    }
+    return true;
+}
+
+bool decode_order(const OrderFields& fields, ParsedOrder& out) {
+    if (!is_plain_string(fields.type) || fields.type.text != "limit" ||
+        !is_plain_string(fields.symbol) || !is_plain_string(fields.side) ||
+        !is_number(fields.price) || !is_number(fields.quantity)) {
+        return false;
+    }
+
+    if (fields.side.text == "buy") {
+        out.side = OrderSide::BUY;
+    } else if (fields.side.text == "sell") {
+        out.side = OrderSide::SELL;
+    } else {
+        return false;
+    }
+
+    auto symbol_id = resolve_symbol(fields.symbol.text);
+    if (!symbol_id) {
+        return false;
+    }
+    out.symbol_id = *symbol_id;
+    out.type = OrderType::LIMIT;
+
+    // Optional fields; a present one must still be well formed
+    out.account_id = 0;
+    out.self_trade_prevention = SelfTradePrevention::NONE;
+    if (fields.account.present && (!is_number(fields.account) || !parse_number(fields.account.text, out.account_id))) {
+        return false;
+    }
+    if (fields.stp.present &&
+        (!is_plain_string(fields.stp) || !parse_self_trade_prevention(fields.stp.text, out.self_trade_prevention))) {
+        return false;
+    }
+    return parse_number(fields.price.text, out.price) && parse_number(fields.quantity.text, out.quantity);
+}
+
+} // namespace
+
+bool parse_self_trade_prevention(std::string_view text, SelfTradePrevention& out) {
+    if (text == "none") {
+        out = SelfTradePrevention::NONE;
+    } else if (text == "cancel_resting") {
+        out = SelfTradePrevention::CANCEL_RESTING;
+    } else if (text == "cancel_aggressor") {
+        out = SelfTradePrevention::CANCEL_AGGRESSOR;
+    } else if (text == "cancel_both") {
+        out = SelfTradePrevention::CANCEL_BOTH;
+    } else if (text == "decrement") {
+        out = SelfTradePrevention::DECREMENT;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool OrderMessageParser::parse(std::string_view payload, ParsedOrder& out) {
+    OrderFields fields;
+    if (!scan_object(payload, fields)) {
+        return false;
+    }
+
+    // The subscribe echo wraps the order object in an escaped string
+    if (is_plain_string(fields.type) && fields.type.text == "subscribe") {
+        if (!fields.symbol.present || fields.symbol.kind != TokenKind::STRING) {
+            return false;
+        }
+        char buffer[kMaxNestedPayload];
+        size_t length = 0;
+        if (!unescape(fields.symbol.text, buffer, sizeof(buffer), length)) {
+            return false;
+        }
+        OrderFields nested;
+        return scan_object(std::string_view(buffer, length), nested) && decode_order(nested, out);
+    }
+    return decode_order(fields, out);
+}
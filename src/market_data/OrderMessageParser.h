@@ -0,0 +1,36 @@
+#pragma once
+
+#include "common/SymbolTable.h"
+#include "order_book/Order.h"
+#include <cstdint>
+#include <string_view>
+
+// Order fields decoded straight out of a message payload
+struct ParsedOrder {
+    SymbolId symbol_id;
+    OrderType type;
+    OrderSide side;
+    double price;
+    uint64_t quantity;
+    AccountId account_id;
+    SelfTradePrevention self_trade_prevention;
+};
+
+// Maps an `stp` value ("none", "cancel_resting", "cancel_aggressor",
+// "cancel_both" or "decrement") to its mode; false for anything else
+bool parse_self_trade_prevention(std::string_view text, SelfTradePrevention& out);
+
+/**
+ * @brief Allocation-free parser for the order message schema.
+ *
+ * Accepts a flat JSON object with `type` "limit", `symbol`, `side`, `price` and
+ * `quantity` in any key order, plus an optional numeric `account` (default 0)
+ * and `stp` mode (default "none"), as well as the subscribe echo that carries such
+ * an object as an escaped string in its `symbol` field. The payload is scanned
+ * in place without building a DOM. Anything else, including symbols that are
+ * not interned yet, returns false so the caller can fall back to nlohmann::json.
+ */
+class OrderMessageParser {
+public:
+    static bool parse(std::string_view payload, ParsedOrder& out);
+};
@@ -1,7 +1,9 @@
 #include "WebSocketClient.h"
+#include "common/Logger.h"
 #include <iostream>
 
-WebSocketClient::WebSocketClient() : is_connected_(false) {
+WebSocketClient::WebSocketClient(const WebSocketClientConfig& config)
+    : config_(config), message_queue_(config.queue_capacity), is_connected_(false) {
     // We can set logging behavior here if needed
     client_.clear_access_channels(websocketpp::log::alevel::all);
     client_.set_access_channels(websocketpp::log::alevel::connect | websocketpp::log::alevel::disconnect);
@@ -74,20 +76,41 @@ void WebSocketClient::subscribe(const std::string& symbol) {
     }
 }
 
-bool WebSocketClient::get_message(json& msg) {
-    std::unique_lock<std::mutex> lock(queue_mutex_);
-    // Wait until the queue is not empty or the connection is lost
-    cv_.wait(lock, [this] { return !message_queue_.empty() || !is_connected_; });
-
-    if (!is_connected_ && message_queue_.empty()) {
-        return false; // No more messages and disconnected
+bool WebSocketClient::send_binary(const void* data, size_t size) {
+    if (!is_connected_) {
+        std::cerr << "Not connected. Cannot send binary message." << std::endl;
+        return false;
     }
 
-    msg = message_queue_.front();
-    message_queue_.pop();
+    websocketpp::lib::error_code ec;
+    client_.send(connection_hdl_, data, size, websocketpp::frame::opcode::binary, ec);
+    if (ec) {
+        std::cerr << "Error sending binary message: " << ec.message() << std::endl;
+        return false;
+    }
     return true;
 }
 
+bool WebSocketClient::get_message(InboundMessage& msg) {
+    return get_messages(&msg, 1) == 1;
+}
+
+size_t WebSocketClient::get_messages(InboundMessage* out, size_t max_messages) {
+    Backoff backoff(config_.wait_strategy);
+    for (;;) {
+        const size_t count = message_queue_.try_pop_batch(out, max_messages);
+        if (count > 0) {
+            return count;
+        }
+        // Re-check the queue after seeing the disconnect so nothing pushed
+        // just before on_close is lost
+        if (!is_connected_.load(std::memory_order_acquire)) {
+            return message_queue_.try_pop_batch(out, max_messages);
+        }
+        backoff.idle();
+    }
+}
+
 void WebSocketClient::on_open(websocketpp::connection_hdl hdl) {
     std::cout << "WebSocket connection opened." << std::endl;
     connection_hdl_ = hdl;
@@ -97,25 +120,36 @@ void WebSocketClient::on_open(websocketpp::connection_hdl hdl) {
 void WebSocketClient::on_fail(websocketpp::connection_hdl hdl) {
     std::cerr << "WebSocket connection failed." << std::endl;
     is_connected_ = false;
-    cv_.notify_all(); // Wake up any waiting threads
 }
 
 void WebSocketClient::on_message(websocketpp::connection_hdl hdl, MessagePtr msg) {
-    try {
-        json parsed_msg = json::parse(msg->get_payload());
-        
-        { // Lock scope
-            std::lock_guard<std::mutex> lock(queue_mutex_);
-            message_queue_.push(parsed_msg);
+    const std::string& payload = msg->get_payload();
+    InboundMessage inbound;
+    // Binary frames are fixed-layout structs and skip text parsing entirely
+    if (msg->get_opcode() == websocketpp::frame::opcode::binary) {
+        if (!wire::decode(payload.data(), payload.size(), inbound.binary)) {
+            LOG_WARN("[WEBSOCKET] Malformed binary frame of %zu bytes", payload.size());
+            return;
         }
-        cv_.notify_one(); // Notify one waiting thread that a message is ready
+        inbound.kind = InboundKind::BINARY;
+        message_queue_.push(std::move(inbound), config_.overflow_policy);
+        return;
+    }
+    // Order messages take the allocation-free path; the DOM parser only sees the rest
+    if (OrderMessageParser::parse(payload, inbound.order)) {
+        inbound.kind = InboundKind::ORDER;
+        message_queue_.push(std::move(inbound), config_.overflow_policy);
+        return;
+    }
+    try {
+        inbound.document = json::parse(payload);
+        message_queue_.push(std::move(inbound), config_.overflow_policy);
     } catch (const json::parse_error& e) {
-        std::cerr << "JSON parse error: " << e.what() << std::endl;
+        LOG_WARN("[WEBSOCKET] JSON parse error: %s", e.what());
     }
 }
 
 void WebSocketClient::on_close(websocketpp::connection_hdl hdl) {
     std::cout << "WebSocket connection closed." << std::endl;
     is_connected_ = false;
-    cv_.notify_all(); // Wake up any waiting threads
 }
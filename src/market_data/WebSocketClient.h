@@ -1,14 +1,15 @@
 #pragma once
 
+#include "common/SpscQueue.h"
+#include "BinaryProtocol.h"
+#include "OrderMessageParser.h"
 #include <websocketpp/config/asio_no_tls.hpp>
 #include <websocketpp/client.hpp>
 #include <nlohmann/json.hpp>
 
+#include <atomic>
 #include <string>
 #include <thread>
-#include <mutex>
-#include <condition_variable>
-#include <queue>
 #include <functional>
 
 // Define types for convenience
@@ -16,9 +17,33 @@ using Client = websocketpp::client<websocketpp::config::asio>;
 using MessagePtr = websocketpp::config::asio::message_type::ptr;
 using json = nlohmann::json;
 
+enum class InboundKind : uint8_t {
+    DOCUMENT, // Text frame outside the order schema
+    ORDER,    // Text frame decoded by OrderMessageParser
+    BINARY    // Binary protocol frame
+};
+
+// One message from the feed. Binary frames and orders matching the known JSON
+// schema arrive already decoded; anything else is carried as a JSON document.
+struct InboundMessage {
+    InboundKind kind = InboundKind::DOCUMENT;
+    ParsedOrder order{};
+    wire::Message binary{};
+    json document;
+};
+
+struct WebSocketClientConfig {
+    // Decoded messages buffered between the network thread and the consumer
+    size_t queue_capacity = 1 << 16;
+    // What on_message does when the consumer falls behind
+    OverflowPolicy overflow_policy = OverflowPolicy::DROP_NEWEST;
+    // How get_message/get_messages wait for data
+    WaitStrategy wait_strategy = WaitStrategy::BACKOFF;
+};
+
 class WebSocketClient {
 public:
-    WebSocketClient();
+    explicit WebSocketClient(const WebSocketClientConfig& config = WebSocketClientConfig());
     ~WebSocketClient();
 
     // Connect to the WebSocket server
@@ -29,9 +54,22 @@ public:
 
     // Subscribe to a symbol/channel
     void subscribe(const std::string& symbol);
+
+    // Send one binary protocol message in its own binary frame
+    template <typename Msg>
+    bool send_binary(const Msg& msg) { return send_binary(&msg, sizeof(msg)); }
+    bool send_binary(const void* data, size_t size);
     
-    // Thread-safe method to retrieve a message from the queue
-    bool get_message(json& msg);
+    // Retrieve one message, waiting per the wait strategy. Must be called from
+    // a single consumer thread. Returns false once disconnected and drained.
+    bool get_message(InboundMessage& msg);
+
+    // Retrieve up to max_messages in one go, waiting until at least one is
+    // available. Returns 0 once disconnected and drained.
+    size_t get_messages(InboundMessage* out, size_t max_messages);
+
+    // Messages dropped (or stalled on, with OverflowPolicy::SPIN) because the queue was full
+    uint64_t overflow_count() const { return message_queue_.overflow_count(); }
 
 private:
     void on_open(websocketpp::connection_hdl hdl);
@@ -39,12 +77,12 @@ private:
     void on_message(websocketpp::connection_hdl hdl, MessagePtr msg);
     void on_close(websocketpp::connection_hdl hdl);
 
+    WebSocketClientConfig config_;
     Client client_;
     websocketpp::connection_hdl connection_hdl_;
     std::thread client_thread_;
 
-    std::queue<json> message_queue_;
-    std::mutex queue_mutex_;
-    std::condition_variable cv_;
-    bool is_connected_;
+    // Single producer (the ASIO thread) and single consumer (the handler thread)
+    SpscQueue<InboundMessage> message_queue_;
+    std::atomic<bool> is_connected_;
 };
@@ -0,0 +1,637 @@
+#include "BookManager.h"
+#include "common/Logger.h"
+#include <algorithm>
+#include <filesystem>
+#include <optional>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+void pin_to_core(std::thread& thread, size_t core) {
+#ifdef __linux__
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(core % cores, &cpuset);
+    if (pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cpuset) != 0) {
+        LOG_WARN("[BOOK MANAGER] Could not pin shard thread to core %zu", core);
+    }
+#else
+    (void)thread;
+    (void)core;
+#endif
+}
+
+} // namespace
+
+BookManager::BookManager(const BookManagerConfig& config)
+    : config_(config), next_shard_(0), running_(false) {
+    const size_t num_shards = std::max<size_t>(config.num_shards, 1);
+    for (size_t i = 0; i < num_shards; ++i) {
+        shards_.push_back(std::make_unique<Shard>(config));
+    }
+}
+
+BookManager::~BookManager() {
+    stop();
+}
+
+SymbolId BookManager::add_symbol(const std::string& name, OrderBookConfig book_config) {
+    const SymbolId symbol_id = SymbolTable::instance().intern(name);
+    if (symbol_id >= books_.size()) {
+        books_.resize(symbol_id + 1);
+        shard_of_.resize(symbol_id + 1, shards_.size());
+    }
+    if (!books_[symbol_id]) {
+        book_config.synchronized = config_.lock_books;
+        books_[symbol_id] = std::make_unique<OrderBook>(book_config);
+        books_[symbol_id]->on_trade([this, symbol_id](const Trade& trade) { handle_trade(symbol_id, trade); });
+        books_[symbol_id]->on_self_trade_cancel(
+            [this, symbol_id](const SelfTradeCancel& cancel) { handle_self_trade_cancel(symbol_id, cancel); });
+        books_[symbol_id]->on_top_of_book([this, symbol_id](const TopOfBook& top) { handle_quote(symbol_id, top); });
+        if (config_.book_feed != BookFeedDepth::NONE) {
+            books_[symbol_id]->on_book_update(
+                [this, symbol_id](const BookUpdate& update) { handle_book_update(symbol_id, update); },
+                config_.book_feed == BookFeedDepth::ORDERS);
+        }
+        shard_of_[symbol_id] = next_shard_;
+        shards_[next_shard_]->books.push_back(books_[symbol_id].get());
+        shards_[next_shard_]->symbols.push_back(symbol_id);
+        shards_[next_shard_]->book_sequences.resize(books_.size());
+        next_shard_ = (next_shard_ + 1) % shards_.size();
+    }
+    return symbol_id;
+}
+
+void BookManager::on_trade(const OrderBook::TradeCallback& callback) {
+    trade_callback_ = callback;
+}
+
+ExecutionSubscription BookManager::subscribe_executions() {
+    return subscribe(&Shard::executions);
+}
+
+QuoteSubscription BookManager::subscribe_quotes() {
+    return subscribe(&Shard::quotes);
+}
+
+BookUpdateSubscription BookManager::subscribe_book_updates() {
+    return subscribe(&Shard::book_updates);
+}
+
+template <typename T>
+FeedSubscription<T> BookManager::subscribe(BroadcastRing<T> Shard::*ring) {
+    FeedSubscription<T> subscription;
+    for (auto& shard : shards_) {
+        const size_t id = ((*shard).*ring).subscribe();
+        if (id == BroadcastRing<T>::kNoSubscriber) {
+            return FeedSubscription<T>();
+        }
+        subscription.rings_.push_back(
+            typename FeedSubscription<T>::Cursor{&((*shard).*ring), id, ((*shard).*ring).position(id)});
+    }
+    return subscription;
+}
+
+RecoveryStats BookManager::recover(const RecoveredTradeCallback& on_trade, const SnapshotRestore& on_snapshot) {
+    RecoveryStats stats;
+    if (config_.journal_dir.empty() || running_) {
+        return stats;
+    }
+    open_journals();
+
+    // A snapshot only helps if every shard still has the segment it starts at
+    Snapshot snapshot;
+    std::string error;
+    bool from_snapshot = std::filesystem::exists(snapshot_path());
+    if (from_snapshot && !read_snapshot(snapshot_path(), snapshot, error)) {
+        LOG_WARN("[BOOK MANAGER] Ignoring snapshot, replaying full journals: %s", error.c_str());
+        from_snapshot = false;
+    }
+    if (from_snapshot) {
+        bool covered = snapshot.journal_segments.size() == shards_.size();
+        for (size_t i = 0; covered && i < shards_.size(); ++i) {
+            const std::vector<uint64_t> segments = journal_segments(i);
+            covered = std::binary_search(segments.begin(), segments.end(), snapshot.journal_segments[i]);
+        }
+        if (!covered) {
+            LOG_WARN("[BOOK MANAGER] Snapshot does not match the journals, replaying them in full");
+            from_snapshot = false;
+        }
+    }
+    if (from_snapshot) {
+        for (Snapshot::Book& saved : snapshot.books) {
+            const std::optional<SymbolId> symbol_id = SymbolTable::instance().find(saved.symbol);
+            OrderBook* target = symbol_id ? book(*symbol_id) : nullptr;
+            if (!target) {
+                continue;
+            }
+            for (Order& order : saved.state.orders) {
+                order.symbol_id = *symbol_id;
+            }
+            if (!target->restore(saved.state)) {
+                LOG_ERROR("[BOOK MANAGER] Could not restore %s from the snapshot", saved.symbol.c_str());
+            }
+        }
+        stats.max_order_id = snapshot.max_order_id;
+        if (on_snapshot) {
+            on_snapshot(snapshot);
+        }
+    }
+
+    // Trades regenerated by re-matching are already in the journal
+    recovering_ = true;
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        Shard& shard = *shards_[i];
+        // Segments before the snapshot's are already reflected in it
+        const uint64_t first = from_snapshot ? snapshot.journal_segments[i] : 0;
+        for (uint64_t segment : journal_segments(i)) {
+            if (segment < first) {
+                continue;
+            }
+            if (segment == shard.journal_segment) {
+                replay_journal(shard.journal, on_trade, stats);
+                continue;
+            }
+            Journal earlier(config_.journal_config);
+            if (!earlier.open(journal_path(i, segment), error)) {
+                LOG_ERROR("[BOOK MANAGER] Could not replay segment %llu of shard %zu: %s",
+                          static_cast<unsigned long long>(segment), i, error.c_str());
+                continue;
+            }
+            replay_journal(earlier, on_trade, stats);
+        }
+    }
+    recovering_ = false;
+    for (auto& shard : shards_) {
+        shard->max_order_id = stats.max_order_id;
+    }
+    return stats;
+}
+
+void BookManager::replay_journal(const Journal& journal, const RecoveredTradeCallback& on_trade,
+                                 RecoveryStats& stats) {
+    // Journal symbol ids are mapped back to today's ids by name; every
+    // segment names its symbols first
+    std::vector<std::optional<SymbolId>> symbols;
+    journal.for_each([&](const JournalRecord& record) {
+        if (record.type == JournalRecordType::SYMBOL) {
+            if (record.symbol_id >= symbols.size()) {
+                symbols.resize(record.symbol_id + 1);
+            }
+            symbols[record.symbol_id] = SymbolTable::instance().find(record.body.symbol_name);
+            return;
+        }
+        if (record.symbol_id >= symbols.size() || !symbols[record.symbol_id]) {
+            return;
+        }
+        const SymbolId symbol_id = *symbols[record.symbol_id];
+        OrderBook* target = book(symbol_id);
+        if (!target) {
+            return;
+        }
+        switch (record.type) {
+            case JournalRecordType::ORDER: {
+                Order order(record.body.order.order_id, symbol_id, static_cast<OrderType>(record.order_type),
+                            static_cast<OrderSide>(record.side), record.body.order.price, record.body.order.quantity);
+                order.time_in_force = static_cast<TimeInForce>(record.time_in_force);
+                order.account_id = record.body.order.account_id;
+                order.self_trade_prevention = static_cast<SelfTradePrevention>(record.body.order.self_trade_prevention);
+                target->add_order(order);
+                stats.max_order_id = std::max(stats.max_order_id, record.body.order.order_id);
+                break;
+            }
+            case JournalRecordType::CANCEL:
+                target->cancel_order(record.body.order.order_id);
+                break;
+            case JournalRecordType::MODIFY:
+                target->modify_order(record.body.order.order_id, record.body.order.price, record.body.order.quantity);
+                break;
+            case JournalRecordType::TRADE:
+                if (on_trade) {
+                    const auto& t = record.body.trade;
+                    Trade trade(t.trade_id, t.resting_order_id, t.aggressive_order_id, t.price, t.quantity);
+                    trade.symbol_id = symbol_id;
+                    trade.aggressor_side = static_cast<OrderSide>(record.side);
+                    trade.resting_account = t.resting_account;
+                    trade.aggressive_account = t.aggressive_account;
+                    on_trade(trade);
+                }
+                break;
+            case JournalRecordType::SYMBOL:
+                break;
+        }
+        ++stats.records;
+    });
+}
+
+bool BookManager::save_snapshot(const SnapshotCapture& capture, std::string& error) {
+    if (config_.journal_dir.empty()) {
+        error = "snapshots need a journal directory";
+        return false;
+    }
+    std::lock_guard<std::mutex> snapshot_lock(snapshot_mutex_);
+    Snapshot snapshot;
+    {
+        std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+        open_journals();
+        for (const auto& shard : shards_) {
+            if (!shard->journal.is_open()) {
+                error = "a shard journal is not open";
+                return false;
+            }
+        }
+        const bool running = running_.load(std::memory_order_acquire);
+        if (running) {
+            pause_shards();
+        }
+        // Everything journaled so far is in the snapshot; the rest goes to
+        // the new segments
+        bool rolled = true;
+        for (size_t i = 0; rolled && i < shards_.size(); ++i) {
+            rolled = roll_journal(i, error);
+            snapshot.journal_segments.push_back(shards_[i]->journal_segment);
+            snapshot.max_order_id = std::max(snapshot.max_order_id, shards_[i]->max_order_id);
+        }
+        if (rolled) {
+            for (SymbolId id = 0; id < books_.size(); ++id) {
+                if (books_[id]) {
+                    snapshot.books.push_back(Snapshot::Book{SymbolTable::instance().name(id), books_[id]->snapshot()});
+                }
+            }
+            if (capture) {
+                capture(snapshot);
+            }
+        }
+        if (running) {
+            resume_shards();
+        }
+        if (!rolled) {
+            return false;
+        }
+    }
+    if (!write_snapshot(snapshot_path(), snapshot, error)) {
+        return false;
+    }
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        for (uint64_t segment : journal_segments(i)) {
+            if (segment < snapshot.journal_segments[i]) {
+                std::error_code ec;
+                std::filesystem::remove(journal_path(i, segment), ec);
+            }
+        }
+    }
+    return true;
+}
+
+void BookManager::pause_shards() {
+    pause_requested_.store(true, std::memory_order_release);
+    while (paused_shards_.load(std::memory_order_acquire) < shards_.size()) {
+        std::this_thread::yield();
+    }
+}
+
+void BookManager::resume_shards() {
+    pause_requested_.store(false, std::memory_order_release);
+    // Wait for every shard to leave, so the next pause cannot count a stale one
+    while (paused_shards_.load(std::memory_order_acquire) > 0) {
+        std::this_thread::yield();
+    }
+}
+
+void BookManager::start() {
+    std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+    if (running_.exchange(true)) {
+        return;
+    }
+    if (!config_.journal_dir.empty()) {
+        open_journals();
+        // Name every symbol up front so the journal can be replayed against a
+        // process that registers symbols in a different order
+        for (SymbolId id = 0; id < books_.size(); ++id) {
+            if (books_[id]) {
+                shards_[shard_of_[id]]->journal.append_symbol(id, SymbolTable::instance().name(id));
+            }
+        }
+    }
+    // Quote and book update subscribers start from the books as they are,
+    // recovered or empty; the shard threads are not running yet, so this
+    // thread can publish. Each shard flushes the reported levels on start-up.
+    for (SymbolId id = 0; id < books_.size(); ++id) {
+        if (books_[id]) {
+            handle_quote(id, books_[id]->top_of_book());
+            books_[id]->report_book_state();
+        }
+    }
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        shards_[i]->thread = std::thread(&BookManager::run_shard, this, i);
+        if (config_.pin_threads) {
+            pin_to_core(shards_[i]->thread, config_.first_core + i);
+        }
+    }
+}
+
+void BookManager::stop() {
+    std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+    if (!running_.exchange(false)) {
+        return;
+    }
+    for (auto& shard : shards_) {
+        if (shard->thread.joinable()) {
+            shard->thread.join();
+        }
+        shard->journal.close();
+    }
+}
+
+bool BookManager::submit(const OrderCommand& command) {
+    if (command.symbol_id >= books_.size() || !books_[command.symbol_id]) {
+        return false;
+    }
+    return shards_[shard_of_[command.symbol_id]]->queue.try_push(command);
+}
+
+OrderBook* BookManager::book(SymbolId symbol_id) {
+    return symbol_id < books_.size() ? books_[symbol_id].get() : nullptr;
+}
+
+void BookManager::request_book_state() {
+    if (config_.book_feed == BookFeedDepth::NONE) {
+        return;
+    }
+    for (const auto& shard : shards_) {
+        shard->state_requested.store(true, std::memory_order_release);
+    }
+}
+
+uint64_t BookManager::processed() const {
+    uint64_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard->processed.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t BookManager::rejected() const {
+    uint64_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard->rejected.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t BookManager::execution_overflows() const {
+    uint64_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard->executions.overflow_count();
+    }
+    return total;
+}
+
+uint64_t BookManager::quote_overflows() const {
+    uint64_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard->quotes.overflow_count();
+    }
+    return total;
+}
+
+uint64_t BookManager::book_update_overflows() const {
+    uint64_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard->book_updates.overflow_count();
+    }
+    return total;
+}
+
+void BookManager::run_shard(size_t shard_index) {
+    Shard& shard = *shards_[shard_index];
+    OrderCommand command;
+    Backoff backoff(config_.wait_strategy);
+    // Commands applied since the depth snapshots were last published
+    size_t unpublished = 0;
+    // Readers see recovered books before the first command arrives
+    end_batch(shard);
+
+    for (;;) {
+        if (pause_requested_.load(std::memory_order_acquire)) {
+            // Park between commands while a snapshot copies the books
+            paused_shards_.fetch_add(1, std::memory_order_acq_rel);
+            while (pause_requested_.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            paused_shards_.fetch_sub(1, std::memory_order_acq_rel);
+        }
+        if (shard.queue.try_pop(command)) {
+            backoff.reset();
+            // Single writer per counter, so a plain store avoids a locked RMW
+            if (!apply(shard, command)) {
+                shard.rejected.store(shard.rejected.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            }
+            shard.processed.store(shard.processed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            if (++unpublished >= config_.depth_publish_interval) {
+                end_batch(shard);
+                unpublished = 0;
+            }
+            continue;
+        }
+        if (unpublished > 0 || shard.state_requested.load(std::memory_order_relaxed)) {
+            end_batch(shard);
+            unpublished = 0;
+        }
+        // Only exit once the queue has been drained after stop()
+        if (!running_.load(std::memory_order_acquire)) {
+            if (shard.queue.empty()) {
+                return;
+            }
+            continue;
+        }
+        backoff.idle();
+    }
+}
+
+bool BookManager::apply(Shard& shard, const OrderCommand& command) {
+    OrderBook& book = *books_[command.symbol_id];
+    bool accepted = false;
+    // Journal the command before applying it so replay sees the same sequence,
+    // rejected commands included
+    switch (command.type) {
+        case CommandType::NEW_ORDER: {
+            const Order order = command.to_order();
+            shard.journal.append_order(order);
+            shard.max_order_id = std::max(shard.max_order_id, order.id);
+            accepted = book.add_order(order);
+            break;
+        }
+        case CommandType::CANCEL:
+            shard.journal.append_cancel(command.symbol_id, command.order_id);
+            accepted = book.cancel_order(command.order_id);
+            break;
+        case CommandType::MODIFY:
+            shard.journal.append_modify(command.symbol_id, command.order_id, command.price, command.quantity);
+            accepted = book.modify_order(command.order_id, command.price, command.quantity);
+            break;
+    }
+    if (config_.report_order_status) {
+        ExecutionReport report;
+        report.type = ExecutionType::ORDER_STATUS;
+        report.status.command = command;
+        report.status.accepted = accepted;
+        // A refused new order may share its id with one already resting
+        report.status.remaining_quantity = accepted ? book.remaining_quantity(command.order_id) : 0;
+        shard.executions.publish(report, config_.execution_overflow);
+    }
+    return accepted;
+}
+
+// Books nothing has changed since their last snapshot return at once
+void BookManager::end_batch(Shard& shard) {
+    for (OrderBook* book : shard.books) {
+        book->publish_depth_snapshot();
+    }
+    publish_pending_levels(shard);
+    // After the batch's levels, so each reset is followed only by newer changes
+    if (shard.state_requested.load(std::memory_order_relaxed) &&
+        shard.state_requested.exchange(false, std::memory_order_acquire)) {
+        publish_book_state(shard);
+    }
+}
+
+void BookManager::handle_trade(SymbolId symbol_id, const Trade& trade) {
+    if (recovering_) {
+        return;
+    }
+    Shard& shard = *shards_[shard_of_[symbol_id]];
+    shard.journal.append_trade(trade);
+    shard.executions.publish(ExecutionReport{ExecutionType::TRADE, trade, {}, {}}, config_.execution_overflow);
+    if (trade_callback_) {
+        trade_callback_(trade);
+    }
+}
+
+// Not journaled: replaying the order, which carries its mode, cuts the same quantity
+void BookManager::handle_self_trade_cancel(SymbolId symbol_id, const SelfTradeCancel& cancel) {
+    if (recovering_) {
+        return;
+    }
+    Shard& shard = *shards_[shard_of_[symbol_id]];
+    shard.executions.publish(ExecutionReport{ExecutionType::SELF_TRADE_CANCEL, Trade(), cancel, {}},
+                             config_.execution_overflow);
+}
+
+void BookManager::handle_quote(SymbolId symbol_id, const TopOfBook& top) {
+    if (recovering_) {
+        return;
+    }
+    const double tick_size = books_[symbol_id]->tick_size();
+    QuoteUpdate quote;
+    quote.symbol_id = symbol_id;
+    quote.best_bid = to_price(top.best_bid, tick_size);
+    quote.best_ask = to_price(top.best_ask, tick_size);
+    quote.has_bid = top.has_bid;
+    quote.has_ask = top.has_ask;
+    shards_[shard_of_[symbol_id]]->quotes.publish(quote, config_.market_data_overflow);
+}
+
+void BookManager::handle_book_update(SymbolId symbol_id, const BookUpdate& update) {
+    if (recovering_) {
+        return;
+    }
+    Shard& shard = *shards_[shard_of_[symbol_id]];
+    if (update.type != BookUpdateType::LEVEL) {
+        // Levels changed before this order event go out ahead of it. The whole
+        // batch is flushed: other books' sequences are independent of this one.
+        publish_pending_levels(shard);
+        publish_book_update(shard, update);
+        return;
+    }
+    shard.pending_levels.record(update);
+}
+
+// A dropped update still takes its number, leaving the gap subscribers look for
+void BookManager::publish_book_update(Shard& shard, BookUpdate update) {
+    update.sequence = ++shard.book_sequences[update.symbol_id];
+    shard.book_updates.publish(update, config_.market_data_overflow);
+}
+
+void BookManager::publish_pending_levels(Shard& shard) {
+    for (const BookUpdate& update : shard.pending_levels.updates()) {
+        publish_book_update(shard, update);
+    }
+    shard.pending_levels.clear();
+}
+
+// Published directly: the state is complete as reported, with nothing to coalesce
+void BookManager::publish_book_state(Shard& shard) {
+    const auto publish = [this, &shard](const BookUpdate& update) { publish_book_update(shard, update); };
+    for (size_t i = 0; i < shard.books.size(); ++i) {
+        BookUpdate reset;
+        reset.type = BookUpdateType::BOOK_RESET;
+        reset.symbol_id = shard.symbols[i];
+        publish(reset);
+        shard.books[i]->report_book_state(publish);
+    }
+}
+
+void BookManager::open_journals() {
+    std::error_code ec;
+    std::filesystem::create_directories(config_.journal_dir, ec);
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        if (shards_[i]->journal.is_open()) {
+            continue;
+        }
+        // Keep appending to the newest segment
+        const std::vector<uint64_t> segments = journal_segments(i);
+        shards_[i]->journal_segment = segments.empty() ? 0 : segments.back();
+        std::string error;
+        if (!shards_[i]->journal.open(journal_path(i, shards_[i]->journal_segment), error)) {
+            LOG_ERROR("[BOOK MANAGER] Journaling disabled for shard %zu: %s", i, error.c_str());
+        }
+    }
+}
+
+std::string BookManager::journal_path(size_t shard_index, uint64_t segment) const {
+    return config_.journal_dir + "/shard-" + std::to_string(shard_index) + "-" + std::to_string(segment) + ".journal";
+}
+
+std::vector<uint64_t> BookManager::journal_segments(size_t shard_index) const {
+    const std::string prefix = "shard-" + std::to_string(shard_index) + "-";
+    const std::string suffix = ".journal";
+    std::vector<uint64_t> segments;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(config_.journal_dir, ec)) {
+        const std::string name = entry.path().filename().string();
+        if (name.size() <= prefix.size() + suffix.size() || name.compare(0, prefix.size(), prefix) != 0 ||
+            name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+            continue;
+        }
+        const std::string number = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+        if (std::all_of(number.begin(), number.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+            segments.push_back(std::stoull(number));
+        }
+    }
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
+
+bool BookManager::roll_journal(size_t shard_index, std::string& error) {
+    Shard& shard = *shards_[shard_index];
+    shard.journal.close();
+    if (!shard.journal.open(journal_path(shard_index, shard.journal_segment + 1), error)) {
+        // Carry on in the old segment; the snapshot is abandoned
+        std::string reopen_error;
+        if (!shard.journal.open(journal_path(shard_index, shard.journal_segment), reopen_error)) {
+            LOG_ERROR("[BOOK MANAGER] Journaling disabled for shard %zu: %s", shard_index, reopen_error.c_str());
+        }
+        return false;
+    }
+    ++shard.journal_segment;
+    // Each segment replays on its own, so it names its symbols again
+    for (SymbolId id : shard.symbols) {
+        shard.journal.append_symbol(id, SymbolTable::instance().name(id));
+    }
+    return true;
+}
@@ -0,0 +1,339 @@
+#pragma once
+
+#include "BookUpdate.h"
+#include "ExecutionReport.h"
+#include "LevelUpdateBatch.h"
+#include "OrderBook.h"
+#include "OrderCommand.h"
+#include "QuoteUpdate.h"
+#include "common/BroadcastRing.h"
+#include "common/SpscQueue.h"
+#include "persistence/Journal.h"
+#include "persistence/Snapshot.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// How much of each book's changes subscribe_book_updates() carries
+enum class BookFeedDepth : uint8_t {
+    NONE,   // No book updates are produced
+    LEVELS, // LEVEL updates (L2), coalesced per batch of commands
+    // LEVEL updates plus every ORDER_* update (L3). Pending LEVEL updates are
+    // published before each ORDER_* update, so a level's change never arrives
+    // after a later order event of its book; coalescing then only merges the
+    // changes between two order events.
+    ORDERS
+};
+
+struct BookManagerConfig {
+    // Number of matching threads; symbols are dealt to them round-robin
+    size_t num_shards = 1;
+    // Commands each shard can have in flight before submit() starts failing
+    size_t queue_capacity = 1 << 16;
+    // Pin shard i to core (first_core + i) where the platform supports it
+    bool pin_threads = true;
+    size_t first_core = 0;
+    // How an idle shard waits for commands
+    WaitStrategy wait_strategy = WaitStrategy::BACKOFF;
+    // Keep per-book locking for callers that read books from other threads
+    // through get_depth(); otherwise books run lock-free. Readers of
+    // depth_snapshot() need no lock.
+    bool lock_books = false;
+    // Commands a busy shard applies between depth snapshot publications; a
+    // shard also publishes whenever its queue runs dry
+    size_t depth_publish_interval = 64;
+    // Directory for one journal per shard recording every command and trade,
+    // kept as numbered segments; empty disables journaling
+    std::string journal_dir;
+    JournalConfig journal_config;
+    // Execution reports each shard can hold ahead of its slowest subscriber
+    size_t execution_ring_capacity = 1 << 16;
+    size_t max_execution_subscribers = 8;
+    // What a shard does when a subscriber falls a whole ring behind
+    OverflowPolicy execution_overflow = OverflowPolicy::SPIN;
+    // Also publish an ORDER_STATUS execution report after every command, so
+    // subscribers learn what rests, what was refused and what expired
+    bool report_order_status = false;
+    // Best bid/ask changes each shard can hold ahead of its slowest quote
+    // subscriber; quote rings share the subscriber limit
+    size_t quote_ring_capacity = 1 << 14;
+    // Book updates produced for subscribe_book_updates(), and how many each
+    // shard can hold ahead of its slowest subscriber
+    BookFeedDepth book_feed = BookFeedDepth::NONE;
+    size_t book_update_ring_capacity = 1 << 16;
+    // What a shard does when a quote or book update subscriber falls a whole
+    // ring behind. Dropping keeps a stalled market data consumer from holding
+    // up matching: a quote carries the whole best bid/ask, so the next one
+    // replaces a lost one, and lost book updates show as a jump in the book's
+    // update sequence.
+    OverflowPolicy market_data_overflow = OverflowPolicy::DROP_NEWEST;
+};
+
+class BookManager;
+
+/**
+ * @brief One consumer's view of a feed published by every shard, such as
+ *        execution reports or quote updates.
+ *
+ * Each subscription has its own cursor into every shard's ring and is drained
+ * by a single thread with poll(). Items from one shard arrive in the order
+ * they were published; items from different shards are interleaved.
+ */
+template <typename T>
+class FeedSubscription {
+public:
+    FeedSubscription() = default;
+    FeedSubscription(FeedSubscription&& other) noexcept
+        : rings_(std::exchange(other.rings_, {})), next_ring_(other.next_ring_) {}
+    FeedSubscription& operator=(FeedSubscription&& other) noexcept {
+        if (this != &other) {
+            release();
+            rings_ = std::exchange(other.rings_, {});
+            next_ring_ = other.next_ring_;
+        }
+        return *this;
+    }
+    ~FeedSubscription() { release(); }
+
+    FeedSubscription(const FeedSubscription&) = delete;
+    FeedSubscription& operator=(const FeedSubscription&) = delete;
+
+    // Copy up to max_items pending items into `out`; returns how many
+    size_t poll(T* out, size_t max_items) {
+        size_t count = 0;
+        for (size_t i = 0; i < rings_.size() && count < max_items; ++i) {
+            const Cursor& cursor = rings_[(next_ring_ + i) % rings_.size()];
+            count += cursor.ring->poll(cursor.id, out + count, max_items - count);
+        }
+        if (!rings_.empty()) {
+            next_ring_ = (next_ring_ + 1) % rings_.size();
+        }
+        return count;
+    }
+
+    // Whether every item published so far has been polled
+    bool caught_up() const {
+        for (const Cursor& cursor : rings_) {
+            if (!cursor.ring->caught_up(cursor.id)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Items published to this subscription since it was made. Once the
+    // shards are paused, a consumer has applied everything when its own count
+    // of applied items reaches this; caught_up() only says what was polled.
+    uint64_t published() const {
+        uint64_t total = 0;
+        for (const Cursor& cursor : rings_) {
+            total += cursor.ring->published() - cursor.start;
+        }
+        return total;
+    }
+
+    bool valid() const { return !rings_.empty(); }
+
+private:
+    friend class BookManager;
+
+    struct Cursor {
+        BroadcastRing<T>* ring;
+        size_t id;
+        uint64_t start; // Ring position the subscription began at
+    };
+
+    void release() {
+        for (const Cursor& cursor : rings_) {
+            cursor.ring->unsubscribe(cursor.id);
+        }
+        rings_.clear();
+    }
+
+    std::vector<Cursor> rings_;
+    size_t next_ring_ = 0; // Where the next poll starts, so no shard starves the others
+};
+
+using ExecutionSubscription = FeedSubscription<ExecutionReport>;
+using QuoteSubscription = FeedSubscription<QuoteUpdate>;
+using BookUpdateSubscription = FeedSubscription<BookUpdate>;
+
+struct RecoveryStats {
+    uint64_t records = 0;      // Journal records applied
+    uint64_t max_order_id = 0; // Highest order id seen, for resuming id assignment
+};
+
+/**
+ * @brief Owns one OrderBook per symbol and shards them across matching threads.
+ *
+ * Each shard has its own thread and SPSC command queue, and is the only thread
+ * that ever touches its books, so books can run without a lock and symbols on
+ * different shards never contend. Symbols must be added before start().
+ * submit() routes by symbol id and must be called from a single producer thread.
+ *
+ * With a journal directory configured, each shard appends the commands it
+ * applies and the trades they produce to its own Journal, and recover() rebuilds
+ * the books by replaying those journals before start(). Each shard republishes
+ * the depth snapshots of the books it changed, and its coalesced level
+ * updates, after every batch of commands, so readers never contend with
+ * matching. save_snapshot()
+ * captures the books at a point every shard has paused at and starts a new
+ * journal segment there, so recovery can load it and replay only the segments
+ * that follow; older segments are deleted once the snapshot is written.
+ */
+class BookManager {
+public:
+    // Receives each journaled trade during recovery
+    using RecoveredTradeCallback = std::function<void(const Trade&)>;
+    // Adds state owned outside the manager (e.g. risk positions) to a snapshot
+    using SnapshotCapture = std::function<void(Snapshot&)>;
+    // Restores that state from the snapshot recovery starts from
+    using SnapshotRestore = std::function<void(const Snapshot&)>;
+
+    explicit BookManager(const BookManagerConfig& config = BookManagerConfig());
+    ~BookManager();
+
+    BookManager(const BookManager&) = delete;
+    BookManager& operator=(const BookManager&) = delete;
+
+    // Create the book for `name` and assign it to a shard. Returns its symbol id.
+    SymbolId add_symbol(const std::string& name, OrderBookConfig book_config = OrderBookConfig());
+
+    // Register the trade callback for every book; it runs synchronously on the
+    // owning shard's thread. Must be set before start(). Consumers that do real
+    // work should use subscribe_executions() instead.
+    void on_trade(const OrderBook::TradeCallback& callback);
+
+    // Start receiving every fill and self-trade prevention cut as an
+    // ExecutionReport, drained in batches on the caller's own thread. Returns
+    // an invalid subscription if the subscriber limit is reached.
+    ExecutionSubscription subscribe_executions();
+
+    // Start receiving a QuoteUpdate whenever a book's best bid or ask price
+    // changes. start() first publishes every book's current best prices, so a
+    // subscriber made before start() sees the recovered books too.
+    QuoteSubscription subscribe_quotes();
+
+    // Start receiving the books' changes at the configured book_feed depth.
+    // A level changed several times within one batch of commands is published
+    // once, with its aggregate after the batch, at the end of that batch or
+    // just before the next ORDER_* update, which is published as it happens. start() first reports
+    // every book's current levels (and orders) so subscribers made before
+    // start() can build the books from the feed alone.
+    BookUpdateSubscription subscribe_book_updates();
+
+    // Have every shard report its books again on the book update feed, each
+    // as a BOOK_RESET followed by its current levels (and orders), at the end
+    // of the shard's current batch, so a subscriber that joined late or lost
+    // updates can rebuild a book from its reset onwards. Callable from any
+    // thread; requests a shard has not yet served are served once.
+    void request_book_state();
+
+    // Rebuild the books from the latest snapshot, if there is one, and the
+    // journal segments from the one it starts. Call once, after every symbol has been added and
+    // before start(); the live trade callback is not invoked.
+    RecoveryStats recover(const RecoveredTradeCallback& on_trade, const SnapshotRestore& on_snapshot = nullptr);
+
+    // Write a snapshot of every book to the journal directory. The shards pause
+    // between commands only while the books are copied and each journal moves
+    // to a new segment, and `capture` runs during that pause; the file is
+    // written afterwards on the calling thread, and then the segments before
+    // the new ones are deleted.
+    bool save_snapshot(const SnapshotCapture& capture, std::string& error);
+
+    void start();
+
+    // Drain whatever is queued, then join the shard threads
+    void stop();
+
+    // Queue a command for the shard owning its symbol. Returns false for an
+    // unknown symbol or when that shard's queue is full.
+    bool submit(const OrderCommand& command);
+
+    OrderBook* book(SymbolId symbol_id);
+    size_t shard_of(SymbolId symbol_id) const { return shard_of_.at(symbol_id); }
+    size_t num_shards() const { return shards_.size(); }
+
+    // Commands applied so far, and those the book refused (killed FOK orders
+    // included), across all shards
+    uint64_t processed() const;
+    uint64_t rejected() const;
+    // Times a shard found its execution, quote or book update ring full
+    uint64_t execution_overflows() const;
+    uint64_t quote_overflows() const;
+    uint64_t book_update_overflows() const;
+
+private:
+    struct Shard {
+        explicit Shard(const BookManagerConfig& config)
+            : queue(config.queue_capacity),
+              journal(config.journal_config),
+              executions(config.execution_ring_capacity, config.max_execution_subscribers),
+              quotes(config.quote_ring_capacity, config.max_execution_subscribers),
+              book_updates(config.book_update_ring_capacity, config.max_execution_subscribers) {}
+
+        SpscQueue<OrderCommand> queue;
+        std::thread thread;
+        std::atomic<uint64_t> processed{0};
+        std::atomic<uint64_t> rejected{0};
+        Journal journal;
+        uint64_t journal_segment = 0; // Number of the segment `journal` appends to
+        BroadcastRing<ExecutionReport> executions;
+        BroadcastRing<QuoteUpdate> quotes;
+        BroadcastRing<BookUpdate> book_updates;
+        uint64_t max_order_id = 0;
+        std::vector<OrderBook*> books; // The books this shard matches
+        // Latest LEVEL update per level changed in the current batch
+        LevelUpdateBatch pending_levels;
+        // Last update sequence per book, indexed by SymbolId
+        std::vector<uint64_t> book_sequences;
+        std::vector<SymbolId> symbols; // Of `books`, in the same order
+        std::atomic<bool> state_requested{false};
+    };
+
+    void run_shard(size_t shard_index);
+    bool apply(Shard& shard, const OrderCommand& command);
+    void end_batch(Shard& shard);
+    void handle_trade(SymbolId symbol_id, const Trade& trade);
+    void handle_self_trade_cancel(SymbolId symbol_id, const SelfTradeCancel& cancel);
+    void handle_quote(SymbolId symbol_id, const TopOfBook& top);
+    void handle_book_update(SymbolId symbol_id, const BookUpdate& update);
+    void publish_book_update(Shard& shard, BookUpdate update);
+    void publish_pending_levels(Shard& shard);
+    void publish_book_state(Shard& shard);
+    template <typename T>
+    FeedSubscription<T> subscribe(BroadcastRing<T> Shard::*ring);
+    void open_journals();
+    std::string journal_path(size_t shard_index, uint64_t segment) const;
+    // Segment numbers of a shard's journal files on disk, ascending
+    std::vector<uint64_t> journal_segments(size_t shard_index) const;
+    // Close the shard's journal and continue in the next segment. The shard
+    // must not be running.
+    bool roll_journal(size_t shard_index, std::string& error);
+    void replay_journal(const Journal& journal, const RecoveredTradeCallback& on_trade, RecoveryStats& stats);
+    std::string snapshot_path() const { return config_.journal_dir + "/snapshot.bin"; }
+    void pause_shards();
+    void resume_shards();
+
+    BookManagerConfig config_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    // Indexed by SymbolId; null for symbols this manager does not own
+    std::vector<std::unique_ptr<OrderBook>> books_;
+    std::vector<size_t> shard_of_;
+    size_t next_shard_;
+    std::atomic<bool> running_;
+    OrderBook::TradeCallback trade_callback_;
+    bool recovering_ = false;
+
+    // Serializes start(), stop() and snapshots, so shards cannot exit mid-pause
+    std::mutex lifecycle_mutex_;
+    std::atomic<bool> pause_requested_{false};
+    std::atomic<size_t> paused_shards_{0};
+    // Keeps concurrent snapshots from deleting the segments the other starts at
+    std::mutex snapshot_mutex_;
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Order.h"
+#include <cstdint>
+
+enum class BookUpdateType : uint8_t {
+    LEVEL,        // New aggregate of one price level; zero quantity removes it
+    ORDER_ADD,    // An order joined the back of its level
+    ORDER_MODIFY, // A resting order's remaining quantity fell, keeping its place
+    ORDER_DELETE, // An order left the book: filled, cancelled or re-queued
+    BOOK_RESET    // The book's full state follows; drop what is held for it
+};
+
+// One change to the visible book. LEVEL updates (L2) carry the level's new
+// total quantity and order count; the ORDER_* updates (L3) carry one order's
+// id and remaining quantity. Prices are in ticks of the book. A BOOK_RESET
+// carries only the symbol and comes before a book's state is reported again.
+//
+// BookManager numbers each book's updates from 1 as it publishes them, counting
+// those a full ring dropped, so a subscriber that sees the number jump knows
+// its copy of that book is stale. The number stays inside the process.
+struct BookUpdate {
+    BookUpdateType type = BookUpdateType::LEVEL;
+    OrderSide side = OrderSide::BUY;
+    SymbolId symbol_id = 0;
+    Price price = 0;
+    uint64_t quantity = 0;
+    uint64_t order_id = 0;    // ORDER_* only
+    uint32_t order_count = 0; // LEVEL only
+    uint64_t sequence = 0;
+};
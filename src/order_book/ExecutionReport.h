@@ -0,0 +1,31 @@
+#pragma once
+
+#include "OrderCommand.h"
+#include "SelfTradeCancel.h"
+#include "Trade.h"
+#include <cstdint>
+
+enum class ExecutionType : uint8_t {
+    TRADE,
+    SELF_TRADE_CANCEL,
+    ORDER_STATUS
+};
+
+// What the book did with one command, published after any fills it caused.
+// remaining_quantity is what the command's order has left resting afterwards:
+// zero once it is filled, cancelled or expired, and for a refused command.
+struct OrderStatus {
+    OrderCommand command;
+    bool accepted = false; // False if the book refused the command or killed a FOK order
+    uint64_t remaining_quantity = 0;
+};
+
+// One fill, one self-trade prevention cut or one command's outcome, as
+// published to execution subscribers; `type` says which member is set. The
+// trade carries its symbol, aggressor side and both accounts.
+struct ExecutionReport {
+    ExecutionType type = ExecutionType::TRADE;
+    Trade trade;
+    SelfTradeCancel cancel;
+    OrderStatus status;
+};
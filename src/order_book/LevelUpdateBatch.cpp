@@ -0,0 +1,64 @@
+#include "LevelUpdateBatch.h"
+
+namespace {
+
+constexpr size_t kMinCapacity = 64;
+
+bool same_level(const BookUpdate& a, const BookUpdate& b) {
+    return a.price == b.price && a.side == b.side && a.symbol_id == b.symbol_id;
+}
+
+} // namespace
+
+LevelUpdateBatch::LevelUpdateBatch() : mask_(0), shift_(64) {
+    rehash(kMinCapacity);
+}
+
+void LevelUpdateBatch::record(const BookUpdate& update) {
+    size_t i = home(update);
+    for (; slots_[i] != 0; i = (i + 1) & mask_) {
+        BookUpdate& pending = updates_[slots_[i] - 1];
+        if (same_level(pending, update)) {
+            pending.quantity = update.quantity;
+            pending.order_count = update.order_count;
+            return;
+        }
+    }
+    updates_.push_back(update);
+    slots_[i] = static_cast<uint32_t>(updates_.size());
+    used_slots_.push_back(i);
+    if (2 * updates_.size() > slots_.size()) {
+        rehash(2 * slots_.size());
+    }
+}
+
+void LevelUpdateBatch::clear() {
+    for (size_t slot : used_slots_) {
+        slots_[slot] = 0;
+    }
+    used_slots_.clear();
+    updates_.clear();
+}
+
+uint64_t LevelUpdateBatch::key_hash(const BookUpdate& update) {
+    const uint64_t key = static_cast<uint64_t>(update.price) ^ (static_cast<uint64_t>(update.symbol_id) << 33) ^
+                         (static_cast<uint64_t>(update.side) << 32);
+    return key * 0x9E3779B97F4A7C15ULL;
+}
+
+void LevelUpdateBatch::rehash(size_t new_capacity) {
+    slots_.assign(new_capacity, 0);
+    mask_ = new_capacity - 1;
+    shift_ = 64;
+    for (size_t capacity = new_capacity; capacity > 1; capacity >>= 1) {
+        --shift_;
+    }
+    for (size_t index = 0; index < updates_.size(); ++index) {
+        size_t i = home(updates_[index]);
+        while (slots_[i] != 0) {
+            i = (i + 1) & mask_;
+        }
+        slots_[i] = static_cast<uint32_t>(index + 1);
+        used_slots_[index] = i;
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "BookUpdate.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief The latest LEVEL update of every level changed in one batch, in the
+ *        order the levels first changed.
+ *
+ * A flat table keyed by (symbol, side, price) points into the update list, so
+ * recording a change costs one hash probe however many levels the batch has
+ * touched; a sweep through hundreds of levels stays linear. The table doubles
+ * before it is half full and clear() empties only the slots the batch used, so
+ * a busy shard allocates nothing once it has seen its widest batch. Not
+ * thread-safe; one shard owns each batch.
+ */
+class LevelUpdateBatch {
+public:
+    LevelUpdateBatch();
+
+    // Replace the pending aggregate of update's level, or queue the level
+    void record(const BookUpdate& update);
+
+    const std::vector<BookUpdate>& updates() const { return updates_; }
+    bool empty() const { return updates_.empty(); }
+    void clear();
+
+private:
+    static uint64_t key_hash(const BookUpdate& update);
+    size_t home(const BookUpdate& update) const { return static_cast<size_t>(key_hash(update) >> shift_); }
+    void rehash(size_t new_capacity);
+
+    // Index into updates_ plus one; zero marks a free slot
+    std::vector<uint32_t> slots_;
+    size_t mask_;
+    unsigned shift_; // 64 - log2(capacity), so home() keeps the top bits of the hash
+    std::vector<BookUpdate> updates_;
+    std::vector<size_t> used_slots_; // Slot of each entry of updates_
+};
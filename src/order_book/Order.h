@@ -1,8 +1,12 @@
 #pragma once
 
+#include "Price.h"
+#include "common/SymbolTable.h"
 #include <cstdint>
 #include <chrono>
-#include <string>
+
+// Trading account an order belongs to; risk limits can be set per account
+using AccountId = uint32_t;
 
 enum class OrderType {
     LIMIT,
@@ -14,19 +18,48 @@ enum class OrderSide {
     SELL
 };
 
+// How long an order may work. IOC and FOK orders never rest: IOC fills what
+// it can and cancels the rest, FOK fills completely or not at all. MARKET
+// orders always behave as IOC (or FOK) with no price limit.
+enum class TimeInForce : uint8_t {
+    GTC,
+    IOC,
+    FOK
+};
+
+// What the book does when an incoming order would trade against a resting
+// order of the same account. The incoming order's mode decides; NONE lets the
+// trade happen.
+enum class SelfTradePrevention : uint8_t {
+    NONE,
+    CANCEL_RESTING,   // Cancel the resting order and keep matching
+    CANCEL_AGGRESSOR, // Cancel whatever the incoming order has left
+    CANCEL_BOTH,      // Cancel the resting order and the incoming remainder
+    DECREMENT         // Take the smaller quantity off both without trading
+};
+
 struct Order {
     uint64_t id;
-    std::string symbol;
+    SymbolId symbol_id;
+    AccountId account_id = 0;
     OrderType type;
     OrderSide side;
-    double price;
+    TimeInForce time_in_force = TimeInForce::GTC;
+    SelfTradePrevention self_trade_prevention = SelfTradePrevention::NONE;
+    Price price; // in ticks
     uint64_t quantity;
     uint64_t remaining_quantity;
     std::chrono::system_clock::time_point timestamp;
 
-    Order(uint64_t p_id, const std::string& p_symbol, OrderType p_type, OrderSide p_side, double p_price, uint64_t p_quantity)
+    // Intrusive links within the order's price level, owned by the book
+    Order* prev = nullptr;
+    Order* next = nullptr;
+
+    Order() = default;
+
+    Order(uint64_t p_id, SymbolId p_symbol_id, OrderType p_type, OrderSide p_side, Price p_price, uint64_t p_quantity)
         : id(p_id),
-          symbol(p_symbol),
+          symbol_id(p_symbol_id),
           type(p_type),
           side(p_side),
           price(p_price),
@@ -1,133 +1,479 @@
 #include "OrderBook.h"
 #include <iostream>
 #include <algorithm>
+#include <limits>
 
-OrderBook::OrderBook() : next_trade_id_(1) {}
+namespace {
+
+BookUpdate level_update(SymbolId symbol_id, OrderSide side, Price price, const PriceLevel& level) {
+    BookUpdate update;
+    update.type = BookUpdateType::LEVEL;
+    update.side = side;
+    update.symbol_id = symbol_id;
+    update.price = price;
+    update.quantity = level.total_quantity;
+    update.order_count = level.order_count;
+    return update;
+}
+
+BookUpdate order_update(BookUpdateType type, const Order& order) {
+    BookUpdate update;
+    update.type = type;
+    update.side = order.side;
+    update.symbol_id = order.symbol_id;
+    update.price = order.price;
+    update.quantity = order.remaining_quantity;
+    update.order_id = order.id;
+    return update;
+}
+
+} // namespace
+
+OrderBook::OrderBook(const OrderBookConfig& config)
+    : config_(config),
+      order_pool_(config.initial_order_capacity, &memory_),
+      bids_(OrderSide::BUY, config.ladder_levels, config.max_ladder_levels, &memory_),
+      asks_(OrderSide::SELL, config.ladder_levels, config.max_ladder_levels, &memory_),
+      order_index_(config.initial_order_capacity, &memory_),
+      next_trade_id_(1) {}
+
+std::unique_lock<std::mutex> OrderBook::lock_book() {
+    if (!config_.synchronized) {
+        return std::unique_lock<std::mutex>();
+    }
+    return std::unique_lock<std::mutex>(book_mutex_);
+}
 
 void OrderBook::on_trade(TradeCallback callback) {
     trade_callback_ = callback;
 }
 
-void OrderBook::add_order(std::shared_ptr<Order> order) {
-    std::lock_guard<std::mutex> lock(book_mutex_);
-    
-    // Store order for quick lookup
-    orders_map_[order->id] = order;
+void OrderBook::on_self_trade_cancel(SelfTradeCallback callback) {
+    self_trade_callback_ = callback;
+}
 
-    if (order->type == OrderType::LIMIT) {
-        add_limit_order(std::move(order));
-    } else if (order->type == OrderType::MARKET) {
-        add_market_order(std::move(order));
+void OrderBook::on_book_update(BookUpdateCallback callback, bool per_order) {
+    book_update_callback_ = callback;
+    report_orders_ = per_order;
+}
+
+void OrderBook::report_book_state() {
+    auto lock = lock_book();
+    if (book_update_callback_) {
+        report_state(book_update_callback_);
     }
+}
 
-    match_orders();
+void OrderBook::report_book_state(const BookUpdateCallback& sink) {
+    auto lock = lock_book();
+    report_state(sink);
 }
 
-void OrderBook::cancel_order(uint64_t order_id) {
-    std::lock_guard<std::mutex> lock(book_mutex_);
-    auto it = orders_map_.find(order_id);
-    if (it != orders_map_.end()) {
-        // "Lazy cancellation": just mark the remaining quantity as 0.
-        // The order will be purged when it's next encountered at the top of a price level.
-        it->second->remaining_quantity = 0;
-        orders_map_.erase(it);
-    }
+void OrderBook::on_top_of_book(TopOfBookCallback callback) {
+    auto lock = lock_book();
+    top_callback_ = callback;
+    top_ = current_top();
 }
 
-void OrderBook::add_limit_order(std::shared_ptr<Order> order) {
-    if (order->side == OrderSide::BUY) {
-        bids_[order->price].push(order);
+TopOfBook OrderBook::top_of_book() {
+    auto lock = lock_book();
+    return current_top();
+}
+
+bool OrderBook::add_order(const Order& order) {
+    auto lock = lock_book();
+
+    // A duplicate id would orphan the order already linked into its level
+    if (order_index_.contains(order.id)) {
+        return false;
+    }
+
+    const bool is_market = order.type == OrderType::MARKET;
+    const bool rests = !is_market && order.time_in_force == TimeInForce::GTC;
+    // Refuse before trading anything if the remainder could not be placed
+    if (rests && !(order.side == OrderSide::BUY ? bids_ : asks_).can_hold(order.price)) {
+        return false;
+    }
+
+    // A market order accepts any price the opposite side offers
+    const Price limit = !is_market ? order.price
+                      : order.side == OrderSide::BUY ? std::numeric_limits<Price>::max()
+                                                     : std::numeric_limits<Price>::min();
+    if (order.time_in_force == TimeInForce::FOK &&
+        (order.side == OrderSide::BUY ? asks_ : bids_).quantity_through(limit, order.quantity) < order.quantity) {
+        return false;
+    }
+
+    // Only a resting remainder enters the pool and index
+    const uint64_t remaining = match_incoming(order, limit);
+    if (!rests || remaining == 0) {
+        ++sequence_;
+        publish_top_of_book();
+        return true;
+    }
+
+    const OrderHandle handle = order_pool_.allocate(order);
+    Order* pooled = order_pool_.get(handle);
+    pooled->remaining_quantity = remaining;
+    const bool placed = add_limit_order(pooled);
+    if (placed) {
+        order_index_.insert(order.id, handle);
     } else {
-        asks_[order->price].push(order);
+        order_pool_.release(handle);
     }
+    ++sequence_;
+    publish_top_of_book();
+    return placed;
 }
 
-void OrderBook::add_market_order(std::shared_ptr<Order> order) {
-    // Market orders don't go on the book, they match immediately
-    // We handle the matching in the match_orders function
-    // For simplicity, we can think of them as limit orders with aggressive prices
-    // but the matching logic below will handle them directly.
+bool OrderBook::cancel_order(uint64_t order_id) {
+    auto lock = lock_book();
+    const OrderHandle handle = order_index_.erase(order_id);
+    if (!handle.valid()) {
+        return false;
+    }
+
+    // Only resting limit orders are ever indexed
+    Order* order = order_pool_.get(handle);
+    PriceLadder& ladder = (order->side == OrderSide::BUY) ? bids_ : asks_;
+    PriceLevel* level = ladder.find(order->price);
+    level->erase(order);
+    report_level(order->symbol_id, order->side, order->price, *level);
+    report_order(BookUpdateType::ORDER_DELETE, *order);
+    if (level->empty()) {
+        ladder.erase_level(order->price);
+    }
+    order_pool_.release(handle);
+    ++sequence_;
+    publish_top_of_book();
+    return true;
 }
 
+bool OrderBook::modify_order(uint64_t order_id, Price new_price, uint64_t new_quantity) {
+    auto lock = lock_book();
+    const OrderHandle handle = order_index_.find(order_id);
+    if (!handle.valid() || new_quantity == 0) {
+        return false;
+    }
 
-void OrderBook::match_orders() {
-    while (!bids_.empty() && !asks_.empty() && bids_.begin()->first >= asks_.begin()->first) {
-        auto& best_bid_level = bids_.begin()->second;
-        auto& best_ask_level = asks_.begin()->second;
-        
-        while (!best_bid_level.empty() && !best_ask_level.empty()) {
-            auto& bid_order = best_bid_level.front();
-            auto& ask_order = best_ask_level.front();
+    Order* order = order_pool_.get(handle);
+    PriceLadder& ladder = (order->side == OrderSide::BUY) ? bids_ : asks_;
+    PriceLevel* level = ladder.find(order->price);
+    // Filled quantity is kept, so quantity stays filled + remaining
+    const uint64_t filled = order->quantity - order->remaining_quantity;
 
-            // Purge cancelled orders
-            if (bid_order->remaining_quantity == 0) {
-                best_bid_level.pop();
-                continue;
-            }
-            if (ask_order->remaining_quantity == 0) {
-                best_ask_level.pop();
-                continue;
-            }
+    // A smaller size at the same price keeps priority; the best prices cannot change
+    if (new_price == order->price && new_quantity <= order->remaining_quantity) {
+        level->total_quantity -= order->remaining_quantity - new_quantity;
+        order->remaining_quantity = new_quantity;
+        order->quantity = filled + new_quantity;
+        report_level(order->symbol_id, order->side, order->price, *level);
+        report_order(BookUpdateType::ORDER_MODIFY, *order);
+        ++sequence_;
+        return true;
+    }
+    // Refuse before unlinking or trading anything if the order could not rest
+    // at its new price; the check counts the order's own level, so it holds
+    // once that level is gone too
+    if (!ladder.can_hold(new_price)) {
+        return false;
+    }
 
-            uint64_t trade_quantity = std::min(bid_order->remaining_quantity, ask_order->remaining_quantity);
-            double trade_price = (bid_order->timestamp < ask_order->timestamp) ? bid_order->price : ask_order->price;
+    // Everything else re-queues: out of the old level, through the opposite
+    // side if it now crosses, and onto the back of the new level
+    level->erase(order);
+    report_level(order->symbol_id, order->side, order->price, *level);
+    report_order(BookUpdateType::ORDER_DELETE, *order);
+    if (level->empty()) {
+        ladder.erase_level(order->price);
+    }
+    order->price = new_price;
+    order->quantity = filled + new_quantity;
+    order->remaining_quantity = new_quantity;
+    const uint64_t remaining = match_incoming(*order, new_price);
+    if (remaining == 0) {
+        release_order(order_id);
+    } else {
+        order->remaining_quantity = remaining;
+        // Cannot fail: can_hold() accepted the price with the old level still counted
+        add_limit_order(order);
+    }
+    ++sequence_;
+    publish_top_of_book();
+    return true;
+}
 
-            if (trade_callback_) {
-                trade_callback_(Trade(next_trade_id_++, bid_order->id, ask_order->id, trade_price, trade_quantity));
-            }
+uint64_t OrderBook::sequence() {
+    auto lock = lock_book();
+    return sequence_;
+}
 
-            bid_order->remaining_quantity -= trade_quantity;
-            ask_order->remaining_quantity -= trade_quantity;
+size_t OrderBook::live_orders() {
+    auto lock = lock_book();
+    return order_index_.size();
+}
 
-            if (bid_order->remaining_quantity == 0) {
-                orders_map_.erase(bid_order->id);
-                best_bid_level.pop();
-            }
-            if (ask_order->remaining_quantity == 0) {
-                orders_map_.erase(ask_order->id);
-                best_ask_level.pop();
+uint64_t OrderBook::remaining_quantity(uint64_t order_id) {
+    auto lock = lock_book();
+    const OrderHandle handle = order_index_.find(order_id);
+    return handle.valid() ? order_pool_.get(handle)->remaining_quantity : 0;
+}
+
+BookSnapshot OrderBook::snapshot() {
+    auto lock = lock_book();
+    BookSnapshot snapshot;
+    snapshot.next_trade_id = next_trade_id_;
+    snapshot.orders.reserve(order_index_.size());
+    for (const PriceLadder* ladder : {&bids_, &asks_}) {
+        ladder->for_each_level([&](Price, const PriceLevel& level) {
+            for (const Order* order = level.front(); order; order = order->next) {
+                snapshot.orders.push_back(*order);
+                snapshot.orders.back().prev = snapshot.orders.back().next = nullptr;
             }
-        }
+        });
+    }
+    return snapshot;
+}
 
-        if (best_bid_level.empty()) {
-            bids_.erase(bids_.begin());
+bool OrderBook::restore(const BookSnapshot& snapshot) {
+    auto lock = lock_book();
+    if (!order_index_.empty()) {
+        return false;
+    }
+    // Orders are appended in priority order and never cross, so no matching runs
+    for (const Order& order : snapshot.orders) {
+        if (order.type != OrderType::LIMIT || order.remaining_quantity == 0 || order_index_.contains(order.id)) {
+            return false;
         }
-        if (best_ask_level.empty()) {
-            asks_.erase(asks_.begin());
+        const OrderHandle handle = order_pool_.allocate(order);
+        if (!add_limit_order(order_pool_.get(handle))) {
+            order_pool_.release(handle);
+            return false;
         }
+        order_index_.insert(order.id, handle);
     }
+    next_trade_id_ = snapshot.next_trade_id;
+    ++sequence_;
+    publish_top_of_book();
+    return true;
 }
 
+void OrderBook::release_order(uint64_t order_id) {
+    // The pool ignores the invalid handle of an id that was never indexed
+    order_pool_.release(order_index_.erase(order_id));
+}
 
-std::vector<std::pair<double, uint64_t>> OrderBook::get_depth(OrderSide side) {
-    std::lock_guard<std::mutex> lock(book_mutex_);
-    std::vector<std::pair<double, uint64_t>> depth;
-    
-    if (side == OrderSide::BUY) {
-        for (const auto& [price, level] : bids_) {
-            uint64_t total_quantity = 0;
-            // A copy of the queue to inspect it without modifying the original
-            std::queue<std::shared_ptr<Order>> temp_queue = level;
-            while(!temp_queue.empty()) {
-                total_quantity += temp_queue.front()->remaining_quantity;
-                temp_queue.pop();
-            }
-            if (total_quantity > 0) {
-                depth.emplace_back(price, total_quantity);
-            }
+TopOfBook OrderBook::current_top() const {
+    TopOfBook top;
+    top.has_bid = !bids_.empty();
+    top.has_ask = !asks_.empty();
+    top.best_bid = top.has_bid ? bids_.best_price() : 0;
+    top.best_ask = top.has_ask ? asks_.best_price() : 0;
+    return top;
+}
+
+// Costs two compares per call when nothing changed, and nothing without a listener
+void OrderBook::publish_top_of_book() {
+    if (!top_callback_) {
+        return;
+    }
+    const TopOfBook top = current_top();
+    if (top != top_) {
+        top_ = top;
+        top_callback_(top);
+    }
+}
+
+bool OrderBook::add_limit_order(Order* order) {
+    PriceLadder& ladder = (order->side == OrderSide::BUY) ? bids_ : asks_;
+    PriceLevel* level = ladder.get_or_create(order->price);
+    if (!level) {
+        return false;
+    }
+    level->push_back(order);
+    report_level(order->symbol_id, order->side, order->price, *level);
+    report_order(BookUpdateType::ORDER_ADD, *order);
+    return true;
+}
+
+// Trades `incoming` against the opposite side down to `limit`; returns what is left
+uint64_t OrderBook::match_incoming(const Order& incoming, Price limit) {
+    PriceLadder& contra = (incoming.side == OrderSide::BUY) ? asks_ : bids_;
+    const OrderSide contra_side = (incoming.side == OrderSide::BUY) ? OrderSide::SELL : OrderSide::BUY;
+    uint64_t remaining = incoming.remaining_quantity;
+    // Fixed for the whole call, so orders without a mode pay one predictable
+    // branch per fill and the account compare is skipped entirely
+    const bool prevent_self_trades = incoming.self_trade_prevention != SelfTradePrevention::NONE;
+
+    while (remaining > 0 && !contra.empty()) {
+        const Price level_price = contra.best_price();
+        if (incoming.side == OrderSide::BUY ? level_price > limit : level_price < limit) {
+            break;
         }
-    } else { // SELL
-        for (const auto& [price, level] : asks_) {
-            uint64_t total_quantity = 0;
-            std::queue<std::shared_ptr<Order>> temp_queue = level;
-            while(!temp_queue.empty()) {
-                total_quantity += temp_queue.front()->remaining_quantity;
-                temp_queue.pop();
+        PriceLevel& level = contra.best_level();
+        const double trade_price = to_price(level_price, config_.tick_size);
+
+        while (remaining > 0 && !level.empty()) {
+            Order* resting = level.front();
+            if (prevent_self_trades && resting->account_id == incoming.account_id) {
+                remaining = prevent_self_trade(incoming, level, remaining);
+                continue;
             }
-             if (total_quantity > 0) {
-                depth.emplace_back(price, total_quantity);
+            const uint64_t trade_quantity = std::min(remaining, resting->remaining_quantity);
+            // Numbered whether or not anyone listens, so a book replayed without
+            // a callback assigns the ids the live book did
+            const uint64_t trade_id = next_trade_id_++;
+
+            if (trade_callback_) {
+                Trade trade(trade_id, resting->id, incoming.id, trade_price, trade_quantity);
+                trade.symbol_id = incoming.symbol_id;
+                trade.aggressor_side = incoming.side;
+                trade.resting_account = resting->account_id;
+                trade.aggressive_account = incoming.account_id;
+                trade_callback_(trade);
             }
+
+            last_trade_price_ = trade_price;
+            last_trade_quantity_ = trade_quantity;
+            remaining -= trade_quantity;
+            reduce_front(level, trade_quantity);
+        }
+
+        // One update per level however many orders the sweep took from it
+        report_level(incoming.symbol_id, contra_side, level_price, level);
+        if (level.empty()) {
+            contra.erase_level(level_price);
         }
     }
+    return remaining;
+}
+
+// Applies the incoming order's mode to the front of `level`, which belongs to
+// the same account; returns what the incoming order has left
+uint64_t OrderBook::prevent_self_trade(const Order& incoming, PriceLevel& level, uint64_t remaining) {
+    const Order& resting = *level.front();
+    uint64_t resting_cut = 0;
+    uint64_t incoming_cut = 0;
+    switch (incoming.self_trade_prevention) {
+        case SelfTradePrevention::CANCEL_RESTING:
+            resting_cut = resting.remaining_quantity;
+            break;
+        case SelfTradePrevention::CANCEL_AGGRESSOR:
+            incoming_cut = remaining;
+            break;
+        case SelfTradePrevention::CANCEL_BOTH:
+            resting_cut = resting.remaining_quantity;
+            incoming_cut = remaining;
+            break;
+        case SelfTradePrevention::DECREMENT:
+            resting_cut = incoming_cut = std::min(remaining, resting.remaining_quantity);
+            break;
+        case SelfTradePrevention::NONE:
+            break;
+    }
+    if (incoming_cut > 0) {
+        report_self_trade_cancel(incoming, false, incoming_cut);
+    }
+    if (resting_cut > 0) {
+        report_self_trade_cancel(resting, true, resting_cut);
+        reduce_front(level, resting_cut);
+    }
+    return remaining - incoming_cut;
+}
+
+// Takes `quantity` off the order at the front of `level`, releasing it once empty
+void OrderBook::reduce_front(PriceLevel& level, uint64_t quantity) {
+    Order* order = level.front();
+    order->remaining_quantity -= quantity;
+    level.total_quantity -= quantity;
+    if (order->remaining_quantity == 0) {
+        level.pop_front();
+        report_order(BookUpdateType::ORDER_DELETE, *order);
+        release_order(order->id);
+    } else {
+        report_order(BookUpdateType::ORDER_MODIFY, *order);
+    }
+}
+
+void OrderBook::report_self_trade_cancel(const Order& order, bool resting, uint64_t quantity) {
+    if (self_trade_callback_) {
+        self_trade_callback_(
+            SelfTradeCancel{order.id, order.symbol_id, order.account_id, order.side, resting, quantity});
+    }
+}
+
+void OrderBook::report_level(SymbolId symbol_id, OrderSide side, Price price, const PriceLevel& level) {
+    if (book_update_callback_) {
+        book_update_callback_(level_update(symbol_id, side, price, level));
+    }
+}
+
+void OrderBook::report_order(BookUpdateType type, const Order& order) {
+    if (report_orders_ && book_update_callback_) {
+        book_update_callback_(order_update(type, order));
+    }
+}
+
+void OrderBook::report_state(const BookUpdateCallback& sink) const {
+    for (const PriceLadder* ladder : {&bids_, &asks_}) {
+        ladder->for_each_level([&](Price price, const PriceLevel& level) {
+            sink(level_update(level.front()->symbol_id, level.front()->side, price, level));
+        });
+    }
+    if (!report_orders_) {
+        return;
+    }
+    for (const PriceLadder* ladder : {&bids_, &asks_}) {
+        ladder->for_each_level([&](Price, const PriceLevel& level) {
+            for (const Order* order = level.front(); order; order = order->next) {
+                sink(order_update(BookUpdateType::ORDER_ADD, *order));
+            }
+        });
+    }
+}
+
+
+std::vector<std::pair<double, uint64_t>> OrderBook::get_depth(OrderSide side) {
+    auto lock = lock_book();
+    std::vector<std::pair<double, uint64_t>> depth;
+
+    const PriceLadder& ladder = (side == OrderSide::BUY) ? bids_ : asks_;
+    depth.reserve(ladder.level_count());
+    ladder.for_each_level([&](Price price, const PriceLevel& level) {
+        depth.emplace_back(to_price(price, config_.tick_size), level.total_quantity);
+    });
     return depth;
 }
+
+size_t OrderBook::get_depth(OrderSide side, DepthLevel* out, size_t max_levels) {
+    auto lock = lock_book();
+    size_t count = 0;
+
+    const PriceLadder& ladder = (side == OrderSide::BUY) ? bids_ : asks_;
+    ladder.for_each_level([&](Price price, const PriceLevel& level) {
+        out[count++] = DepthLevel{to_price(price, config_.tick_size), level.total_quantity, level.order_count};
+    }, max_levels);
+    return count;
+}
+
+void OrderBook::publish_depth_snapshot() {
+    auto lock = lock_book();
+    // The seqlock's initial empty snapshot already matches sequence 0
+    if (sequence_ == published_sequence_) {
+        return;
+    }
+    DepthSnapshot snapshot;
+    snapshot.sequence = sequence_;
+    bids_.for_each_level([&](Price price, const PriceLevel& level) {
+        snapshot.bids[snapshot.bid_count++] =
+            DepthLevel{to_price(price, config_.tick_size), level.total_quantity, level.order_count};
+    }, DepthSnapshot::kLevels);
+    asks_.for_each_level([&](Price price, const PriceLevel& level) {
+        snapshot.asks[snapshot.ask_count++] =
+            DepthLevel{to_price(price, config_.tick_size), level.total_quantity, level.order_count};
+    }, DepthSnapshot::kLevels);
+    snapshot.last_trade_price = last_trade_price_;
+    snapshot.last_trade_quantity = last_trade_quantity_;
+    published_depth_.store(snapshot);
+    published_sequence_ = sequence_;
+}
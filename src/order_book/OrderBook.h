@@ -1,50 +1,216 @@
 #pragma once
 
+#include "BookUpdate.h"
 #include "Order.h"
+#include "SelfTradeCancel.h"
 #include "Trade.h"
-#include <map>
-#include <queue>
+#include "OrderIndex.h"
+#include "OrderPool.h"
+#include "PriceLadder.h"
+#include "common/CountingResource.h"
+#include "common/Seqlock.h"
 #include <mutex>
 #include <functional>
-#include <memory>
-#include <unordered_map>
+#include <memory_resource>
 #include <vector>
 
+struct OrderBookConfig {
+    double tick_size = 0.01;
+    // Ticks covered by each side's ladder initially (rounded up to a power of two)
+    size_t ladder_levels = 1024;
+    // Upper bound on ladder growth; orders that would need a wider band are rejected
+    size_t max_ladder_levels = 1 << 20;
+    // Live orders the pool and id index are sized for before they need to grow
+    size_t initial_order_capacity = 4096;
+    // Guard every public call with book_mutex_. Books driven by a single
+    // matching thread with no outside readers can turn this off.
+    bool synchronized = true;
+};
+
+// Resting orders in priority order (bids best first, then asks best first,
+// FIFO within a level) plus the counters needed to rebuild an identical book
+struct BookSnapshot {
+    uint64_t next_trade_id = 1;
+    std::vector<Order> orders;
+};
+
+// Best prices on each side, in ticks; a side with no orders has no price
+struct TopOfBook {
+    Price best_bid = 0;
+    Price best_ask = 0;
+    bool has_bid = false;
+    bool has_ask = false;
+
+    bool operator==(const TopOfBook& other) const {
+        return best_bid == other.best_bid && best_ask == other.best_ask && has_bid == other.has_bid &&
+               has_ask == other.has_ask;
+    }
+    bool operator!=(const TopOfBook& other) const { return !(*this == other); }
+};
+
+// Aggregate view of one price level
+struct DepthLevel {
+    double price;
+    uint64_t quantity;
+    uint32_t order_count;
+};
+
+// The best levels of each side and the last trade as of one book sequence
+// number, published for readers that must not take the book lock
+struct DepthSnapshot {
+    static constexpr size_t kLevels = 20;
+
+    uint64_t sequence = 0; // OrderBook::sequence() the snapshot was taken at
+    uint32_t bid_count = 0;
+    uint32_t ask_count = 0;
+    DepthLevel bids[kLevels] = {};
+    DepthLevel asks[kLevels] = {};
+    double last_trade_price = 0.0;
+    uint64_t last_trade_quantity = 0; // Zero until the book has traded
+};
+
 class OrderBook {
 public:
     using TradeCallback = std::function<void(const Trade&)>;
+    using TopOfBookCallback = std::function<void(const TopOfBook&)>;
+    using SelfTradeCallback = std::function<void(const SelfTradeCancel&)>;
+    using BookUpdateCallback = std::function<void(const BookUpdate&)>;
 
-    OrderBook();
+    explicit OrderBook(const OrderBookConfig& config = OrderBookConfig());
 
-    // Add a new order to the book
-    void add_order(std::shared_ptr<Order> order);
+    // Add a new order to the book; it is copied into the book's order pool.
+    // Order prices are in ticks of tick_size(). Returns false if the id is
+    // already live, the price lies outside the range the ladder can cover, or
+    // the order is FOK and cannot fill in full; a killed FOK trades nothing.
+    // The order first trades against the opposite side as the aggressor, at
+    // each resting order's price; only a GTC limit order's remainder then
+    // rests. MARKET, IOC and FOK orders never rest, whatever they cannot fill
+    // is cancelled. A resting order of the same account is handled by the
+    // incoming order's self_trade_prevention mode instead of being traded
+    // against; the FOK check runs first and counts such orders as fillable.
+    bool add_order(const Order& order);
 
-    // Cancel an existing order
-    void cancel_order(uint64_t order_id);
+    // Cancel an existing order, unlinking it from its price level immediately.
+    // Returns false if the order is unknown or already done.
+    bool cancel_order(uint64_t order_id);
+
+    // Change a resting order's price (in ticks) and remaining quantity in one
+    // step. Lowering the quantity at the same price is done in place and keeps
+    // the order's place in the queue; any other change moves it to the back of
+    // its new level. A price moved through the opposite side first trades
+    // there as an incoming order would. Returns false, leaving the order as it
+    // was, if the order is unknown, new_quantity is zero or the new price lies
+    // outside the range the ladder can cover. Otherwise the modify has been
+    // applied and returns true even if the order no longer rests: it may have
+    // filled, or its self-trade prevention mode may have cancelled what was
+    // left, which is reported through the self-trade callback. Use
+    // remaining_quantity() to see what still rests.
+    bool modify_order(uint64_t order_id, Price new_price, uint64_t new_quantity);
 
     // Register a callback for trade events
     void on_trade(TradeCallback callback);
+
+    // Register a callback run for each quantity self-trade prevention cancels
+    void on_self_trade_cancel(SelfTradeCallback callback);
+
+    // Register a callback run synchronously for every change to the visible
+    // book: a LEVEL update whenever a level's aggregate changes (once per level
+    // a sweep touches) and, with per_order set, the ORDER_* updates of each
+    // order that is added, reduced or removed.
+    void on_book_update(BookUpdateCallback callback, bool per_order = false);
+
+    // Report the current book through the book-update callback as LEVEL
+    // updates, best first, then with per-order updates on, an ORDER_ADD for
+    // every resting order in priority order. Lets a late subscriber build the
+    // book before it applies changes.
+    void report_book_state();
+    // The same report sent to `sink` instead, bypassing the registered
+    // callback; per-order updates follow the on_book_update() setting
+    void report_book_state(const BookUpdateCallback& sink);
+
+    // Register a callback run whenever the best bid or ask price changes, after
+    // the call that changed it has finished matching. Quantity changes at an
+    // unchanged best price are not reported.
+    void on_top_of_book(TopOfBookCallback callback);
+    TopOfBook top_of_book();
     
     // Get a snapshot of the order book depth
     std::vector<std::pair<double, uint64_t>> get_depth(OrderSide side);
 
+    // Copy up to max_levels of the best levels on `side` into `out`, best first.
+    // Reads the per-level aggregates in O(max_levels) without allocating;
+    // returns the number of levels written.
+    size_t get_depth(OrderSide side, DepthLevel* out, size_t max_levels);
+
+    // Copy the best DepthSnapshot::kLevels levels of each side and the last
+    // trade into the published snapshot, unless nothing has changed since the
+    // previous call. Called by whichever thread drives the book, typically
+    // once per batch of commands rather than after each one.
+    void publish_depth_snapshot();
+
+    // The snapshot last published. Never takes the book lock, so any thread
+    // can read it while the book is matching.
+    DepthSnapshot depth_snapshot() const { return published_depth_.load(); }
+
+    // Counts the add, cancel and modify calls that changed the book
+    uint64_t sequence();
+
+    double tick_size() const { return config_.tick_size; }
+
+    // Heap allocations made by the book's pools, ladders and index since
+    // construction. Flat once the book has warmed up to its working size.
+    uint64_t heap_allocations() const { return memory_.allocations(); }
+
+    size_t live_orders();
+
+    // Quantity the resting order `order_id` has left; 0 if no such order rests
+    uint64_t remaining_quantity(uint64_t order_id);
+
+    // Copy the book's resting orders and trade counter
+    BookSnapshot snapshot();
+
+    // Load `snapshot` into an empty book. Returns false, leaving whatever was
+    // placed so far, if the book is not empty or an order cannot be placed.
+    bool restore(const BookSnapshot& snapshot);
+
 private:
-    using PriceLevel = std::queue<std::shared_ptr<Order>>;
-    
-    // Bids are sorted high-to-low, so we use std::greater
-    std::map<double, PriceLevel, std::greater<double>> bids_;
-    // Asks are sorted low-to-high, so we use the default std::less
-    std::map<double, PriceLevel> asks_;
+    OrderBookConfig config_;
+
+    // All book storage is drawn through memory_ so heap traffic can be counted
+    CountingResource memory_;
+    OrderPool order_pool_;
+
+    // Bids are walked high-to-low and asks low-to-high by their ladders
+    PriceLadder bids_;
+    PriceLadder asks_;
 
-    // For fast O(1) average time complexity access to orders for cancellation
-    std::unordered_map<uint64_t, std::shared_ptr<Order>> orders_map_;
+    // Maps order ids to their pool slots; price levels link the same orders intrusively
+    OrderIndex order_index_;
 
     std::mutex book_mutex_;
     TradeCallback trade_callback_;
+    SelfTradeCallback self_trade_callback_;
+    BookUpdateCallback book_update_callback_;
+    bool report_orders_ = false;
+    TopOfBookCallback top_callback_;
+    TopOfBook top_; // As last reported to top_callback_
     uint64_t next_trade_id_;
+    uint64_t sequence_ = 0;
+    double last_trade_price_ = 0.0;
+    uint64_t last_trade_quantity_ = 0;
+    Seqlock<DepthSnapshot> published_depth_;
+    uint64_t published_sequence_ = 0;
 
-    void match_orders();
-    void execute_trade(std::shared_ptr<Order>& resting_order, std::shared_ptr<Order>& aggressive_order, PriceLevel& resting_level);
-    void add_limit_order(std::shared_ptr<Order> order);
-    void add_market_order(std::shared_ptr<Order> order);
+    std::unique_lock<std::mutex> lock_book();
+    bool add_limit_order(Order* order);
+    uint64_t match_incoming(const Order& incoming, Price limit);
+    uint64_t prevent_self_trade(const Order& incoming, PriceLevel& level, uint64_t remaining);
+    void reduce_front(PriceLevel& level, uint64_t quantity);
+    void report_self_trade_cancel(const Order& order, bool resting, uint64_t quantity);
+    void report_level(SymbolId symbol_id, OrderSide side, Price price, const PriceLevel& level);
+    void report_order(BookUpdateType type, const Order& order);
+    void report_state(const BookUpdateCallback& sink) const;
+    void release_order(uint64_t order_id);
+    TopOfBook current_top() const;
+    void publish_top_of_book();
 };
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Order.h"
+#include <cstdint>
+
+enum class CommandType : uint8_t {
+    NEW_ORDER,
+    CANCEL,
+    MODIFY
+};
+
+// Fixed-size instruction routed to the shard that owns `symbol_id`.
+// Prices are in ticks of the target book; cancels only use order_id and
+// modifies order_id, price and quantity (the new remaining quantity).
+struct OrderCommand {
+    CommandType type = CommandType::NEW_ORDER;
+    OrderType order_type = OrderType::LIMIT;
+    OrderSide side = OrderSide::BUY;
+    TimeInForce time_in_force = TimeInForce::GTC;
+    SelfTradePrevention self_trade_prevention = SelfTradePrevention::NONE;
+    SymbolId symbol_id = 0;
+    AccountId account_id = 0;
+    uint64_t order_id = 0;
+    Price price = 0;
+    uint64_t quantity = 0;
+
+    static OrderCommand new_order(const Order& order) {
+        return OrderCommand{CommandType::NEW_ORDER, order.type, order.side, order.time_in_force,
+                            order.self_trade_prevention, order.symbol_id, order.account_id, order.id,
+                            order.price, order.quantity};
+    }
+
+    static OrderCommand cancel(SymbolId symbol_id, uint64_t order_id) {
+        OrderCommand command;
+        command.type = CommandType::CANCEL;
+        command.symbol_id = symbol_id;
+        command.order_id = order_id;
+        return command;
+    }
+
+    static OrderCommand modify(SymbolId symbol_id, uint64_t order_id, Price price, uint64_t quantity) {
+        OrderCommand command;
+        command.type = CommandType::MODIFY;
+        command.symbol_id = symbol_id;
+        command.order_id = order_id;
+        command.price = price;
+        command.quantity = quantity;
+        return command;
+    }
+
+    Order to_order() const {
+        Order order(order_id, symbol_id, order_type, side, price, quantity);
+        order.time_in_force = time_in_force;
+        order.self_trade_prevention = self_trade_prevention;
+        order.account_id = account_id;
+        return order;
+    }
+};
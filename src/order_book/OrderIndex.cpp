@@ -0,0 +1,78 @@
+#include "OrderIndex.h"
+
+namespace {
+
+constexpr size_t kMinCapacity = 16;
+
+} // namespace
+
+OrderIndex::OrderIndex(size_t initial_capacity, std::pmr::memory_resource* resource)
+    : slots_(resource),
+      mask_(0),
+      shift_(64),
+      size_(0) {
+    // Room for initial_capacity ids without crossing the half-full mark
+    size_t capacity = kMinCapacity;
+    while (capacity < 2 * initial_capacity) {
+        capacity <<= 1;
+    }
+    rehash(capacity);
+}
+
+bool OrderIndex::insert(uint64_t order_id, OrderHandle handle) {
+    if (2 * (size_ + 1) > slots_.size()) {
+        rehash(2 * slots_.size());
+    }
+    size_t i = home(order_id);
+    for (; slots_[i].handle.valid(); i = (i + 1) & mask_) {
+        if (slots_[i].order_id == order_id) {
+            return false;
+        }
+    }
+    slots_[i] = Entry{order_id, handle};
+    ++size_;
+    return true;
+}
+
+OrderHandle OrderIndex::erase(uint64_t order_id) {
+    size_t hole = home(order_id);
+    while (slots_[hole].handle.valid() && slots_[hole].order_id != order_id) {
+        hole = (hole + 1) & mask_;
+    }
+    const OrderHandle handle = slots_[hole].handle;
+    if (!handle.valid()) {
+        return handle;
+    }
+
+    // Pull back any later entry of the run whose home is at or before the hole,
+    // so every entry stays reachable from its home without tombstones
+    for (size_t next = (hole + 1) & mask_; slots_[next].handle.valid(); next = (next + 1) & mask_) {
+        const size_t displacement = (next - home(slots_[next].order_id)) & mask_;
+        if (displacement >= ((next - hole) & mask_)) {
+            slots_[hole] = slots_[next];
+            hole = next;
+        }
+    }
+    slots_[hole] = Entry{};
+    --size_;
+    return handle;
+}
+
+void OrderIndex::rehash(size_t new_capacity) {
+    std::pmr::vector<Entry> old(new_capacity, slots_.get_allocator());
+    old.swap(slots_);
+    mask_ = new_capacity - 1;
+    shift_ = 64;
+    for (size_t n = new_capacity; n > 1; n >>= 1) {
+        --shift_;
+    }
+    for (const Entry& entry : old) {
+        if (entry.handle.valid()) {
+            size_t i = home(entry.order_id);
+            while (slots_[i].handle.valid()) {
+                i = (i + 1) & mask_;
+            }
+            slots_[i] = entry;
+        }
+    }
+}
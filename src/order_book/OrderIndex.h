@@ -0,0 +1,66 @@
+#pragma once
+
+#include "OrderPool.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+/**
+ * @brief Flat map from order id to pool handle for the orders resting in a book.
+ *
+ * Entries sit in a single power-of-two array probed linearly from a Fibonacci
+ * hash of the id, so the monotonically increasing ids handed out by the
+ * gateway spread evenly instead of piling into neighbouring slots. Erase
+ * shifts the following entries back rather than leaving tombstones, and the
+ * table doubles before it is half full, so probe runs stay short however long
+ * the book churns. Nothing is allocated per entry; the array is drawn from the
+ * memory resource only when it grows. Not thread-safe; the owning book
+ * serializes access.
+ */
+class OrderIndex {
+public:
+    OrderIndex(size_t initial_capacity, std::pmr::memory_resource* resource);
+
+    OrderIndex(const OrderIndex&) = delete;
+    OrderIndex& operator=(const OrderIndex&) = delete;
+
+    // Handle stored for `order_id`, or an invalid handle if there is none
+    OrderHandle find(uint64_t order_id) const {
+        for (size_t i = home(order_id);; i = (i + 1) & mask_) {
+            const Entry& entry = slots_[i];
+            if (!entry.handle.valid() || entry.order_id == order_id) {
+                return entry.handle;
+            }
+        }
+    }
+
+    bool contains(uint64_t order_id) const { return find(order_id).valid(); }
+
+    // Add `order_id`; returns false, leaving the table unchanged, if it is already present
+    bool insert(uint64_t order_id, OrderHandle handle);
+
+    // Remove `order_id` and return its handle, or an invalid handle if it was not present
+    OrderHandle erase(uint64_t order_id);
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_t capacity() const { return slots_.size(); }
+
+private:
+    // An invalid handle marks a free slot
+    struct Entry {
+        uint64_t order_id = 0;
+        OrderHandle handle;
+    };
+
+    size_t home(uint64_t order_id) const {
+        return static_cast<size_t>((order_id * 0x9E3779B97F4A7C15ULL) >> shift_);
+    }
+    void rehash(size_t new_capacity);
+
+    std::pmr::vector<Entry> slots_;
+    size_t mask_;
+    unsigned shift_; // 64 - log2(capacity), so home() keeps the top bits of the hash
+    size_t size_;
+};
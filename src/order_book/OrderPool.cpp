@@ -0,0 +1,67 @@
+#include "OrderPool.h"
+#include <new>
+
+OrderPool::OrderPool(size_t initial_capacity, std::pmr::memory_resource* resource)
+    : resource_(resource),
+      slabs_(resource),
+      free_head_(OrderHandle::kInvalidIndex),
+      live_(0) {
+    while (capacity() < initial_capacity) {
+        add_slab();
+    }
+}
+
+OrderPool::~OrderPool() {
+    // Slots are trivially destructible, so the slabs can be handed straight back
+    for (Slot* slab : slabs_) {
+        resource_->deallocate(slab, sizeof(Slot) * kSlabSize, alignof(Slot));
+    }
+}
+
+OrderHandle OrderPool::allocate(const Order& order) {
+    if (free_head_ == OrderHandle::kInvalidIndex) {
+        add_slab();
+    }
+
+    const uint32_t index = free_head_;
+    Slot& s = slot(index);
+    free_head_ = s.next_free;
+
+    s.order = order;
+    s.order.prev = nullptr;
+    s.order.next = nullptr;
+    ++live_;
+    return OrderHandle{index, s.generation};
+}
+
+void OrderPool::release(OrderHandle handle) {
+    if (!get(handle)) {
+        return;
+    }
+    Slot& s = slot(handle.index);
+    ++s.generation;
+    s.next_free = free_head_;
+    free_head_ = handle.index;
+    --live_;
+}
+
+Order* OrderPool::get(OrderHandle handle) {
+    if (!handle.valid() || (handle.index >> kSlabShift) >= slabs_.size()) {
+        return nullptr;
+    }
+    Slot& s = slot(handle.index);
+    return s.generation == handle.generation ? &s.order : nullptr;
+}
+
+void OrderPool::add_slab() {
+    auto* slab = static_cast<Slot*>(resource_->allocate(sizeof(Slot) * kSlabSize, alignof(Slot)));
+    const uint32_t first_index = static_cast<uint32_t>(slabs_.size()) << kSlabShift;
+
+    // Thread the new slots onto the free list so that lower indices come out first
+    for (uint32_t i = kSlabSize; i-- > 0;) {
+        new (&slab[i]) Slot();
+        slab[i].next_free = free_head_;
+        free_head_ = first_index + i;
+    }
+    slabs_.push_back(slab);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Order.h"
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+// Stable reference to a pooled order. The slot's generation changes every time
+// it is recycled, so a handle to a released order never resolves again.
+struct OrderHandle {
+    static constexpr uint32_t kInvalidIndex = UINT32_MAX;
+
+    uint32_t index = kInvalidIndex;
+    uint32_t generation = 0;
+
+    bool valid() const { return index != kInvalidIndex; }
+};
+
+/**
+ * @brief Slab allocator for the orders owned by an OrderBook.
+ *
+ * Orders live in fixed-size slabs that are never moved or freed while the pool
+ * exists, so intrusive links between them stay valid. Released slots go on a
+ * free list and are reused before another slab is requested from the memory
+ * resource. Not thread-safe; the owning book serializes access.
+ */
+class OrderPool {
+public:
+    OrderPool(size_t initial_capacity, std::pmr::memory_resource* resource);
+    ~OrderPool();
+
+    OrderPool(const OrderPool&) = delete;
+    OrderPool& operator=(const OrderPool&) = delete;
+
+    // Copy `order` into a free slot, growing by one slab if none is left
+    OrderHandle allocate(const Order& order);
+
+    // Return a slot to the free list; stale handles are ignored
+    void release(OrderHandle handle);
+
+    // The pooled order, or nullptr if the handle is stale
+    Order* get(OrderHandle handle);
+
+    size_t live() const { return live_; }
+    size_t capacity() const { return slabs_.size() * kSlabSize; }
+
+private:
+    static constexpr uint32_t kSlabShift = 12;
+    static constexpr uint32_t kSlabSize = 1u << kSlabShift;
+
+    struct Slot {
+        Order order;
+        uint32_t generation = 0;
+        uint32_t next_free = OrderHandle::kInvalidIndex;
+    };
+
+    Slot& slot(uint32_t index) { return slabs_[index >> kSlabShift][index & (kSlabSize - 1)]; }
+    void add_slab();
+
+    std::pmr::memory_resource* resource_;
+    std::pmr::vector<Slot*> slabs_;
+    uint32_t free_head_;
+    size_t live_;
+};
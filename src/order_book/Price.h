@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+// Prices inside the book are integer multiples of the instrument's tick size
+using Price = int64_t;
+
+inline Price to_ticks(double price, double tick_size) {
+    return static_cast<Price>(std::llround(price / tick_size));
+}
+
+inline double to_price(Price ticks, double tick_size) {
+    return static_cast<double>(ticks) * tick_size;
+}
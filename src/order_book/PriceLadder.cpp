@@ -0,0 +1,130 @@
+#include "PriceLadder.h"
+#include <algorithm>
+
+namespace {
+
+size_t round_up_pow2(size_t n) {
+    size_t size = 1;
+    while (size < n) {
+        size <<= 1;
+    }
+    return size;
+}
+
+} // namespace
+
+PriceLadder::PriceLadder(OrderSide side, size_t initial_levels, size_t max_levels,
+                         std::pmr::memory_resource* resource)
+    : side_(side),
+      // At least one full bitmap word so slot and bit arithmetic line up
+      levels_(round_up_pow2(std::max<size_t>(initial_levels, 64)), resource),
+      occupied_(levels_.size() / 64, 0, resource),
+      mask_(levels_.size() - 1),
+      max_levels_(std::max(round_up_pow2(max_levels), levels_.size())),
+      base_(0),
+      low_(0),
+      high_(0),
+      active_levels_(0) {}
+
+PriceLevel* PriceLadder::get_or_create(Price price) {
+    if (active_levels_ == 0) {
+        // Empty side: centre the band on the incoming price
+        base_ = price - static_cast<Price>(levels_.size() / 2);
+        low_ = high_ = price;
+    } else if (!in_window(price) && !make_room(price)) {
+        return nullptr;
+    }
+
+    PriceLevel& level = levels_[index_of(price)];
+    if (level.empty()) {
+        set_occupied(price);
+        ++active_levels_;
+        low_ = std::min(low_, price);
+        high_ = std::max(high_, price);
+    }
+    return &level;
+}
+
+void PriceLadder::erase_level(Price price) {
+    clear_occupied(price);
+    if (--active_levels_ == 0) {
+        return;
+    }
+    if (price == high_) {
+        high_ = prev_occupied(price);
+    } else if (price == low_) {
+        low_ = next_occupied(price);
+    }
+}
+
+Price PriceLadder::prev_occupied(Price price) const {
+    Price p = price - 1;
+    for (;;) {
+        const size_t index = index_of(p);
+        const unsigned bit = index & 63;
+        // Bits at or below `bit` in this word
+        const uint64_t bits = occupied_[index >> 6] & (~0ULL >> (63 - bit));
+        if (bits) {
+            const unsigned top = 63 - __builtin_clzll(bits);
+            return p - static_cast<Price>(bit - top);
+        }
+        // Slots and prices are congruent modulo the ring size, so this lands on
+        // the last bit of the previous word, wrapping around the ring if needed
+        p -= static_cast<Price>(bit) + 1;
+    }
+}
+
+Price PriceLadder::next_occupied(Price price) const {
+    Price p = price + 1;
+    for (;;) {
+        const size_t index = index_of(p);
+        const unsigned bit = index & 63;
+        const uint64_t bits = occupied_[index >> 6] & (~0ULL << bit);
+        if (bits) {
+            const unsigned low = __builtin_ctzll(bits);
+            return p + static_cast<Price>(low - bit);
+        }
+        p += static_cast<Price>(64 - bit);
+    }
+}
+
+bool PriceLadder::make_room(Price price) {
+    const Price low = std::min(low_, price);
+    const Price high = std::max(high_, price);
+    const size_t span = static_cast<size_t>(high - low) + 1;
+
+    if (span > levels_.size()) {
+        if (span > max_levels_) {
+            return false;
+        }
+        size_t new_size = levels_.size();
+        while (new_size < span * 2 && new_size < max_levels_) {
+            new_size <<= 1;
+        }
+        resize(new_size);
+    }
+
+    // Every slot outside [low, high] is empty, so recentring only moves the window
+    base_ = low - static_cast<Price>((levels_.size() - span) / 2);
+    return true;
+}
+
+void PriceLadder::resize(size_t new_size) {
+    std::pmr::vector<PriceLevel> levels(new_size, levels_.get_allocator());
+    std::pmr::vector<uint64_t> occupied(new_size / 64, 0, occupied_.get_allocator());
+    const size_t new_mask = new_size - 1;
+
+    Price price = low_;
+    for (size_t moved = 0; moved < active_levels_; ++moved) {
+        const size_t index = static_cast<size_t>(price) & new_mask;
+        levels[index] = levels_[index_of(price)];
+        occupied[index >> 6] |= 1ULL << (index & 63);
+        if (moved + 1 < active_levels_) {
+            price = next_occupied(price);
+        }
+    }
+
+    levels_.swap(levels);
+    occupied_.swap(occupied);
+    mask_ = new_mask;
+}
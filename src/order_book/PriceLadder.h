@@ -0,0 +1,107 @@
+#pragma once
+
+#include "PriceLevel.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+/**
+ * @brief One side of the book stored as a contiguous array of price levels.
+ *
+ * Levels live in a power-of-two ring addressed by `price & mask`, so any window
+ * of consecutive ticks maps to distinct slots. When an order lands outside the
+ * current window the window is recentred on the occupied range without moving
+ * any level; the ring only doubles when the occupied range itself stops fitting.
+ * The best price is tracked as an index and updated as levels fill and drain.
+ *
+ * An occupancy bitmap mirrors which slots hold orders, so stepping to the next
+ * occupied level skips empty ticks 64 at a time.
+ */
+class PriceLadder {
+public:
+    PriceLadder(OrderSide side, size_t initial_levels, size_t max_levels, std::pmr::memory_resource* resource);
+
+    // Level for `price`, recentring or growing the ladder if needed.
+    // Returns nullptr if the occupied range would exceed max_levels.
+    PriceLevel* get_or_create(Price price);
+
+    // Whether get_or_create(price) would succeed
+    bool can_hold(Price price) const {
+        return empty() || static_cast<size_t>(std::max(high_, price) - std::min(low_, price)) < max_levels_;
+    }
+
+    // Level for `price` if it lies inside the current window, nullptr otherwise
+    PriceLevel* find(Price price) { return in_window(price) ? &levels_[index_of(price)] : nullptr; }
+
+    // Must be called once a level returned by get_or_create() has been drained
+    void erase_level(Price price);
+
+    bool empty() const { return active_levels_ == 0; }
+    size_t level_count() const { return active_levels_; }
+    Price best_price() const { return side_ == OrderSide::BUY ? high_ : low_; }
+    PriceLevel& best_level() { return levels_[index_of(best_price())]; }
+    size_t capacity() const { return levels_.size(); }
+
+    // Resting quantity at prices no worse than `limit` (at or below it for asks,
+    // at or above it for bids), counting only until `wanted` is reached
+    uint64_t quantity_through(Price limit, uint64_t wanted) const {
+        uint64_t total = 0;
+        if (empty()) {
+            return total;
+        }
+        size_t visited = 0;
+        Price price = best_price();
+        while (side_ == OrderSide::BUY ? price >= limit : price <= limit) {
+            total += levels_[index_of(price)].total_quantity;
+            if (total >= wanted || ++visited == active_levels_) {
+                break;
+            }
+            price = (side_ == OrderSide::BUY) ? prev_occupied(price) : next_occupied(price);
+        }
+        return total;
+    }
+
+    // Visit up to max_levels non-empty levels from best to worst price
+    template <typename Fn>
+    void for_each_level(Fn&& fn, size_t max_levels = SIZE_MAX) const {
+        if (empty() || max_levels == 0) {
+            return;
+        }
+        size_t visited = 0;
+        Price price = best_price();
+        for (;;) {
+            fn(price, levels_[index_of(price)]);
+            if (++visited == max_levels || visited == active_levels_) {
+                return;
+            }
+            price = (side_ == OrderSide::BUY) ? prev_occupied(price) : next_occupied(price);
+        }
+    }
+
+private:
+    size_t index_of(Price price) const { return static_cast<size_t>(price) & mask_; }
+    bool in_window(Price price) const {
+        return price >= base_ && static_cast<size_t>(price - base_) < levels_.size();
+    }
+    void set_occupied(Price price) { occupied_[index_of(price) >> 6] |= 1ULL << (index_of(price) & 63); }
+    void clear_occupied(Price price) { occupied_[index_of(price) >> 6] &= ~(1ULL << (index_of(price) & 63)); }
+
+    // Nearest occupied price strictly below/above `price`; one must exist
+    Price prev_occupied(Price price) const;
+    Price next_occupied(Price price) const;
+
+    bool make_room(Price price);
+    void resize(size_t new_size);
+
+    OrderSide side_;
+    std::pmr::vector<PriceLevel> levels_;
+    std::pmr::vector<uint64_t> occupied_; // One bit per slot of levels_
+    size_t mask_;
+    size_t max_levels_;
+    Price base_;   // Lowest price covered by the current window
+    Price low_;    // Lowest occupied price, valid while non-empty
+    Price high_;   // Highest occupied price, valid while non-empty
+    size_t active_levels_;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Order.h"
+#include <cstdint>
+
+/**
+ * @brief FIFO of resting orders at a single price.
+ *
+ * The queue links live inside Order, so an order can be unlinked from the
+ * middle of its level in O(1). total_quantity (the sum of remaining quantity
+ * across the level) and order_count are kept current on every add, fill and
+ * cancel, so depth queries never have to walk the queue.
+ */
+struct PriceLevel {
+    Order* head = nullptr;
+    Order* tail = nullptr;
+    uint64_t total_quantity = 0;
+    uint32_t order_count = 0;
+
+    bool empty() const { return head == nullptr; }
+    Order* front() const { return head; }
+
+    void push_back(Order* order) {
+        order->prev = tail;
+        order->next = nullptr;
+        if (tail) {
+            tail->next = order;
+        } else {
+            head = order;
+        }
+        tail = order;
+        total_quantity += order->remaining_quantity;
+        ++order_count;
+    }
+
+    void erase(Order* order) {
+        if (order->prev) {
+            order->prev->next = order->next;
+        } else {
+            head = order->next;
+        }
+        if (order->next) {
+            order->next->prev = order->prev;
+        } else {
+            tail = order->prev;
+        }
+        order->prev = order->next = nullptr;
+        total_quantity -= order->remaining_quantity;
+        --order_count;
+    }
+
+    void pop_front() { erase(head); }
+};
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "common/SymbolTable.h"
+
+// A book's best bid and ask after either price changed, as published to quote
+// subscribers. A side with no orders has no price.
+struct QuoteUpdate {
+    SymbolId symbol_id = 0;
+    double best_bid = 0.0;
+    double best_ask = 0.0;
+    bool has_bid = false;
+    bool has_ask = false;
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "Order.h"
+#include <cstdint>
+
+// Quantity self-trade prevention took off one order instead of trading it.
+// The order is gone from the book once its remaining quantity reaches zero.
+struct SelfTradeCancel {
+    uint64_t order_id = 0;
+    SymbolId symbol_id = 0;
+    AccountId account_id = 0;
+    OrderSide side = OrderSide::BUY;
+    bool resting = false; // False for the incoming order, whose remainder never rests
+    uint64_t quantity = 0;
+};
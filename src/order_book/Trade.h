@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Order.h"
 #include <cstdint>
 #include <chrono>
 
@@ -11,6 +12,15 @@ struct Trade {
     uint64_t quantity;
     std::chrono::system_clock::time_point timestamp;
 
+    // Filled in by the book from the two orders, so consumers can attribute
+    // the fill without looking either order up
+    SymbolId symbol_id = 0;
+    OrderSide aggressor_side = OrderSide::BUY;
+    AccountId resting_account = 0;
+    AccountId aggressive_account = 0;
+
+    Trade() = default;
+
     Trade(uint64_t t_id, uint64_t r_id, uint64_t a_id, double p, uint64_t q)
         : trade_id(t_id),
           resting_order_id(r_id),
@@ -18,4 +28,7 @@ struct Trade {
           price(p),
           quantity(q),
           timestamp(std::chrono::system_clock::now()) {}
+
+    AccountId buyer() const { return aggressor_side == OrderSide::BUY ? aggressive_account : resting_account; }
+    AccountId seller() const { return aggressor_side == OrderSide::SELL ? aggressive_account : resting_account; }
 };
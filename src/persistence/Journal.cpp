@@ -0,0 +1,265 @@
+#include "Journal.h"
+#include "common/Logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char kMagic[8] = {'T', 'R', 'D', 'J', 'R', 'N', 'L', '\0'};
+constexpr uint32_t kVersion = 1;
+// Records start on their own page so syncs never touch the header
+constexpr size_t kHeaderBytes = 4096;
+
+struct JournalHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+};
+
+size_t page_size() {
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+} // namespace
+
+Journal::Journal(const JournalConfig& config) : config_(config) {}
+
+Journal::~Journal() {
+    close();
+}
+
+bool Journal::open(const std::string& path, std::string& error) {
+    if (is_open()) {
+        error = "journal already open";
+        return false;
+    }
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) {
+        error = "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd_, &st) != 0) {
+        error = "cannot stat " + path + ": " + std::strerror(errno);
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    const size_t file_bytes = static_cast<size_t>(st.st_size);
+    const bool fresh = file_bytes == 0;
+    const size_t existing = file_bytes > kHeaderBytes ? (file_bytes - kHeaderBytes) / sizeof(JournalRecord) : 0;
+    if (!map(std::max(existing, std::max<size_t>(config_.initial_records, 1)), error)) {
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    JournalHeader* header = static_cast<JournalHeader*>(mapping_);
+    if (fresh) {
+        std::memcpy(header->magic, kMagic, sizeof(kMagic));
+        header->version = kVersion;
+        header->record_size = sizeof(JournalRecord);
+        msync(mapping_, kHeaderBytes, MS_SYNC);
+    } else if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 || header->version != kVersion ||
+               header->record_size != sizeof(JournalRecord)) {
+        error = path + " is not a compatible journal";
+        close();
+        return false;
+    }
+
+    count_ = 0;
+    while (count_ < capacity_ && records_[count_].sequence == count_ + 1) {
+        ++count_;
+    }
+    // Clear anything past the end (a torn tail) so later scans cannot pick it up
+    for (uint64_t i = count_; i < capacity_ && records_[i].sequence != 0; ++i) {
+        std::memset(&records_[i], 0, sizeof(JournalRecord));
+    }
+    written_.store(count_, std::memory_order_release);
+    synced_ = count_;
+
+    stopping_ = false;
+    flusher_ = std::thread(&Journal::flush_loop, this);
+    return true;
+}
+
+void Journal::close() {
+    if (flusher_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(flush_mutex_);
+            stopping_ = true;
+        }
+        flush_cv_.notify_one();
+        flusher_.join();
+    }
+    if (is_open()) {
+        sync();
+        unmap();
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    count_ = 0;
+    written_.store(0, std::memory_order_relaxed);
+    synced_ = 0;
+}
+
+void Journal::append_symbol(SymbolId symbol_id, std::string_view name) {
+    JournalRecord* slot = next_slot();
+    if (!slot) {
+        return;
+    }
+    slot->type = JournalRecordType::SYMBOL;
+    slot->symbol_id = symbol_id;
+    const size_t length = std::min(name.size(), JournalRecord::kMaxSymbolName);
+    std::memcpy(slot->body.symbol_name, name.data(), length);
+    slot->body.symbol_name[length] = '\0';
+    publish(*slot);
+}
+
+void Journal::append_order(const Order& order) {
+    JournalRecord* slot = next_slot();
+    if (!slot) {
+        return;
+    }
+    slot->type = JournalRecordType::ORDER;
+    slot->side = static_cast<uint8_t>(order.side);
+    slot->order_type = static_cast<uint8_t>(order.type);
+    slot->time_in_force = static_cast<uint8_t>(order.time_in_force);
+    slot->symbol_id = order.symbol_id;
+    slot->body.order = JournalRecord::OrderFields{order.id, order.price, order.quantity, order.account_id,
+                                                  order.self_trade_prevention};
+    publish(*slot);
+}
+
+void Journal::append_cancel(SymbolId symbol_id, uint64_t order_id) {
+    JournalRecord* slot = next_slot();
+    if (!slot) {
+        return;
+    }
+    slot->type = JournalRecordType::CANCEL;
+    slot->symbol_id = symbol_id;
+    slot->body.order = JournalRecord::OrderFields{order_id, 0, 0, 0, SelfTradePrevention::NONE};
+    publish(*slot);
+}
+
+void Journal::append_modify(SymbolId symbol_id, uint64_t order_id, Price price, uint64_t quantity) {
+    JournalRecord* slot = next_slot();
+    if (!slot) {
+        return;
+    }
+    slot->type = JournalRecordType::MODIFY;
+    slot->symbol_id = symbol_id;
+    slot->body.order = JournalRecord::OrderFields{order_id, price, quantity, 0, SelfTradePrevention::NONE};
+    publish(*slot);
+}
+
+void Journal::append_trade(const Trade& trade) {
+    JournalRecord* slot = next_slot();
+    if (!slot) {
+        return;
+    }
+    slot->type = JournalRecordType::TRADE;
+    slot->side = static_cast<uint8_t>(trade.aggressor_side);
+    slot->symbol_id = trade.symbol_id;
+    slot->body.trade = JournalRecord::TradeFields{trade.trade_id, trade.resting_order_id, trade.aggressive_order_id,
+                                                  trade.price, trade.quantity, trade.resting_account,
+                                                  trade.aggressive_account};
+    publish(*slot);
+}
+
+void Journal::sync() {
+    std::lock_guard<std::mutex> lock(map_mutex_);
+    sync_locked();
+}
+
+JournalRecord* Journal::next_slot() {
+    if (!is_open()) {
+        return nullptr;
+    }
+    if (count_ == capacity_) {
+        // The only place the writer blocks or calls into the kernel
+        std::lock_guard<std::mutex> lock(map_mutex_);
+        std::string error;
+        if (!map(capacity_ * 2, error)) {
+            LOG_ERROR("[JOURNAL] Cannot grow journal, dropping record: %s", error.c_str());
+            return nullptr;
+        }
+    }
+    JournalRecord* slot = &records_[count_];
+    std::memset(slot, 0, sizeof(JournalRecord));
+    return slot;
+}
+
+void Journal::publish(JournalRecord& slot) {
+    // The sequence goes in last so a reader never accepts a half-written record
+    __atomic_store_n(&slot.sequence, count_ + 1, __ATOMIC_RELEASE);
+    ++count_;
+    written_.store(count_, std::memory_order_release);
+}
+
+bool Journal::map(size_t capacity, std::string& error) {
+    const size_t bytes = kHeaderBytes + capacity * sizeof(JournalRecord);
+    if (ftruncate(fd_, static_cast<off_t>(bytes)) != 0) {
+        error = std::string("cannot size journal: ") + std::strerror(errno);
+        return false;
+    }
+    int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    // Fault the pages in now rather than on the matching thread
+    flags |= MAP_POPULATE;
+#endif
+    void* mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, flags, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        error = std::string("cannot map journal: ") + std::strerror(errno);
+        return false;
+    }
+    unmap();
+    mapping_ = mapping;
+    mapping_bytes_ = bytes;
+    records_ = reinterpret_cast<JournalRecord*>(static_cast<char*>(mapping) + kHeaderBytes);
+    capacity_ = capacity;
+    return true;
+}
+
+void Journal::unmap() {
+    if (mapping_) {
+        munmap(mapping_, mapping_bytes_);
+    }
+    mapping_ = nullptr;
+    mapping_bytes_ = 0;
+    records_ = nullptr;
+    capacity_ = 0;
+}
+
+void Journal::sync_locked() {
+    const uint64_t written = written_.load(std::memory_order_acquire);
+    if (!mapping_ || written <= synced_) {
+        return;
+    }
+    const size_t begin = kHeaderBytes + synced_ * sizeof(JournalRecord);
+    const size_t end = kHeaderBytes + written * sizeof(JournalRecord);
+    const size_t aligned_begin = begin & ~(page_size() - 1);
+    if (msync(static_cast<char*>(mapping_) + aligned_begin, end - aligned_begin, MS_SYNC) != 0) {
+        LOG_ERROR("[JOURNAL] msync failed: %s", std::strerror(errno));
+        return;
+    }
+    synced_ = written;
+}
+
+void Journal::flush_loop() {
+    std::unique_lock<std::mutex> lock(flush_mutex_);
+    while (!stopping_) {
+        flush_cv_.wait_for(lock, config_.flush_interval, [this]() { return stopping_; });
+        lock.unlock();
+        sync();
+        lock.lock();
+    }
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "order_book/Order.h"
+#include "order_book/Trade.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+enum class JournalRecordType : uint8_t {
+    SYMBOL = 1, // Binds a journal symbol id to a name
+    ORDER = 2,  // New order as received by the matching thread
+    CANCEL = 3,
+    TRADE = 4,
+    MODIFY = 5  // New price and remaining quantity of a resting order
+};
+
+// Fixed 64-byte journal entry; one cache line per event
+struct JournalRecord {
+    struct OrderFields {
+        uint64_t order_id;
+        Price price; // Ticks
+        uint64_t quantity;
+        AccountId account_id;
+        SelfTradePrevention self_trade_prevention;
+    };
+    struct TradeFields {
+        uint64_t trade_id;
+        uint64_t resting_order_id;
+        uint64_t aggressive_order_id;
+        double price;
+        uint64_t quantity;
+        AccountId resting_account;
+        AccountId aggressive_account;
+    };
+    static constexpr size_t kMaxSymbolName = 47;
+
+    uint64_t sequence; // Index + 1, stored last; zero marks the end of the journal
+    JournalRecordType type;
+    uint8_t side;       // OrderSide; aggressor side for trades
+    uint8_t order_type; // OrderType
+    uint8_t time_in_force; // TimeInForce
+    SymbolId symbol_id;
+    union {
+        OrderFields order;
+        TradeFields trade;
+        char symbol_name[kMaxSymbolName + 1];
+    } body;
+};
+static_assert(sizeof(JournalRecord) == 64, "journal records must stay one cache line");
+
+struct JournalConfig {
+    // Records the file is sized for up front; it doubles when full
+    size_t initial_records = 1 << 20;
+    // How often the background thread msyncs newly appended records
+    std::chrono::milliseconds flush_interval{5};
+};
+
+/**
+ * @brief Append-only, memory-mapped event journal with a single writer.
+ *
+ * Appends copy a record into the mapping and publish it by storing its
+ * sequence number, so the writer makes no system calls until the file has to
+ * grow. A background thread msyncs whatever was appended since its last pass.
+ * On open, the records already in the file are scanned up to the first slot
+ * whose sequence does not follow on, which also drops a record torn by a crash.
+ */
+class Journal {
+public:
+    explicit Journal(const JournalConfig& config = JournalConfig());
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    // Open or create the journal at `path` and start the flush thread.
+    // Appends continue after the last valid record.
+    bool open(const std::string& path, std::string& error);
+
+    // Sync everything appended and release the file
+    void close();
+
+    bool is_open() const { return records_ != nullptr; }
+
+    // Writer side; all appends must come from one thread
+    void append_symbol(SymbolId symbol_id, std::string_view name);
+    void append_order(const Order& order);
+    void append_cancel(SymbolId symbol_id, uint64_t order_id);
+    void append_modify(SymbolId symbol_id, uint64_t order_id, Price price, uint64_t quantity);
+    void append_trade(const Trade& trade);
+
+    // Block until every record appended so far has reached the file
+    void sync();
+
+    uint64_t size() const { return count_; }
+
+    // Visit every record in order. Not safe to call concurrently with appends.
+    template <typename Fn>
+    void for_each(Fn&& fn) const {
+        for (uint64_t i = 0; i < count_; ++i) {
+            fn(records_[i]);
+        }
+    }
+
+private:
+    JournalRecord* next_slot();
+    void publish(JournalRecord& slot);
+    bool map(size_t capacity, std::string& error);
+    void unmap();
+    void sync_locked();
+    void flush_loop();
+
+    JournalConfig config_;
+    int fd_ = -1;
+    void* mapping_ = nullptr;
+    size_t mapping_bytes_ = 0;
+    JournalRecord* records_ = nullptr;
+    size_t capacity_ = 0;
+
+    // Writer-owned count; written_ publishes it to the flush thread
+    uint64_t count_ = 0;
+    std::atomic<uint64_t> written_{0};
+
+    // Held by the flush thread while it syncs and by the writer while it remaps
+    std::mutex map_mutex_;
+    uint64_t synced_ = 0;
+
+    std::mutex flush_mutex_;
+    std::condition_variable flush_cv_;
+    bool stopping_ = false;
+    std::thread flusher_;
+};
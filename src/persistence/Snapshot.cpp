@@ -0,0 +1,247 @@
+#include "Snapshot.h"
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <unistd.h>
+
+namespace {
+
+constexpr char kMagic[8] = {'T', 'R', 'D', 'S', 'N', 'A', 'P', '\0'};
+constexpr uint32_t kVersion = 4;
+
+uint64_t fnv1a(const char* data, size_t size) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Fields are stored in host (little-endian) order, as in the journal
+class Encoder {
+public:
+    template <typename T>
+    void put(T value) {
+        static_assert(std::is_trivially_copyable_v<T>, "encode fields one at a time");
+        out_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    void put(const std::string& value) {
+        put(static_cast<uint32_t>(value.size()));
+        out_.append(value);
+    }
+    const std::string& bytes() const { return out_; }
+
+private:
+    std::string out_;
+};
+
+class Decoder {
+public:
+    Decoder(const char* data, size_t size) : pos_(data), end_(data + size) {}
+
+    template <typename T>
+    bool get(T& value) {
+        if (static_cast<size_t>(end_ - pos_) < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+    bool get(std::string& value) {
+        uint32_t size;
+        if (!get(size) || static_cast<size_t>(end_ - pos_) < size) {
+            return false;
+        }
+        value.assign(pos_, size);
+        pos_ += size;
+        return true;
+    }
+    // Guards reserve() against a corrupt count
+    bool has(uint64_t count, size_t min_bytes) const {
+        return count <= static_cast<size_t>(end_ - pos_) / min_bytes;
+    }
+    bool done() const { return pos_ == end_; }
+
+private:
+    const char* pos_;
+    const char* end_;
+};
+
+constexpr size_t kOrderBytes = 8 + 4 + 1 + 1 + 8 + 8 + 8 + 8;
+
+void encode_order(Encoder& out, const Order& order) {
+    out.put(order.id);
+    out.put(order.account_id);
+    out.put(static_cast<uint8_t>(order.side));
+    // A restored order re-entering the matching loop through a modify keeps its mode
+    out.put(static_cast<uint8_t>(order.self_trade_prevention));
+    out.put(order.price);
+    out.put(order.quantity);
+    out.put(order.remaining_quantity);
+    // Kept so restored orders keep their time priority against later ones
+    out.put(static_cast<int64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(order.timestamp.time_since_epoch()).count()));
+}
+
+bool decode_order(Decoder& in, Order& order) {
+    uint8_t side;
+    uint8_t self_trade_prevention;
+    int64_t timestamp_ns;
+    if (!in.get(order.id) || !in.get(order.account_id) || !in.get(side) || !in.get(self_trade_prevention) ||
+        !in.get(order.price) || !in.get(order.quantity) || !in.get(order.remaining_quantity) ||
+        !in.get(timestamp_ns) || side > 1 ||
+        self_trade_prevention > static_cast<uint8_t>(SelfTradePrevention::DECREMENT)) {
+        return false;
+    }
+    order.symbol_id = 0;
+    order.type = OrderType::LIMIT;
+    order.side = static_cast<OrderSide>(side);
+    order.self_trade_prevention = static_cast<SelfTradePrevention>(self_trade_prevention);
+    order.timestamp = std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(timestamp_ns)));
+    return true;
+}
+
+bool decode_payload(Decoder& in, Snapshot& snapshot) {
+    uint32_t shards;
+    if (!in.get(shards) || !in.has(shards, sizeof(uint64_t))) {
+        return false;
+    }
+    snapshot.journal_segments.resize(shards);
+    for (uint64_t& segment : snapshot.journal_segments) {
+        if (!in.get(segment)) {
+            return false;
+        }
+    }
+    uint32_t books;
+    if (!in.get(snapshot.max_order_id) || !in.get(books) || !in.has(books, sizeof(uint32_t))) {
+        return false;
+    }
+    snapshot.books.resize(books);
+    for (Snapshot::Book& book : snapshot.books) {
+        uint64_t orders;
+        if (!in.get(book.symbol) || !in.get(book.state.next_trade_id) || !in.get(orders) ||
+            !in.has(orders, kOrderBytes)) {
+            return false;
+        }
+        book.state.orders.resize(orders);
+        for (Order& order : book.state.orders) {
+            if (!decode_order(in, order)) {
+                return false;
+            }
+        }
+    }
+    uint32_t positions;
+    if (!in.get(positions) || !in.has(positions, sizeof(uint32_t))) {
+        return false;
+    }
+    snapshot.positions.resize(positions);
+    for (Position& pos : snapshot.positions) {
+        if (!in.get(pos.account_id) || !in.get(pos.symbol) || !in.get(pos.net_position) || !in.get(pos.avg_entry_price) ||
+            !in.get(pos.realized_pnl)) {
+            return false;
+        }
+    }
+    return in.done();
+}
+
+} // namespace
+
+bool write_snapshot(const std::string& path, const Snapshot& snapshot, std::string& error) {
+    Encoder payload;
+    payload.put(static_cast<uint32_t>(snapshot.journal_segments.size()));
+    for (uint64_t segment : snapshot.journal_segments) {
+        payload.put(segment);
+    }
+    payload.put(snapshot.max_order_id);
+    payload.put(static_cast<uint32_t>(snapshot.books.size()));
+    for (const Snapshot::Book& book : snapshot.books) {
+        payload.put(book.symbol);
+        payload.put(book.state.next_trade_id);
+        payload.put(static_cast<uint64_t>(book.state.orders.size()));
+        for (const Order& order : book.state.orders) {
+            encode_order(payload, order);
+        }
+    }
+    payload.put(static_cast<uint32_t>(snapshot.positions.size()));
+    for (const Position& pos : snapshot.positions) {
+        payload.put(pos.account_id);
+        payload.put(pos.symbol);
+        payload.put(pos.net_position);
+        payload.put(pos.avg_entry_price);
+        payload.put(pos.realized_pnl);
+    }
+
+    const std::string& bytes = payload.bytes();
+    const uint64_t checksum = fnv1a(bytes.data(), bytes.size());
+    const std::string temp_path = path + ".tmp";
+    FILE* file = std::fopen(temp_path.c_str(), "wb");
+    if (!file) {
+        error = "cannot create " + temp_path + ": " + std::strerror(errno);
+        return false;
+    }
+    const bool written = std::fwrite(kMagic, sizeof(kMagic), 1, file) == 1 &&
+                         std::fwrite(&kVersion, sizeof(kVersion), 1, file) == 1 &&
+                         std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size() &&
+                         std::fwrite(&checksum, sizeof(checksum), 1, file) == 1 && std::fflush(file) == 0 &&
+                         fsync(fileno(file)) == 0;
+    const int write_errno = errno;
+    std::fclose(file);
+    if (!written) {
+        error = "cannot write " + temp_path + ": " + std::strerror(write_errno);
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        error = "cannot replace " + path + ": " + std::strerror(errno);
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool read_snapshot(const std::string& path, Snapshot& snapshot, std::string& error) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        error = "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    std::string contents;
+    char buffer[1 << 16];
+    size_t read;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        contents.append(buffer, read);
+    }
+    std::fclose(file);
+
+    constexpr size_t header_bytes = sizeof(kMagic) + sizeof(kVersion);
+    uint32_t version = 0;
+    if (contents.size() >= header_bytes) {
+        std::memcpy(&version, contents.data() + sizeof(kMagic), sizeof(version));
+    }
+    if (contents.size() < header_bytes + sizeof(uint64_t) ||
+        std::memcmp(contents.data(), kMagic, sizeof(kMagic)) != 0 || version != kVersion) {
+        error = path + " is not a compatible snapshot";
+        return false;
+    }
+    const char* payload = contents.data() + header_bytes;
+    const size_t payload_bytes = contents.size() - header_bytes - sizeof(uint64_t);
+    uint64_t checksum;
+    std::memcpy(&checksum, payload + payload_bytes, sizeof(checksum));
+    if (fnv1a(payload, payload_bytes) != checksum) {
+        error = path + " failed its checksum";
+        return false;
+    }
+
+    Decoder in(payload, payload_bytes);
+    snapshot = Snapshot();
+    if (!decode_payload(in, snapshot)) {
+        error = path + " is truncated or malformed";
+        return false;
+    }
+    return true;
+}
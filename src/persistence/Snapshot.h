@@ -0,0 +1,35 @@
+#pragma once
+
+#include "order_book/OrderBook.h"
+#include "risk/RiskEngine.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Engine state at one point in the journals.
+ *
+ * Books are keyed by symbol name so a snapshot can be loaded by a process
+ * that registers its symbols in a different order. Each shard starts a new
+ * journal segment as the snapshot is taken; journal_segments holds, per shard,
+ * that segment's number, so recovery replays only that segment and any after
+ * it.
+ */
+struct Snapshot {
+    struct Book {
+        std::string symbol;
+        BookSnapshot state;
+    };
+
+    std::vector<uint64_t> journal_segments;
+    uint64_t max_order_id = 0;
+    std::vector<Book> books;
+    std::vector<Position> positions;
+};
+
+// Serialize `snapshot` to `path`. The file is written beside it and renamed
+// into place, so a crash mid-write leaves the previous snapshot intact.
+bool write_snapshot(const std::string& path, const Snapshot& snapshot, std::string& error);
+
+// Load a snapshot written by write_snapshot(), verifying its checksum
+bool read_snapshot(const std::string& path, Snapshot& snapshot, std::string& error);
@@ -0,0 +1,218 @@
+#include "OrderFlow.h"
+#include <charconv>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+namespace {
+
+// Splits the next comma-separated field off `line`
+std::string_view next_field(std::string_view& line) {
+    const size_t comma = line.find(',');
+    std::string_view field = line.substr(0, comma);
+    line = (comma == std::string_view::npos) ? std::string_view() : line.substr(comma + 1);
+    return field;
+}
+
+template <typename T>
+bool parse_number(std::string_view text, T& value) {
+    const char* end = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), end, value);
+    return ec == std::errc() && ptr == end;
+}
+
+constexpr char kModeCodes[] = {'N', 'R', 'A', 'B', 'D'}; // Indexed by SelfTradePrevention
+
+bool parse_mode(std::string_view text, SelfTradePrevention& mode) {
+    for (size_t i = 0; i < sizeof(kModeCodes); ++i) {
+        if (text.size() == 1 && text[0] == kModeCodes[i]) {
+            mode = static_cast<SelfTradePrevention>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parse_line(std::string_view line, double tick_size, OrderCommand& command) {
+    const std::string_view kind = next_field(line);
+    uint64_t order_id;
+    if (!parse_number(next_field(line), order_id)) {
+        return false;
+    }
+    const std::string_view symbol = next_field(line);
+    if (symbol.empty()) {
+        return false;
+    }
+    const SymbolId symbol_id = SymbolTable::instance().intern(symbol);
+
+    if (kind == "C") {
+        command = OrderCommand::cancel(symbol_id, order_id);
+        return line.empty();
+    }
+    if (kind == "M") {
+        double price;
+        uint64_t quantity;
+        if (!parse_number(next_field(line), price) || !parse_number(next_field(line), quantity) || !line.empty()) {
+            return false;
+        }
+        command = OrderCommand::modify(symbol_id, order_id, to_ticks(price, tick_size), quantity);
+        return true;
+    }
+    if (kind != "N") {
+        return false;
+    }
+
+    const std::string_view side = next_field(line);
+    double price;
+    uint64_t quantity;
+    if ((side != "B" && side != "S") || !parse_number(next_field(line), price) ||
+        !parse_number(next_field(line), quantity)) {
+        return false;
+    }
+    Order order(order_id, symbol_id, OrderType::LIMIT, side == "B" ? OrderSide::BUY : OrderSide::SELL,
+                to_ticks(price, tick_size), quantity);
+    if (!line.empty() && (!parse_number(next_field(line), order.account_id) ||
+                          !parse_mode(next_field(line), order.self_trade_prevention) || !line.empty())) {
+        return false;
+    }
+    command = OrderCommand::new_order(order);
+    return true;
+}
+
+} // namespace
+
+bool load_order_flow(const std::string& path, double tick_size, std::vector<OrderCommand>& out, std::string& error) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    const std::string text = contents.str();
+
+    std::string_view rest(text);
+    size_t line_number = 0;
+    while (!rest.empty()) {
+        const size_t newline = rest.find('\n');
+        std::string_view line = rest.substr(0, newline);
+        rest = (newline == std::string_view::npos) ? std::string_view() : rest.substr(newline + 1);
+        ++line_number;
+
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+        OrderCommand command;
+        if (!parse_line(line, tick_size, command)) {
+            error = path + ":" + std::to_string(line_number) + ": malformed event";
+            return false;
+        }
+        out.push_back(command);
+    }
+    return true;
+}
+
+bool save_order_flow(const std::string& path, double tick_size, const std::vector<OrderCommand>& commands) {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        return false;
+    }
+    std::fprintf(file, "# kind,order_id,symbol[,side][,price,quantity][,account,stp]\n");
+    for (const OrderCommand& command : commands) {
+        const char* symbol = SymbolTable::instance().name(command.symbol_id).c_str();
+        if (command.type == CommandType::CANCEL) {
+            std::fprintf(file, "C,%llu,%s\n", static_cast<unsigned long long>(command.order_id), symbol);
+        } else if (command.type == CommandType::MODIFY) {
+            std::fprintf(file, "M,%llu,%s,%.10g,%llu\n", static_cast<unsigned long long>(command.order_id), symbol,
+                         to_price(command.price, tick_size), static_cast<unsigned long long>(command.quantity));
+        } else {
+            std::fprintf(file, "N,%llu,%s,%c,%.10g,%llu,%u,%c\n", static_cast<unsigned long long>(command.order_id),
+                         symbol, command.side == OrderSide::BUY ? 'B' : 'S', to_price(command.price, tick_size),
+                         static_cast<unsigned long long>(command.quantity), command.account_id,
+                         kModeCodes[static_cast<size_t>(command.self_trade_prevention)]);
+        }
+    }
+    return std::fclose(file) == 0;
+}
+
+std::vector<OrderCommand> generate_order_flow(size_t count, uint64_t seed, const std::vector<std::string>& symbols) {
+    std::mt19937_64 rng(seed);
+    std::vector<SymbolId> ids;
+    std::vector<Price> mids;
+    for (const std::string& symbol : symbols) {
+        ids.push_back(SymbolTable::instance().intern(symbol));
+        mids.push_back(100000);
+    }
+    struct LiveOrder {
+        size_t symbol;
+        uint64_t order_id;
+        OrderSide side;
+    };
+    std::vector<LiveOrder> live;
+
+    std::vector<OrderCommand> commands;
+    commands.reserve(count);
+    uint64_t next_id = 1;
+    while (commands.size() < count) {
+        const size_t s = rng() % ids.size();
+        const uint64_t roll = rng() % 100;
+
+        if (roll < 30 && !live.empty()) {
+            const size_t victim = rng() % live.size();
+            commands.push_back(OrderCommand::cancel(ids[live[victim].symbol], live[victim].order_id));
+            live[victim] = live.back();
+            live.pop_back();
+            continue;
+        }
+        // Quoting-style amends: a new passive price and size on the same side
+        if (roll < 45 && !live.empty()) {
+            const LiveOrder& target = live[rng() % live.size()];
+            const Price offset = static_cast<Price>(1 + rng() % 50);
+            const Price mid = mids[target.symbol];
+            const Price price = (target.side == OrderSide::BUY) ? mid - offset : mid + offset;
+            commands.push_back(OrderCommand::modify(ids[target.symbol], target.order_id, price, 1 + rng() % 100));
+            continue;
+        }
+
+        mids[s] += static_cast<Price>(rng() % 3) - 1;
+        const OrderSide side = (rng() & 1) ? OrderSide::BUY : OrderSide::SELL;
+        // One order in ten crosses the spread; the rest rest up to 50 ticks away
+        const Price offset = (roll < 55) ? -static_cast<Price>(rng() % 5) : static_cast<Price>(1 + rng() % 50);
+        const Price price = (side == OrderSide::BUY) ? mids[s] - offset : mids[s] + offset;
+        const uint64_t quantity = 1 + rng() % 100;
+
+        Order order(next_id, ids[s], OrderType::LIMIT, side, price, quantity);
+        order.account_id = static_cast<AccountId>(1 + rng() % 4);
+        order.self_trade_prevention = static_cast<SelfTradePrevention>(rng() % sizeof(kModeCodes));
+        commands.push_back(OrderCommand::new_order(order));
+        live.push_back(LiveOrder{s, next_id++, side});
+    }
+    return commands;
+}
+
+void TradeChecksum::add(const Trade& trade) {
+    mix(&trade.trade_id, sizeof(trade.trade_id));
+    mix(&trade.resting_order_id, sizeof(trade.resting_order_id));
+    mix(&trade.aggressive_order_id, sizeof(trade.aggressive_order_id));
+    mix(&trade.price, sizeof(trade.price));
+    mix(&trade.quantity, sizeof(trade.quantity));
+    mix(&trade.symbol_id, sizeof(trade.symbol_id));
+    mix(&trade.aggressor_side, sizeof(trade.aggressor_side));
+    mix(&trade.resting_account, sizeof(trade.resting_account));
+    mix(&trade.aggressive_account, sizeof(trade.aggressive_account));
+    ++count_;
+}
+
+void TradeChecksum::mix(const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash_ ^= bytes[i];
+        hash_ *= 1099511628211ULL;
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "order_book/OrderCommand.h"
+#include "order_book/Trade.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Recorded order flow in a line-based text format.
+ *
+ *     # comment
+ *     N,<order_id>,<symbol>,<B|S>,<price>,<quantity>[,<account>,<stp>]
+ *     C,<order_id>,<symbol>
+ *     M,<order_id>,<symbol>,<price>,<quantity>
+ *
+ * Prices are decimal and converted to ticks of `tick_size` on load; symbols
+ * are interned as they are first seen. The self-trade prevention mode is one
+ * letter: N(one), R(esting), A(ggressor), B(oth) or D(ecrement); orders
+ * without the two trailing fields belong to account 0 with no prevention. A
+ * modify gives the order's new price and remaining quantity.
+ */
+bool load_order_flow(const std::string& path, double tick_size, std::vector<OrderCommand>& out, std::string& error);
+bool save_order_flow(const std::string& path, double tick_size, const std::vector<OrderCommand>& commands);
+
+// Deterministic synthetic flow for `symbols`: resting and crossing limit orders
+// around a drifting mid price from a few accounts with mixed self-trade
+// prevention modes, plus cancels and reprices of random live orders
+std::vector<OrderCommand> generate_order_flow(size_t count, uint64_t seed, const std::vector<std::string>& symbols);
+
+/**
+ * @brief Order-sensitive FNV-1a hash of a trade stream.
+ *
+ * Covers every field except the wall-clock timestamp, so two replays of the
+ * same flow produce the same value exactly when they produce the same trades.
+ */
+class TradeChecksum {
+public:
+    void add(const Trade& trade);
+
+    uint64_t value() const { return hash_; }
+    uint64_t count() const { return count_; }
+
+private:
+    void mix(const void* data, size_t size);
+
+    uint64_t hash_ = 14695981039346656037ULL;
+    uint64_t count_ = 0;
+};
@@ -0,0 +1,60 @@
+#include "MarkToMarket.h"
+#include <algorithm>
+#include <cmath>
+
+MarkToMarket::MarkToMarket(size_t max_symbols)
+    : marks_(max_symbols),
+      published_marks_(std::make_unique<Seqlock<SymbolMark>[]>(max_symbols)) {}
+
+void MarkToMarket::on_quote(const QuoteUpdate& quote) {
+    if (quote.symbol_id >= marks_.size() || !(quote.has_bid || quote.has_ask)) {
+        return; // An empty book leaves the last mark in place
+    }
+    SymbolMark& mark = marks_[quote.symbol_id];
+    mark.mark_price = quote.has_bid && quote.has_ask ? (quote.best_bid + quote.best_ask) / 2.0
+                    : quote.has_bid                  ? quote.best_bid
+                                                     : quote.best_ask;
+    revalue(quote.symbol_id, mark);
+}
+
+void MarkToMarket::on_position(SymbolId symbol_id, const Position& position) {
+    if (symbol_id >= marks_.size()) {
+        return;
+    }
+    SymbolMark& mark = marks_[symbol_id];
+    portfolio_.realized_pnl += position.realized_pnl - mark.realized_pnl;
+    mark.net_position = position.net_position;
+    mark.avg_entry_price = position.avg_entry_price;
+    mark.realized_pnl = position.realized_pnl;
+    revalue(symbol_id, mark);
+}
+
+SymbolMark MarkToMarket::symbol(SymbolId symbol_id) const {
+    return symbol_id < marks_.size() ? published_marks_[symbol_id].load() : SymbolMark();
+}
+
+// Recomputes one symbol and applies the change in its contribution to the totals
+void MarkToMarket::revalue(SymbolId symbol_id, SymbolMark& mark) {
+    const double old_unrealized = mark.unrealized_pnl;
+    const double old_exposure = mark.exposure;
+    const double position = static_cast<double>(mark.net_position);
+    if (mark.mark_price > 0.0) {
+        mark.unrealized_pnl = position * (mark.mark_price - mark.avg_entry_price);
+        mark.exposure = position * mark.mark_price;
+    } else {
+        // Not quoted yet: carry the position at cost
+        mark.unrealized_pnl = 0.0;
+        mark.exposure = position * mark.avg_entry_price;
+    }
+
+    portfolio_.unrealized_pnl += mark.unrealized_pnl - old_unrealized;
+    portfolio_.net_exposure += mark.exposure - old_exposure;
+    portfolio_.gross_exposure += std::abs(mark.exposure) - std::abs(old_exposure);
+    const double total_pnl = portfolio_.realized_pnl + portfolio_.unrealized_pnl;
+    portfolio_.peak_pnl = std::max(portfolio_.peak_pnl, total_pnl);
+    portfolio_.drawdown = portfolio_.peak_pnl - total_pnl;
+    portfolio_.max_drawdown = std::max(portfolio_.max_drawdown, portfolio_.drawdown);
+
+    published_marks_[symbol_id].store(mark);
+    published_portfolio_.store(portfolio_);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "RiskEngine.h"
+#include "common/Seqlock.h"
+#include "order_book/QuoteUpdate.h"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// One symbol's position valued at its latest mark
+struct SymbolMark {
+    long long net_position = 0;
+    double avg_entry_price = 0.0;
+    double realized_pnl = 0.0;
+    double mark_price = 0.0; // Mid of the best bid and ask, or the side quoted; 0 until the first quote
+    double unrealized_pnl = 0.0;
+    double exposure = 0.0;   // net_position * mark_price, at cost until the first quote
+};
+
+// Totals across every symbol
+struct PortfolioMark {
+    double realized_pnl = 0.0;
+    double unrealized_pnl = 0.0;
+    double gross_exposure = 0.0; // Sum of |exposure|
+    double net_exposure = 0.0;   // Sum of signed exposure
+    double peak_pnl = 0.0;       // Highest total P&L seen
+    double drawdown = 0.0;       // peak_pnl minus the current total P&L
+    double max_drawdown = 0.0;
+};
+
+/**
+ * @brief Values positions at the latest best bid/ask and keeps portfolio P&L,
+ *        exposure and drawdown current.
+ *
+ * Each quote or position change revalues only its own symbol and moves the
+ * portfolio totals by that symbol's difference, so the cost of an update does
+ * not grow with the number of symbols held. on_quote() and on_position() must
+ * be called from one thread (typically the one draining the quote and
+ * execution feeds); symbol() and portfolio() return consistent copies on any
+ * thread without a lock.
+ */
+class MarkToMarket {
+public:
+    explicit MarkToMarket(size_t max_symbols = RiskEngine::kDefaultMaxSymbols);
+
+    // A book's best prices changed; quotes for symbols past the table are ignored
+    void on_quote(const QuoteUpdate& quote);
+
+    // The symbol's position changed, e.g. after RiskEngine::update_on_trade()
+    void on_position(SymbolId symbol_id, const Position& position);
+
+    SymbolMark symbol(SymbolId symbol_id) const;
+    PortfolioMark portfolio() const { return published_portfolio_.load(); }
+
+private:
+    void revalue(SymbolId symbol_id, SymbolMark& mark);
+
+    // Writer-side state; readers go through the seqlocks
+    std::vector<SymbolMark> marks_;
+    PortfolioMark portfolio_;
+
+    std::unique_ptr<Seqlock<SymbolMark>[]> published_marks_;
+    Seqlock<PortfolioMark> published_portfolio_;
+};
@@ -0,0 +1,165 @@
+#include "OrderReservations.h"
+#include <algorithm>
+
+namespace {
+
+constexpr size_t kMinCapacity = 64;
+
+} // namespace
+
+OrderReservations::OrderReservations(RiskEngine& risk) : risk_(risk), mask_(0), shift_(64), size_(0) {
+    rehash(kMinCapacity);
+}
+
+void OrderReservations::on_execution(const ExecutionReport& report) {
+    switch (report.type) {
+        case ExecutionType::TRADE:
+            // The aggressor's share is settled by its command's status
+            release(report.trade.symbol_id, report.trade.resting_order_id, report.trade.quantity);
+            break;
+        case ExecutionType::SELF_TRADE_CANCEL:
+            if (report.cancel.resting) {
+                release(report.cancel.symbol_id, report.cancel.order_id, report.cancel.quantity);
+            }
+            break;
+        case ExecutionType::ORDER_STATUS:
+            on_status(report.status);
+            break;
+    }
+}
+
+void OrderReservations::on_status(const OrderStatus& status) {
+    const OrderCommand& command = status.command;
+    switch (command.type) {
+        case CommandType::NEW_ORDER: {
+            const uint64_t reserved = RiskEngine::reserves_open_quantity(command.to_order()) ? command.quantity : 0;
+            if (!status.accepted) {
+                // Refused, e.g. a duplicate id: the resting order keeps its own reservation
+                risk_.release_open_quantity(command.account_id, command.symbol_id, command.side, reserved);
+                return;
+            }
+            // The check's reservation becomes the order's, less what traded or expired
+            if (reserved > 0) {
+                put(command.symbol_id, command.order_id, Reservation{command.account_id, command.side, reserved});
+            }
+            settle(command.symbol_id, command.order_id, command.account_id, command.side, status.remaining_quantity);
+            break;
+        }
+        case CommandType::CANCEL:
+            if (status.accepted) {
+                settle(command.symbol_id, command.order_id, command.account_id, command.side, 0);
+            }
+            break;
+        case CommandType::MODIFY:
+            // Settle first so the order's exposure never dips below what rests
+            if (status.accepted) {
+                settle(command.symbol_id, command.order_id, command.account_id, command.side,
+                       status.remaining_quantity);
+            }
+            risk_.release_open_quantity(command.account_id, command.symbol_id, command.side, command.quantity);
+            break;
+    }
+}
+
+void OrderReservations::reserve_resting(OrderBook& book) {
+    for (const Order& order : book.snapshot().orders) {
+        settle(order.symbol_id, order.id, order.account_id, order.side, order.remaining_quantity);
+    }
+}
+
+uint64_t OrderReservations::reserved(SymbolId symbol_id, uint64_t order_id) const {
+    return slots_[probe(symbol_id, order_id)].reservation.quantity;
+}
+
+void OrderReservations::release(SymbolId symbol_id, uint64_t order_id, uint64_t quantity) {
+    const size_t slot = probe(symbol_id, order_id);
+    Reservation& reservation = slots_[slot].reservation;
+    if (reservation.quantity == 0) {
+        return;
+    }
+    quantity = std::min(quantity, reservation.quantity);
+    risk_.release_open_quantity(reservation.account_id, symbol_id, reservation.side, quantity);
+    if ((reservation.quantity -= quantity) == 0) {
+        erase(slot);
+    }
+}
+
+void OrderReservations::settle(SymbolId symbol_id, uint64_t order_id, AccountId account_id, OrderSide side,
+                               uint64_t remaining) {
+    const size_t slot = probe(symbol_id, order_id);
+    Reservation& reservation = slots_[slot].reservation;
+    if (reservation.quantity == 0) {
+        if (remaining > 0) {
+            risk_.reserve_open_quantity(account_id, symbol_id, side, remaining);
+            put(symbol_id, order_id, Reservation{account_id, side, remaining});
+        }
+        return;
+    }
+    // An order keeps the account and side it was placed with
+    if (remaining > reservation.quantity) {
+        risk_.reserve_open_quantity(reservation.account_id, symbol_id, reservation.side,
+                                    remaining - reservation.quantity);
+    } else {
+        risk_.release_open_quantity(reservation.account_id, symbol_id, reservation.side,
+                                    reservation.quantity - remaining);
+    }
+    if (remaining == 0) {
+        erase(slot);
+    } else {
+        reservation.quantity = remaining;
+    }
+}
+
+size_t OrderReservations::probe(SymbolId symbol_id, uint64_t order_id) const {
+    size_t i = home(symbol_id, order_id);
+    while (slots_[i].reservation.quantity != 0 &&
+           (slots_[i].order_id != order_id || slots_[i].symbol_id != symbol_id)) {
+        i = (i + 1) & mask_;
+    }
+    return i;
+}
+
+void OrderReservations::put(SymbolId symbol_id, uint64_t order_id, const Reservation& reservation) {
+    size_t i = probe(symbol_id, order_id);
+    if (slots_[i].reservation.quantity == 0) {
+        if (2 * (size_ + 1) > slots_.size()) {
+            rehash(2 * slots_.size());
+            i = probe(symbol_id, order_id);
+        }
+        ++size_;
+    }
+    slots_[i] = Slot{symbol_id, order_id, reservation};
+}
+
+void OrderReservations::erase(size_t hole) {
+    // Pull back any later entry of the run whose home is at or before the hole,
+    // so every entry stays reachable from its home without tombstones
+    for (size_t next = (hole + 1) & mask_; slots_[next].reservation.quantity != 0; next = (next + 1) & mask_) {
+        const size_t displacement = (next - home(slots_[next].symbol_id, slots_[next].order_id)) & mask_;
+        if (displacement >= ((next - hole) & mask_)) {
+            slots_[hole] = slots_[next];
+            hole = next;
+        }
+    }
+    slots_[hole] = Slot{};
+    --size_;
+}
+
+void OrderReservations::rehash(size_t new_capacity) {
+    std::vector<Slot> old(new_capacity);
+    old.swap(slots_);
+    mask_ = new_capacity - 1;
+    shift_ = 64;
+    for (size_t n = new_capacity; n > 1; n >>= 1) {
+        --shift_;
+    }
+    for (const Slot& slot : old) {
+        if (slot.reservation.quantity != 0) {
+            size_t i = home(slot.symbol_id, slot.order_id);
+            while (slots_[i].reservation.quantity != 0) {
+                i = (i + 1) & mask_;
+            }
+            slots_[i] = slot;
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "RiskEngine.h"
+#include "order_book/ExecutionReport.h"
+#include "order_book/OrderBook.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Ties the risk engine's working-quantity reservations to the orders
+ *        that hold them.
+ *
+ * RiskEngine::check_pre_trade_risk() reserves a passing GTC limit order's
+ * quantity on its account and side; a modify is expected to have been checked
+ * the same way, as a GTC limit order for its new quantity under the account
+ * and side its command carries. This class follows each order's reservation
+ * through the execution feed of a BookManager run with report_order_status, so
+ * exactly what an order still has resting stays reserved:
+ *  - fills and self-trade cuts of a resting order release what they took;
+ *  - each command's ORDER_STATUS settles what the check reserved against what
+ *    the order has left afterwards, so aggressor fills, IOC/FOK/market
+ *    expiry, refusals, cancels and modifies all come out even.
+ * Reports must arrive in the order each shard published them, and every call
+ * must come from one thread, normally the one draining the execution feed.
+ *
+ * Reservations live in a flat table probed linearly, like OrderIndex: erase
+ * shifts entries back instead of leaving tombstones and the table doubles
+ * before it is half full, so tracking an order allocates nothing once the
+ * table has grown to the working set.
+ */
+class OrderReservations {
+public:
+    explicit OrderReservations(RiskEngine& risk);
+
+    void on_execution(const ExecutionReport& report);
+
+    // Reserve and track every order resting in `book`, e.g. after recovery,
+    // so exposure covers orders placed before a restart. Call before start().
+    void reserve_resting(OrderBook& book);
+
+    // Quantity still reserved for one order; 0 if it holds none
+    uint64_t reserved(SymbolId symbol_id, uint64_t order_id) const;
+    size_t size() const { return size_; }
+
+private:
+    struct Reservation {
+        AccountId account_id = 0;
+        OrderSide side = OrderSide::BUY;
+        uint64_t quantity = 0;
+    };
+    // Ids are only unique within a book, so the symbol is part of the key. A
+    // zero quantity marks a free slot; a tracked reservation is never zero.
+    struct Slot {
+        SymbolId symbol_id = 0;
+        uint64_t order_id = 0;
+        Reservation reservation;
+    };
+
+    void on_status(const OrderStatus& status);
+    void release(SymbolId symbol_id, uint64_t order_id, uint64_t quantity);
+    // Move an order's reservation to `remaining`, tracking it while non-zero
+    void settle(SymbolId symbol_id, uint64_t order_id, AccountId account_id, OrderSide side, uint64_t remaining);
+
+    size_t home(SymbolId symbol_id, uint64_t order_id) const {
+        const uint64_t key = order_id ^ (static_cast<uint64_t>(symbol_id) << 40);
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> shift_);
+    }
+    // Slot holding the order's reservation, or the free slot ending its run
+    size_t probe(SymbolId symbol_id, uint64_t order_id) const;
+    // Track or replace the order's reservation; `reservation` must not be zero
+    void put(SymbolId symbol_id, uint64_t order_id, const Reservation& reservation);
+    void erase(size_t slot);
+    void rehash(size_t new_capacity);
+
+    RiskEngine& risk_;
+    std::vector<Slot> slots_;
+    size_t mask_;
+    unsigned shift_; // 64 - log2(capacity), so home() keeps the top bits of the hash
+    size_t size_;
+};
@@ -1,96 +1,346 @@
 #include "RiskEngine.h"
-#include <iostream>
+#include "common/Logger.h"
+#include "common/SymbolTable.h"
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdlib>
 
-RiskEngine::RiskEngine(double max_pos_limit) : max_position_limit_(max_pos_limit) {}
+const char* to_string(RejectReason reason) {
+    switch (reason) {
+        case RejectReason::NONE: return "none";
+        case RejectReason::UNKNOWN_SYMBOL: return "unknown symbol";
+        case RejectReason::UNKNOWN_ACCOUNT: return "unknown account";
+        case RejectReason::ORDER_QUANTITY: return "order quantity limit";
+        case RejectReason::ORDER_NOTIONAL: return "order notional limit";
+        case RejectReason::PRICE_COLLAR: return "price outside collar";
+        case RejectReason::POSITION_LIMIT: return "position limit";
+        case RejectReason::ORDER_RATE: return "order rate limit";
+    }
+    return "unknown";
+}
+
+RiskEngine::RiskEngine(double max_pos_limit, size_t max_symbols, size_t max_accounts)
+    : positions_(std::make_unique<PositionSlot[]>(max_accounts * max_symbols)),
+      working_(std::make_unique<WorkingSlot[]>(max_accounts * max_symbols)),
+      symbols_(std::make_unique<SymbolSlot[]>(max_symbols)),
+      accounts_(std::make_unique<AccountSlot[]>(max_accounts)),
+      max_symbols_(max_symbols),
+      max_accounts_(max_accounts) {
+    SymbolLimits defaults;
+    defaults.max_position = max_pos_limit < static_cast<double>(defaults.max_position)
+                                ? static_cast<long long>(max_pos_limit)
+                                : defaults.max_position;
+    for (size_t id = 0; id < max_symbols_; ++id) {
+        set_symbol_limits(static_cast<SymbolId>(id), defaults);
+    }
+}
+
+bool RiskEngine::set_symbol_limits(SymbolId symbol_id, const SymbolLimits& limits) {
+    if (symbol_id >= max_symbols_) {
+        return false;
+    }
+    // Prices arrive in ticks, so dividing the notional bound once here saves a
+    // multiply on every check
+    symbols_[symbol_id].rule = SymbolRule{limits.max_order_quantity, limits.max_order_notional / limits.tick_size,
+                                   limits.max_position, limits.price_collar_bps, limits.max_orders_per_second,
+                                   limits.tick_size};
+    return true;
+}
 
-void RiskEngine::update_on_trade(const Trade& trade, OrderSide our_order_side, const std::string& symbol) {
-    std::lock_guard<std::mutex> lock(risk_mutex_);
+bool RiskEngine::set_account_limits(AccountId account_id, const AccountLimits& limits) {
+    if (account_id >= max_accounts_) {
+        return false;
+    }
+    accounts_[account_id].limits = limits;
+    return true;
+}
+
+void RiskEngine::update_on_trade(const Trade& trade) {
+    if (!in_range(trade.buyer(), trade.symbol_id) || !in_range(trade.seller(), trade.symbol_id)) {
+        LOG_ERROR("[RISK ENGINE] Trade %llu for symbol %u between accounts %u and %u is beyond the positions "
+                  "tracked; trade ignored",
+                  static_cast<unsigned long long>(trade.trade_id), trade.symbol_id, trade.buyer(), trade.seller());
+        return;
+    }
+    apply_fill(trade.buyer(), OrderSide::BUY, trade);
+    apply_fill(trade.seller(), OrderSide::SELL, trade);
+    SymbolSlot& symbol = symbols_[trade.symbol_id];
+    symbol.last_trade_price.store(to_ticks(trade.price, symbol.rule.tick_size), std::memory_order_relaxed);
+}
 
-    // Find or create a position for the symbol
-    if (portfolio_.find(symbol) == portfolio_.end()) {
-        portfolio_[symbol] = Position{symbol};
+void RiskEngine::apply_fill(AccountId account_id, OrderSide side, const Trade& trade) {
+    PositionSlot* pos = &positions_[index(account_id, trade.symbol_id)];
+    const char* symbol = pos->symbol.load(std::memory_order_relaxed);
+    if (!symbol) {
+        // Names are stable for the life of the process, so one lookup per position
+        symbol = SymbolTable::instance().name(trade.symbol_id).c_str();
     }
-    
-    Position& pos = portfolio_[symbol];
+
+    // Single writer: the slot's current values are this thread's own
     long long trade_size = static_cast<long long>(trade.quantity);
     double trade_price = trade.price;
-    
-    // Store old position for P&L calculation
-    long long old_position = pos.net_position;
-    double old_avg_price = pos.avg_entry_price;
+    long long old_position = pos->net_position.load(std::memory_order_relaxed);
+    double old_avg_price = pos->avg_entry_price.load(std::memory_order_relaxed);
+    double realized_pnl = pos->realized_pnl.load(std::memory_order_relaxed);
+    double avg_entry_price = old_avg_price;
 
     // Update net position
-    if (our_order_side == OrderSide::BUY) {
-        pos.net_position += trade_size;
-    } else { // SELL
-        pos.net_position -= trade_size;
-    }
+    long long net_position = (side == OrderSide::BUY) ? old_position + trade_size
+                                                      : old_position - trade_size;
 
     // Calculate average entry price and realized P&L
-    if (our_order_side == OrderSide::BUY) {
+    if (side == OrderSide::BUY) {
         // Buying: update average entry price
         if (old_position >= 0) {
             // Adding to long position or opening long position
             double total_cost = (old_position * old_avg_price) + (trade_size * trade_price);
-            pos.avg_entry_price = (pos.net_position > 0) ? total_cost / pos.net_position : trade_price;
-        } else if (pos.net_position >= 0) {
-            // Covered short position and possibly went long
-            pos.realized_pnl += (old_avg_price - trade_price) * std::min(trade_size, -old_position);
-            if (pos.net_position > 0) {
-                pos.avg_entry_price = trade_price; // New long position
+            avg_entry_price = (net_position > 0) ? total_cost / net_position : trade_price;
+        } else {
+            // Reducing/covering short position and possibly went long
+            realized_pnl += (old_avg_price - trade_price) * std::min(trade_size, -old_position);
+            if (net_position > 0) {
+                avg_entry_price = trade_price; // New long position
             }
         }
     } else { // SELL
         // Selling: realize P&L if closing/reducing long, or update avg for short
         if (old_position > 0) {
             // Reducing/closing long position
-            pos.realized_pnl += (trade_price - old_avg_price) * std::min(trade_size, old_position);
-            if (pos.net_position <= 0 && pos.net_position < 0) {
-                pos.avg_entry_price = trade_price; // New short position
+            realized_pnl += (trade_price - old_avg_price) * std::min(trade_size, old_position);
+            if (net_position < 0) {
+                avg_entry_price = trade_price; // New short position
             }
         } else {
             // Adding to short position or opening short position
-            if (old_position <= 0) {
-                double total_cost = (-old_position * old_avg_price) + (trade_size * trade_price);
-                pos.avg_entry_price = (pos.net_position < 0) ? total_cost / (-pos.net_position) : trade_price;
-            }
+            double total_cost = (-old_position * old_avg_price) + (trade_size * trade_price);
+            avg_entry_price = (net_position < 0) ? total_cost / (-net_position) : trade_price;
         }
     }
 
-    std::cout << "[RISK ENGINE] Updated position for " << symbol 
-              << ". Position: " << pos.net_position 
-              << ", Avg Entry: $" << pos.avg_entry_price 
-              << ", Realized P&L: $" << pos.realized_pnl << std::endl;
+    store(*pos, net_position, avg_entry_price, realized_pnl);
+    pos->symbol.store(symbol, std::memory_order_release);
+
+    LOG_INFO("[RISK ENGINE] Updated position for account %u in %s. Position: %lld, Avg Entry: $%.2f, "
+             "Realized P&L: $%.2f",
+             account_id, symbol, net_position, avg_entry_price, realized_pnl);
 }
 
-bool RiskEngine::check_pre_trade_risk(const Order& order) {
-    std::lock_guard<std::mutex> lock(risk_mutex_);
-    
-    long long current_pos = 0;
-    if (portfolio_.count(order.symbol)) {
-        current_pos = portfolio_.at(order.symbol).net_position;
+RejectReason RiskEngine::check_pre_trade_risk(const Order& order) {
+    if (order.symbol_id >= max_symbols_) {
+        return RejectReason::UNKNOWN_SYMBOL;
     }
+    if (order.account_id >= max_accounts_) {
+        return RejectReason::UNKNOWN_ACCOUNT;
+    }
+    SymbolSlot& symbol = symbols_[order.symbol_id];
+    const SymbolRule& rule = symbol.rule;
+    AccountSlot& account = accounts_[order.account_id];
+    const size_t slot = index(order.account_id, order.symbol_id);
+    const PositionSlot& pos = positions_[slot];
+    WorkingSlot& working_slot = working_[slot];
 
-    long long potential_pos_change = (order.side == OrderSide::BUY) ? order.quantity : -static_cast<long long>(order.quantity);
-    long long potential_net_pos = current_pos + potential_pos_change;
+    // Market orders are valued at the last trade, the nearest guess at their fill
+    const bool is_market = order.type == OrderType::MARKET;
+    const Price last_trade = symbol.last_trade_price.load(std::memory_order_relaxed);
+    const double notional_ticks = static_cast<double>(order.quantity) *
+                                  static_cast<double>(is_market ? last_trade : order.price);
 
-    if (std::abs(potential_net_pos) > max_position_limit_) {
-        std::cerr << "[RISK ENGINE] PRE-TRADE RISK CHECK FAILED: Order would exceed max position limit." << std::endl;
-        std::cerr << "   Current Position: " << current_pos << ", Potential Position: " << potential_net_pos 
-                  << ", Max Limit: " << max_position_limit_ << std::endl;
-        return false;
+    if (order.quantity > rule.max_order_quantity || order.quantity > account.limits.max_order_quantity) {
+        return RejectReason::ORDER_QUANTITY;
+    }
+    if (notional_ticks > rule.max_notional_ticks ||
+        notional_ticks * rule.tick_size > account.limits.max_order_notional) {
+        return RejectReason::ORDER_NOTIONAL;
+    }
+    if (rule.price_collar_bps != 0 && !is_market && last_trade > 0) {
+        const Price distance = order.price > last_trade ? order.price - last_trade : last_trade - order.price;
+        if (distance * 10000 > last_trade * static_cast<Price>(rule.price_collar_bps)) {
+            return RejectReason::PRICE_COLLAR;
+        }
     }
 
-    std::cout << "[RISK ENGINE] PRE-TRADE RISK CHECK PASSED. Current: " << current_pos 
-              << " → Potential: " << potential_net_pos << std::endl;
-    return true;
+    // Worst case: every working order of this account on this side fills
+    // along with this one
+    const bool is_buy = order.side == OrderSide::BUY;
+    std::atomic<uint64_t>& open = is_buy ? working_slot.open_buy : working_slot.open_sell;
+    const long long working = static_cast<long long>(open.load(std::memory_order_relaxed)) +
+                              static_cast<long long>(order.quantity);
+    const long long current_pos = pos.net_position.load(std::memory_order_relaxed);
+    const long long worst_pos = is_buy ? current_pos + working : current_pos - working;
+    if (std::llabs(worst_pos) > rule.max_position) {
+        return RejectReason::POSITION_LIMIT;
+    }
+
+    // Rate windows only count orders that cleared every other limit
+    if (rule.max_orders_per_second != 0 || account.limits.max_orders_per_second != 0) {
+        const uint32_t second = static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::seconds>(order.timestamp.time_since_epoch()).count());
+        // Both windows must have room before either counts the order, so an
+        // account over its own limit never spends the symbol's budget
+        if (!has_room(symbol.rate_window, second, rule.max_orders_per_second) ||
+            !has_room(account.rate_window, second, account.limits.max_orders_per_second) ||
+            !admit(symbol.rate_window, second, rule.max_orders_per_second)) {
+            return RejectReason::ORDER_RATE;
+        }
+        if (!admit(account.rate_window, second, account.limits.max_orders_per_second)) {
+            // Another thread took the account's last slot since the check
+            revoke(symbol.rate_window, second, rule.max_orders_per_second);
+            return RejectReason::ORDER_RATE;
+        }
+    }
+
+    if (reserves_open_quantity(order)) {
+        open.fetch_add(order.quantity, std::memory_order_relaxed);
+    }
+    return RejectReason::NONE;
+}
+
+void RiskEngine::reserve_open_quantity(AccountId account_id, SymbolId symbol_id, OrderSide side,
+                                       uint64_t quantity) {
+    if (!in_range(account_id, symbol_id)) {
+        return;
+    }
+    WorkingSlot& working = working_[index(account_id, symbol_id)];
+    (side == OrderSide::BUY ? working.open_buy : working.open_sell).fetch_add(quantity, std::memory_order_relaxed);
+}
+
+void RiskEngine::release_open_quantity(AccountId account_id, SymbolId symbol_id, OrderSide side,
+                                       uint64_t quantity) {
+    if (!in_range(account_id, symbol_id)) {
+        return;
+    }
+    WorkingSlot& working = working_[index(account_id, symbol_id)];
+    std::atomic<uint64_t>& open = side == OrderSide::BUY ? working.open_buy : working.open_sell;
+    // Stop at zero so a release that was never reserved cannot wrap the count
+    uint64_t current = open.load(std::memory_order_relaxed);
+    while (!open.compare_exchange_weak(current, current - std::min(current, quantity), std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t RiskEngine::open_quantity(AccountId account_id, SymbolId symbol_id, OrderSide side) const {
+    if (!in_range(account_id, symbol_id)) {
+        return 0;
+    }
+    const WorkingSlot& working = working_[index(account_id, symbol_id)];
+    return (side == OrderSide::BUY ? working.open_buy : working.open_sell).load(std::memory_order_relaxed);
+}
+
+std::optional<Position> RiskEngine::get_position(AccountId account_id, SymbolId symbol_id) const {
+    if (!in_range(account_id, symbol_id)) {
+        return std::nullopt;
+    }
+    const PositionSlot& pos = positions_[index(account_id, symbol_id)];
+    if (!pos.symbol.load(std::memory_order_acquire)) {
+        return std::nullopt;
+    }
+    return load(pos, account_id);
+}
+
+std::optional<Position> RiskEngine::get_position(AccountId account_id, const std::string& symbol) const {
+    const std::optional<SymbolId> symbol_id = SymbolTable::instance().find(symbol);
+    if (!symbol_id) {
+        return std::nullopt;
+    }
+    return get_position(account_id, *symbol_id);
+}
+
+std::vector<Position> RiskEngine::positions() const {
+    std::vector<Position> positions;
+    for (size_t account = 0; account < max_accounts_; ++account) {
+        for (size_t id = 0; id < max_symbols_; ++id) {
+            const PositionSlot& pos = positions_[account * max_symbols_ + id];
+            if (pos.symbol.load(std::memory_order_acquire)) {
+                positions.push_back(load(pos, static_cast<AccountId>(account)));
+            }
+        }
+    }
+    return positions;
+}
+
+void RiskEngine::restore_positions(const std::vector<Position>& positions) {
+    for (size_t slot = 0; slot < max_accounts_ * max_symbols_; ++slot) {
+        positions_[slot].symbol.store(nullptr, std::memory_order_release);
+        store(positions_[slot], 0, 0.0, 0.0);
+    }
+    for (const Position& restored : positions) {
+        const SymbolId symbol_id = SymbolTable::instance().intern(restored.symbol);
+        if (!in_range(restored.account_id, symbol_id)) {
+            LOG_ERROR("[RISK ENGINE] No position slot for account %u in %s; position not restored",
+                      restored.account_id, restored.symbol.c_str());
+            continue;
+        }
+        PositionSlot& pos = positions_[index(restored.account_id, symbol_id)];
+        store(pos, restored.net_position, restored.avg_entry_price, restored.realized_pnl);
+        pos.symbol.store(SymbolTable::instance().name(symbol_id).c_str(), std::memory_order_release);
+    }
+}
+
+void RiskEngine::store(PositionSlot& slot, long long net_position, double avg_entry_price, double realized_pnl) {
+    // Seqlock write: readers retry if they overlap the odd window
+    const uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.net_position.store(net_position, std::memory_order_relaxed);
+    slot.avg_entry_price.store(avg_entry_price, std::memory_order_relaxed);
+    slot.realized_pnl.store(realized_pnl, std::memory_order_relaxed);
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool RiskEngine::has_room(const std::atomic<uint64_t>& rate_window, uint32_t second, uint32_t max_per_second) {
+    if (max_per_second == 0) {
+        return true;
+    }
+    const uint64_t current = rate_window.load(std::memory_order_relaxed);
+    return (current >> 32) != second || (current & 0xFFFFFFFFu) < max_per_second;
+}
+
+bool RiskEngine::admit(std::atomic<uint64_t>& rate_window, uint32_t second, uint32_t max_per_second) {
+    if (max_per_second == 0) {
+        return true;
+    }
+    uint64_t current = rate_window.load(std::memory_order_relaxed);
+    for (;;) {
+        // A new second starts a fresh count
+        const uint64_t count = (current >> 32) == second ? (current & 0xFFFFFFFFu) : 0;
+        if (count >= max_per_second) {
+            return false;
+        }
+        const uint64_t next = (static_cast<uint64_t>(second) << 32) | (count + 1);
+        if (rate_window.compare_exchange_weak(current, next, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+}
+
+void RiskEngine::revoke(std::atomic<uint64_t>& rate_window, uint32_t second, uint32_t max_per_second) {
+    if (max_per_second == 0) {
+        return;
+    }
+    uint64_t current = rate_window.load(std::memory_order_relaxed);
+    // Once the window has moved on the count it was taken from is gone anyway
+    while ((current >> 32) == second && (current & 0xFFFFFFFFu) > 0) {
+        if (rate_window.compare_exchange_weak(current, current - 1, std::memory_order_relaxed)) {
+            return;
+        }
+    }
 }
 
-std::optional<Position> RiskEngine::get_position(const std::string& symbol) {
-    std::lock_guard<std::mutex> lock(risk_mutex_);
-    if (portfolio_.count(symbol)) {
-        return portfolio_.at(symbol);
+Position RiskEngine::load(const PositionSlot& slot, AccountId account_id) {
+    Position position;
+    position.account_id = account_id;
+    uint32_t before;
+    uint32_t after;
+    do {
+        before = slot.sequence.load(std::memory_order_acquire);
+        position.net_position = slot.net_position.load(std::memory_order_relaxed);
+        position.avg_entry_price = slot.avg_entry_price.load(std::memory_order_relaxed);
+        position.realized_pnl = slot.realized_pnl.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = slot.sequence.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+    if (const char* symbol = slot.symbol.load(std::memory_order_acquire)) {
+        position.symbol = symbol;
     }
-    return std::nullopt;
+    return position;
 }
@@ -2,36 +2,185 @@
 
 #include "order_book/Trade.h"
 #include "order_book/Order.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
 #include <string>
-#include <unordered_map>
-#include <mutex>
 #include <optional>
+#include <vector>
 
 struct Position {
+    AccountId account_id = 0;
     std::string symbol;
     long long net_position = 0;
     double avg_entry_price = 0.0;
     double realized_pnl = 0.0;
-    
+
     // For simplicity in this step, we'll focus on tracking the position.
     // P&L calculation would be the next enhancement.
 };
 
+// Why a pre-trade check refused an order; NONE means it passed
+enum class RejectReason : uint8_t {
+    NONE,
+    UNKNOWN_SYMBOL,   // Symbol id beyond the engine's tables
+    UNKNOWN_ACCOUNT,  // Account id beyond the engine's tables
+    ORDER_QUANTITY,   // Quantity above the symbol or account maximum
+    ORDER_NOTIONAL,   // Quantity * price above the symbol or account maximum
+    PRICE_COLLAR,     // Limit price too far from the symbol's last trade
+    POSITION_LIMIT,   // Position after every working order fills would exceed the limit
+    ORDER_RATE        // Too many orders this second for the symbol or account
+};
+
+const char* to_string(RejectReason reason);
+
+// Limits for one symbol. Zero rate or collar disables that check.
+struct SymbolLimits {
+    uint64_t max_order_quantity = std::numeric_limits<uint64_t>::max();
+    double max_order_notional = std::numeric_limits<double>::infinity();
+    // Bound on |net position| if every working order on one side filled
+    long long max_position = std::numeric_limits<long long>::max();
+    // Furthest a limit price may sit from the last trade, in basis points
+    uint32_t price_collar_bps = 0;
+    uint32_t max_orders_per_second = 0;
+    // Converts tick prices to notional; should match the symbol's book
+    double tick_size = 0.01;
+};
+
+// Limits for one account, applied across every symbol it trades
+struct AccountLimits {
+    uint64_t max_order_quantity = std::numeric_limits<uint64_t>::max();
+    double max_order_notional = std::numeric_limits<double>::infinity();
+    uint32_t max_orders_per_second = 0;
+};
+
+/**
+ * @brief Position keeping and pre-trade limits without a shared lock.
+ *
+ * Positions are kept per account and symbol in a dense array indexed by
+ * (AccountId, SymbolId), one cache line each, so checks and fills on different
+ * positions never touch the same line. A trade updates the buyer's and the
+ * seller's positions in one call, using the symbol and accounts it carries.
+ * Each symbol has a single writer: update_on_trade() calls for one symbol must
+ * not run concurrently (the execution consumer thread is the natural owner).
+ * Pre-trade checks and position reads are lock-free and may run on any number
+ * of threads; get_position() takes a consistent copy through the slot's
+ * sequence counter.
+ *
+ * Limits sit in flat tables indexed by symbol and account id, with notional
+ * bounds pre-divided into ticks, so a check is a handful of compares against
+ * one symbol row and one account row. A GTC limit order that passes reserves
+ * its quantity as working exposure on its side until release_open_quantity()
+ * reports it filled or gone from the book. Limits hold exactly when each
+ * symbol and account is checked from one thread at a time; concurrent checks
+ * can overshoot by the orders in flight.
+ */
 class RiskEngine {
 public:
-    RiskEngine(double max_pos_limit);
+    // One position slot per account and symbol, so the tables hold
+    // max_symbols * max_accounts slots
+    static constexpr size_t kDefaultMaxSymbols = 1024;
+    static constexpr size_t kDefaultMaxAccounts = 16;
+
+    // max_pos_limit becomes every symbol's default max_position, applied to
+    // each account's position. Orders for symbols or accounts past the tables
+    // are rejected.
+    explicit RiskEngine(double max_pos_limit, size_t max_symbols = kDefaultMaxSymbols,
+                        size_t max_accounts = kDefaultMaxAccounts);
+
+    // Replace the limits of one symbol or account. Call before checks for it
+    // start; returns false if the id is past the tables.
+    bool set_symbol_limits(SymbolId symbol_id, const SymbolLimits& limits);
+    bool set_account_limits(AccountId account_id, const AccountLimits& limits);
+
+    // Update the buyer's and seller's positions for an executed trade
+    void update_on_trade(const Trade& trade);
 
-    // Update position based on an executed trade
-    void update_on_trade(const Trade& trade, OrderSide our_order_side, const std::string& symbol);
+    // Pre-trade check to see if an order would breach limits. Passing orders
+    // for which reserves_open_quantity() holds count toward the working
+    // exposure of their side.
+    RejectReason check_pre_trade_risk(const Order& order);
 
-    // Pre-trade check to see if an order would breach limits
-    bool check_pre_trade_risk(const Order& order);
+    // Whether a passing order reserves its quantity: only a GTC limit order
+    // can rest and keep exposure after the book has handled it
+    static bool reserves_open_quantity(const Order& order) {
+        return order.type != OrderType::MARKET && order.time_in_force == TimeInForce::GTC;
+    }
 
-    // Get the current position for a symbol
-    std::optional<Position> get_position(const std::string& symbol);
+    // Count quantity already resting as working, e.g. orders recovered into the books
+    void reserve_open_quantity(AccountId account_id, SymbolId symbol_id, OrderSide side, uint64_t quantity);
+    // Working quantity that filled or left the book (cancelled or refused)
+    void release_open_quantity(AccountId account_id, SymbolId symbol_id, OrderSide side, uint64_t quantity);
+    uint64_t open_quantity(AccountId account_id, SymbolId symbol_id, OrderSide side) const;
+
+    // Get an account's current position in a symbol
+    std::optional<Position> get_position(AccountId account_id, SymbolId symbol_id) const;
+    std::optional<Position> get_position(AccountId account_id, const std::string& symbol) const;
+
+    // Copy of every position, for snapshots
+    std::vector<Position> positions() const;
+
+    // Replace the portfolio with `positions`, e.g. from a snapshot. Must not
+    // run concurrently with update_on_trade().
+    void restore_positions(const std::vector<Position>& positions);
 
 private:
-    std::unordered_map<std::string, Position> portfolio_;
-    double max_position_limit_;
-    std::mutex risk_mutex_;
+    static constexpr size_t kCacheLine = 64;
+
+    struct alignas(kCacheLine) PositionSlot {
+        std::atomic<uint32_t> sequence{0}; // Odd while the writer is mid-update
+        std::atomic<const char*> symbol{nullptr}; // Set on first update; null means no position
+        std::atomic<long long> net_position{0};
+        std::atomic<double> avg_entry_price{0.0};
+        std::atomic<double> realized_pnl{0.0};
+    };
+
+    // Written by the checking thread, apart from the fill-side position line
+    struct alignas(kCacheLine) WorkingSlot {
+        std::atomic<uint64_t> open_buy{0};
+        std::atomic<uint64_t> open_sell{0};
+    };
+
+    // Symbol row of the limits table, with notional already in tick units
+    struct SymbolRule {
+        uint64_t max_order_quantity;
+        double max_notional_ticks;
+        long long max_position;
+        uint32_t price_collar_bps;
+        uint32_t max_orders_per_second;
+        double tick_size;
+    };
+
+    struct alignas(kCacheLine) SymbolSlot {
+        SymbolRule rule;
+        std::atomic<uint64_t> rate_window{0}; // Second in the high half, orders in the low half
+        std::atomic<Price> last_trade_price{0}; // In ticks; 0 until the first fill
+    };
+
+    struct alignas(kCacheLine) AccountSlot {
+        AccountLimits limits;
+        std::atomic<uint64_t> rate_window{0};
+    };
+
+    bool in_range(AccountId account_id, SymbolId symbol_id) const {
+        return account_id < max_accounts_ && symbol_id < max_symbols_;
+    }
+    size_t index(AccountId account_id, SymbolId symbol_id) const {
+        return static_cast<size_t>(account_id) * max_symbols_ + symbol_id;
+    }
+    void apply_fill(AccountId account_id, OrderSide side, const Trade& trade);
+    static void store(PositionSlot& slot, long long net_position, double avg_entry_price, double realized_pnl);
+    static Position load(const PositionSlot& slot, AccountId account_id);
+    static bool has_room(const std::atomic<uint64_t>& rate_window, uint32_t second, uint32_t max_per_second);
+    static bool admit(std::atomic<uint64_t>& rate_window, uint32_t second, uint32_t max_per_second);
+    static void revoke(std::atomic<uint64_t>& rate_window, uint32_t second, uint32_t max_per_second);
+
+    std::unique_ptr<PositionSlot[]> positions_;
+    std::unique_ptr<WorkingSlot[]> working_;
+    std::unique_ptr<SymbolSlot[]> symbols_;
+    std::unique_ptr<AccountSlot[]> accounts_;
+    size_t max_symbols_;
+    size_t max_accounts_;
 };
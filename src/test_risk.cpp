@@ -14,30 +14,35 @@ void risk_limit_test() {
     std::cout << "=== Risk Limit Test ===" << std::endl;
     
     RiskEngine risk_engine(50.0); // Very low limit for testing
+    const SymbolId test_symbol = SymbolTable::instance().intern("TEST");
     
     // Test 1: Normal order should pass
-    auto order1 = std::make_shared<Order>(1, "TEST", OrderType::LIMIT, OrderSide::BUY, 100.0, 30);
-    bool result1 = risk_engine.check_pre_trade_risk(*order1);
-    std::cout << "Order 1 (30 shares): " << (result1 ? "APPROVED" : "REJECTED") << std::endl;
+    Order order1(1, test_symbol, OrderType::LIMIT, OrderSide::BUY, to_ticks(100.0, 0.01), 30);
+    RejectReason result1 = risk_engine.check_pre_trade_risk(order1);
+    std::cout << "Order 1 (30 shares): " << (result1 == RejectReason::NONE ? "APPROVED" : to_string(result1)) << std::endl;
     
-    // Simulate that order1 was filled
+    // Simulate that order1 was filled against another account's sell
     Trade trade1{1, 1, 2, 100.0, 30};
-    risk_engine.update_on_trade(trade1, OrderSide::BUY, "TEST");
+    trade1.symbol_id = test_symbol;
+    trade1.aggressor_side = OrderSide::BUY;
+    trade1.resting_account = 1;
+    risk_engine.update_on_trade(trade1);
+    risk_engine.release_open_quantity(0, test_symbol, OrderSide::BUY, 30);
     
     // Test 2: This should still pass (30 + 15 = 45 <= 50)
-    auto order2 = std::make_shared<Order>(2, "TEST", OrderType::LIMIT, OrderSide::BUY, 101.0, 15);
-    bool result2 = risk_engine.check_pre_trade_risk(*order2);
-    std::cout << "Order 2 (15 shares): " << (result2 ? "APPROVED" : "REJECTED") << std::endl;
+    Order order2(2, test_symbol, OrderType::LIMIT, OrderSide::BUY, to_ticks(101.0, 0.01), 15);
+    RejectReason result2 = risk_engine.check_pre_trade_risk(order2);
+    std::cout << "Order 2 (15 shares): " << (result2 == RejectReason::NONE ? "APPROVED" : to_string(result2)) << std::endl;
     
-    // Test 3: This should be REJECTED (30 + 25 = 55 > 50)
-    auto order3 = std::make_shared<Order>(3, "TEST", OrderType::LIMIT, OrderSide::BUY, 102.0, 25);
-    bool result3 = risk_engine.check_pre_trade_risk(*order3);
-    std::cout << "Order 3 (25 shares): " << (result3 ? "APPROVED" : "REJECTED") << std::endl;
+    // Test 3: This should be REJECTED (30 held + 15 working + 25 = 70 > 50)
+    Order order3(3, test_symbol, OrderType::LIMIT, OrderSide::BUY, to_ticks(102.0, 0.01), 25);
+    RejectReason result3 = risk_engine.check_pre_trade_risk(order3);
+    std::cout << "Order 3 (25 shares): " << (result3 == RejectReason::NONE ? "APPROVED" : to_string(result3)) << std::endl;
     
     // Test 4: Sell order to reduce position should be allowed
-    auto order4 = std::make_shared<Order>(4, "TEST", OrderType::LIMIT, OrderSide::SELL, 99.0, 40);
-    bool result4 = risk_engine.check_pre_trade_risk(*order4);
-    std::cout << "Order 4 (SELL 40 shares): " << (result4 ? "APPROVED" : "REJECTED") << std::endl;
+    Order order4(4, test_symbol, OrderType::LIMIT, OrderSide::SELL, to_ticks(99.0, 0.01), 40);
+    RejectReason result4 = risk_engine.check_pre_trade_risk(order4);
+    std::cout << "Order 4 (SELL 40 shares): " << (result4 == RejectReason::NONE ? "APPROVED" : to_string(result4)) << std::endl;
     
     std::cout << "Risk limit test completed!" << std::endl;
 }
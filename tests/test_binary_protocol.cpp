@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include "market_data/BinaryProtocol.h"
+#include <cstring>
+#include <vector>
+
+// Messages keep their fixed wire sizes
+TEST(BinaryProtocolTest, FixedLayout) {
+    EXPECT_EQ(sizeof(wire::MessageHeader), 4);
+    EXPECT_EQ(sizeof(wire::NewOrder), 40);
+    EXPECT_EQ(sizeof(wire::Cancel), 16);
+    EXPECT_EQ(sizeof(wire::Replace), 37);
+    EXPECT_EQ(sizeof(wire::ExecReport), 50);
+}
+
+// Each message survives an encode/decode round trip through a byte buffer
+TEST(BinaryProtocolTest, RoundTrip) {
+    const wire::NewOrder new_order =
+        wire::make_new_order(42, 3, OrderSide::SELL, OrderType::LIMIT, 1234567, 15, TimeInForce::IOC, 6,
+                             SelfTradePrevention::DECREMENT);
+    std::vector<char> frame(sizeof(new_order));
+    std::memcpy(frame.data(), &new_order, frame.size());
+
+    wire::Message msg;
+    ASSERT_TRUE(wire::decode(frame.data(), frame.size(), msg));
+    ASSERT_EQ(msg.header.type, wire::MessageType::NEW_ORDER);
+    EXPECT_EQ(msg.new_order.order_id, 42);
+    EXPECT_EQ(msg.new_order.symbol_id, 3);
+    EXPECT_EQ(msg.new_order.side, static_cast<uint8_t>(OrderSide::SELL));
+    EXPECT_EQ(msg.new_order.time_in_force, static_cast<uint8_t>(TimeInForce::IOC));
+    EXPECT_EQ(msg.new_order.price, 1234567);
+    EXPECT_EQ(msg.new_order.quantity, 15);
+    EXPECT_EQ(msg.new_order.account_id, 6);
+    EXPECT_EQ(msg.new_order.self_trade_prevention, static_cast<uint8_t>(SelfTradePrevention::DECREMENT));
+
+    const wire::Cancel cancel = wire::make_cancel(42, 3);
+    ASSERT_TRUE(wire::decode(&cancel, sizeof(cancel), msg));
+    ASSERT_EQ(msg.header.type, wire::MessageType::CANCEL);
+    EXPECT_EQ(msg.cancel.order_id, 42);
+
+    const wire::Replace replace = wire::make_replace(42, 3, OrderSide::BUY, -5, 7, 6);
+    ASSERT_TRUE(wire::decode(&replace, sizeof(replace), msg));
+    ASSERT_EQ(msg.header.type, wire::MessageType::REPLACE);
+    EXPECT_EQ(msg.replace.price, -5);
+    EXPECT_EQ(msg.replace.quantity, 7);
+    EXPECT_EQ(msg.replace.account_id, 6);
+
+    const wire::ExecReport report =
+        wire::make_exec_report(42, 9, 3, wire::ExecType::PARTIAL_FILL, OrderSide::BUY, 100, 4, 3);
+    ASSERT_TRUE(wire::decode(&report, sizeof(report), msg));
+    ASSERT_EQ(msg.header.type, wire::MessageType::EXEC_REPORT);
+    EXPECT_EQ(msg.exec_report.exec_type, wire::ExecType::PARTIAL_FILL);
+    EXPECT_EQ(msg.exec_report.leaves_quantity, 3);
+}
+
+// Truncated, mislabelled and out-of-range frames are rejected
+TEST(BinaryProtocolTest, RejectsMalformedFrames) {
+    wire::Message msg;
+    wire::NewOrder new_order = wire::make_new_order(1, 0, OrderSide::BUY, OrderType::LIMIT, 100, 1);
+
+    EXPECT_FALSE(wire::decode(&new_order, 2, msg));
+    EXPECT_FALSE(wire::decode(&new_order, sizeof(new_order) - 1, msg));
+
+    wire::NewOrder wrong_type = new_order;
+    wrong_type.header.type = wire::MessageType::CANCEL;
+    EXPECT_FALSE(wire::decode(&wrong_type, sizeof(wrong_type), msg));
+
+    wire::NewOrder wrong_version = new_order;
+    wrong_version.header.version = wire::kProtocolVersion + 1;
+    EXPECT_FALSE(wire::decode(&wrong_version, sizeof(wrong_version), msg));
+
+    wire::NewOrder bad_side = new_order;
+    bad_side.side = 7;
+    EXPECT_FALSE(wire::decode(&bad_side, sizeof(bad_side), msg));
+
+    wire::NewOrder bad_mode = new_order;
+    bad_mode.self_trade_prevention = 5;
+    EXPECT_FALSE(wire::decode(&bad_mode, sizeof(bad_mode), msg));
+}
@@ -0,0 +1,397 @@
+#include <gtest/gtest.h>
+#include "order_book/BookManager.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+BookManagerConfig two_shard_config() {
+    BookManagerConfig config;
+    config.num_shards = 2;
+    config.queue_capacity = 1024;
+    config.pin_threads = false;
+    return config;
+}
+
+OrderCommand limit(SymbolId symbol_id, uint64_t id, OrderSide side, Price price, uint64_t quantity) {
+    return OrderCommand::new_order(Order(id, symbol_id, OrderType::LIMIT, side, price, quantity));
+}
+
+} // namespace
+
+// Symbols are dealt round-robin, so two symbols land on different shards
+TEST(BookManagerTest, AssignsSymbolsAcrossShards) {
+    BookManager manager(two_shard_config());
+    SymbolId first = manager.add_symbol("SHARD-A");
+    SymbolId second = manager.add_symbol("SHARD-B");
+
+    EXPECT_NE(manager.shard_of(first), manager.shard_of(second));
+    EXPECT_NE(manager.book(first), manager.book(second));
+    EXPECT_EQ(manager.book(SymbolTable::instance().intern("SHARD-UNKNOWN")), nullptr);
+}
+
+// Identical prices on different symbols must never cross each other
+TEST(BookManagerTest, RoutesCommandsToPerSymbolBooks) {
+    BookManager manager(two_shard_config());
+    SymbolId btc = manager.add_symbol("ROUTE-BTC");
+    SymbolId eth = manager.add_symbol("ROUTE-ETH");
+
+    std::mutex trades_mutex;
+    std::vector<Trade> trades;
+    manager.on_trade([&](const Trade& trade) {
+        std::lock_guard<std::mutex> lock(trades_mutex);
+        trades.push_back(trade);
+    });
+
+    manager.start();
+    ASSERT_TRUE(manager.submit(limit(btc, 1, OrderSide::BUY, 10000, 5)));
+    ASSERT_TRUE(manager.submit(limit(eth, 2, OrderSide::SELL, 10000, 5)));
+    ASSERT_TRUE(manager.submit(limit(btc, 3, OrderSide::SELL, 10000, 2)));
+    ASSERT_TRUE(manager.submit(limit(eth, 4, OrderSide::BUY, 9999, 1)));
+    ASSERT_TRUE(manager.submit(OrderCommand::cancel(eth, 4)));
+    manager.stop();
+
+    EXPECT_EQ(manager.processed(), 5);
+    EXPECT_EQ(manager.rejected(), 0);
+    ASSERT_EQ(trades.size(), 1);
+    EXPECT_EQ(trades[0].quantity, 2);
+
+    auto btc_bids = manager.book(btc)->get_depth(OrderSide::BUY);
+    ASSERT_EQ(btc_bids.size(), 1);
+    EXPECT_EQ(btc_bids[0].second, 3);
+    EXPECT_TRUE(manager.book(eth)->get_depth(OrderSide::BUY).empty());
+    EXPECT_EQ(manager.book(eth)->get_depth(OrderSide::SELL).size(), 1);
+}
+
+// A FOK order the book cannot fill is reported as not accepted and counted as
+// rejected, so the sender learns it was killed
+TEST(BookManagerTest, ReportsKilledFillOrKill) {
+    BookManagerConfig config = two_shard_config();
+    config.report_order_status = true;
+    BookManager manager(config);
+    SymbolId btc = manager.add_symbol("FOK-BTC");
+    ExecutionSubscription feed = manager.subscribe_executions();
+
+    manager.start();
+    ASSERT_TRUE(manager.submit(limit(btc, 1, OrderSide::SELL, 10000, 3)));
+    OrderCommand fok = limit(btc, 2, OrderSide::BUY, 10000, 5);
+    fok.time_in_force = TimeInForce::FOK;
+    ASSERT_TRUE(manager.submit(fok));
+    manager.stop();
+
+    EXPECT_EQ(manager.processed(), 2);
+    EXPECT_EQ(manager.rejected(), 1);
+    ExecutionReport reports[8];
+    ASSERT_EQ(feed.poll(reports, 8), 2);
+    EXPECT_EQ(reports[1].type, ExecutionType::ORDER_STATUS);
+    EXPECT_EQ(reports[1].status.command.order_id, 2);
+    EXPECT_FALSE(reports[1].status.accepted);
+    EXPECT_EQ(reports[1].status.remaining_quantity, 0);
+    EXPECT_EQ(manager.book(btc)->get_depth(OrderSide::SELL)[0].second, 3);
+}
+
+TEST(BookManagerTest, RejectsUnknownSymbols) {
+    BookManager manager(two_shard_config());
+    SymbolId stray = SymbolTable::instance().intern("ROUTE-STRAY");
+    EXPECT_FALSE(manager.submit(limit(stray, 1, OrderSide::BUY, 100, 1)));
+}
+
+// Each subscriber gets every fill with its symbol, aggressor side and accounts
+TEST(BookManagerTest, PublishesExecutionReportsToEverySubscriber) {
+    BookManager manager(two_shard_config());
+    SymbolId btc = manager.add_symbol("EXEC-BTC");
+    SymbolId eth = manager.add_symbol("EXEC-ETH");
+    ExecutionSubscription risk_feed = manager.subscribe_executions();
+    ExecutionSubscription gui_feed = manager.subscribe_executions();
+    ASSERT_TRUE(risk_feed.valid());
+    ASSERT_TRUE(gui_feed.valid());
+
+    manager.start();
+    ASSERT_TRUE(manager.submit(limit(btc, 1, OrderSide::BUY, 10000, 5)));
+    ASSERT_TRUE(manager.submit(limit(btc, 2, OrderSide::SELL, 10000, 2)));
+    OrderCommand resting = limit(eth, 3, OrderSide::SELL, 500, 4);
+    resting.account_id = 2;
+    OrderCommand aggressor = limit(eth, 4, OrderSide::BUY, 500, 4);
+    aggressor.account_id = 1;
+    ASSERT_TRUE(manager.submit(resting));
+    ASSERT_TRUE(manager.submit(aggressor));
+    manager.stop();
+
+    for (ExecutionSubscription* feed : {&risk_feed, &gui_feed}) {
+        ExecutionReport reports[8];
+        size_t count = 0;
+        size_t polled;
+        while ((polled = feed->poll(reports + count, 8 - count)) > 0) {
+            count += polled;
+        }
+        ASSERT_EQ(count, 2);
+        EXPECT_TRUE(feed->caught_up());
+        EXPECT_EQ(feed->published(), 2);
+        for (size_t i = 0; i < count; ++i) {
+            const ExecutionReport& report = reports[i];
+            if (report.trade.symbol_id == btc) {
+                EXPECT_EQ(report.trade.aggressor_side, OrderSide::SELL);
+                EXPECT_EQ(report.trade.aggressive_order_id, 2);
+                EXPECT_EQ(report.trade.quantity, 2);
+            } else {
+                EXPECT_EQ(report.trade.symbol_id, eth);
+                EXPECT_EQ(report.trade.aggressor_side, OrderSide::BUY);
+                EXPECT_EQ(report.trade.resting_order_id, 3);
+                EXPECT_EQ(report.trade.resting_account, 2);
+                EXPECT_EQ(report.trade.aggressive_account, 1);
+                EXPECT_EQ(report.trade.buyer(), 1);
+                EXPECT_EQ(report.trade.seller(), 2);
+            }
+        }
+    }
+    EXPECT_EQ(manager.execution_overflows(), 0);
+    // A later subscription counts only what is published after it
+    EXPECT_EQ(manager.subscribe_executions().published(), 0);
+}
+
+// Self-trade prevention cuts reach execution subscribers alongside fills
+TEST(BookManagerTest, PublishesSelfTradeCancels) {
+    BookManager manager(two_shard_config());
+    SymbolId btc = manager.add_symbol("STP-BTC");
+    ExecutionSubscription feed = manager.subscribe_executions();
+
+    manager.start();
+    OrderCommand resting = limit(btc, 1, OrderSide::SELL, 10000, 5);
+    resting.account_id = 3;
+    OrderCommand incoming = limit(btc, 2, OrderSide::BUY, 10000, 2);
+    incoming.account_id = 3;
+    incoming.self_trade_prevention = SelfTradePrevention::DECREMENT;
+    ASSERT_TRUE(manager.submit(resting));
+    ASSERT_TRUE(manager.submit(incoming));
+    manager.stop();
+
+    ExecutionReport reports[4];
+    size_t count = 0;
+    size_t polled;
+    while ((polled = feed.poll(reports + count, 4 - count)) > 0) {
+        count += polled;
+    }
+    ASSERT_EQ(count, 2);
+    for (size_t i = 0; i < count; ++i) {
+        const ExecutionReport& report = reports[i];
+        EXPECT_EQ(report.type, ExecutionType::SELF_TRADE_CANCEL);
+        EXPECT_EQ(report.cancel.symbol_id, btc);
+        EXPECT_EQ(report.cancel.account_id, 3);
+        EXPECT_EQ(report.cancel.quantity, 2);
+    }
+    EXPECT_NE(reports[0].cancel.resting, reports[1].cancel.resting);
+    EXPECT_EQ(manager.book(btc)->get_depth(OrderSide::SELL)[0].second, 3);
+    EXPECT_TRUE(manager.book(btc)->get_depth(OrderSide::BUY).empty());
+}
+
+// Quote subscribers get the starting best prices, then only best price changes
+TEST(BookManagerTest, PublishesBestPriceChanges) {
+    BookManager manager(two_shard_config());
+    SymbolId btc = manager.add_symbol("QUOTE-BTC");
+    QuoteSubscription quotes = manager.subscribe_quotes();
+    ASSERT_TRUE(quotes.valid());
+
+    manager.start();
+    ASSERT_TRUE(manager.submit(limit(btc, 1, OrderSide::BUY, 10000, 5)));
+    ASSERT_TRUE(manager.submit(limit(btc, 2, OrderSide::BUY, 9900, 5)));   // Behind the best bid
+    ASSERT_TRUE(manager.submit(limit(btc, 3, OrderSide::SELL, 10000, 2))); // Partial fill, bid unchanged
+    ASSERT_TRUE(manager.submit(limit(btc, 4, OrderSide::SELL, 10100, 1)));
+    ASSERT_TRUE(manager.submit(OrderCommand::cancel(btc, 1)));
+    manager.stop();
+
+    QuoteUpdate updates[8];
+    size_t count = 0;
+    size_t polled;
+    while ((polled = quotes.poll(updates + count, 8 - count)) > 0) {
+        count += polled;
+    }
+    ASSERT_EQ(count, 4);
+    EXPECT_FALSE(updates[0].has_bid || updates[0].has_ask);
+    EXPECT_TRUE(updates[1].has_bid);
+    EXPECT_DOUBLE_EQ(updates[1].best_bid, 100.0);
+    EXPECT_FALSE(updates[1].has_ask);
+    EXPECT_DOUBLE_EQ(updates[2].best_ask, 101.0);
+    EXPECT_DOUBLE_EQ(updates[3].best_bid, 99.0);
+    EXPECT_DOUBLE_EQ(updates[3].best_ask, 101.0);
+    for (size_t i = 0; i < count; ++i) {
+        EXPECT_EQ(updates[i].symbol_id, btc);
+    }
+}
+
+// Readers take depth snapshots while the shard matches, without book locks
+TEST(BookManagerTest, PublishesDepthSnapshotsWhileMatching) {
+    BookManager manager(two_shard_config());
+    SymbolId btc = manager.add_symbol("DEPTH-BTC");
+    const OrderBook& book = *manager.book(btc);
+
+    std::atomic<bool> done(false);
+    uint64_t inconsistent = 0;
+    uint64_t reads = 0;
+    std::thread reader([&]() {
+        uint64_t last_sequence = 0;
+        while (!done.load(std::memory_order_acquire)) {
+            const DepthSnapshot snapshot = book.depth_snapshot();
+            ++reads;
+            // A torn copy could show a crossed book or a sequence going backwards
+            const bool crossed = snapshot.bid_count > 0 && snapshot.ask_count > 0 &&
+                                 snapshot.bids[0].price >= snapshot.asks[0].price;
+            if (crossed || snapshot.sequence < last_sequence || snapshot.bid_count > DepthSnapshot::kLevels) {
+                ++inconsistent;
+            }
+            last_sequence = snapshot.sequence;
+        }
+    });
+
+    manager.start();
+    uint64_t id = 1;
+    for (int round = 0; round < 2000; ++round) {
+        for (Price offset = 1; offset <= 5; ++offset) {
+            while (!manager.submit(limit(btc, id, OrderSide::BUY, 10000 - offset, 10))) {}
+            ++id;
+            while (!manager.submit(limit(btc, id, OrderSide::SELL, 10000 + offset, 10))) {}
+            ++id;
+        }
+        // Take out the best ask so the book keeps trading
+        while (!manager.submit(limit(btc, id++, OrderSide::BUY, 10001, 10))) {}
+    }
+    manager.stop();
+    done.store(true, std::memory_order_release);
+    reader.join();
+
+    EXPECT_GT(reads, 0u);
+    EXPECT_EQ(inconsistent, 0u);
+    const DepthSnapshot final_snapshot = book.depth_snapshot();
+    EXPECT_EQ(final_snapshot.bid_count, 5);
+    EXPECT_DOUBLE_EQ(final_snapshot.bids[0].price, 99.99);
+    EXPECT_EQ(final_snapshot.bids[0].quantity, 2000 * 10);
+    EXPECT_DOUBLE_EQ(final_snapshot.last_trade_price, 100.01);
+    EXPECT_EQ(final_snapshot.last_trade_quantity, 10);
+}
+
+// Level changes within one batch reach the feed as one update per level,
+// carrying the level's final aggregate
+TEST(BookManagerTest, CoalescesLevelUpdatesWithinBatch) {
+    BookManagerConfig config = two_shard_config();
+    config.book_feed = BookFeedDepth::LEVELS;
+    BookManager manager(config);
+    SymbolId btc = manager.add_symbol("FEED-BTC");
+    BookUpdateSubscription feed = manager.subscribe_book_updates();
+
+    // Queued before start(), so the shard applies them all in its first batch
+    ASSERT_TRUE(manager.submit(limit(btc, 1, OrderSide::BUY, 10000, 5)));
+    ASSERT_TRUE(manager.submit(limit(btc, 2, OrderSide::BUY, 10000, 3)));
+    ASSERT_TRUE(manager.submit(limit(btc, 3, OrderSide::BUY, 9900, 4)));
+    ASSERT_TRUE(manager.submit(limit(btc, 4, OrderSide::SELL, 10000, 6)));
+    ASSERT_TRUE(manager.submit(OrderCommand::cancel(btc, 3)));
+    manager.start();
+    manager.stop();
+
+    std::vector<BookUpdate> levels;
+    size_t order_updates = 0;
+    BookUpdate batch[64];
+    size_t count;
+    while ((count = feed.poll(batch, 64)) > 0) {
+        for (size_t i = 0; i < count; ++i) {
+            if (batch[i].type == BookUpdateType::LEVEL) {
+                levels.push_back(batch[i]);
+            } else {
+                ++order_updates;
+            }
+        }
+    }
+
+    EXPECT_EQ(order_updates, 0);
+    ASSERT_EQ(levels.size(), 2);
+    EXPECT_EQ(levels[0].price, 10000);
+    EXPECT_EQ(levels[0].quantity, 2);
+    EXPECT_EQ(levels[0].order_count, 1);
+    EXPECT_EQ(levels[1].price, 9900);
+    EXPECT_EQ(levels[1].quantity, 0);
+    EXPECT_EQ(levels[1].order_count, 0);
+}
+
+// On the L3 feed a level's pending change goes out before the book's next
+// order update, so sequence order never puts an order event ahead of the
+// level change that preceded it
+TEST(BookManagerTest, OrderUpdatesFollowEarlierLevelChanges) {
+    BookManagerConfig config = two_shard_config();
+    config.book_feed = BookFeedDepth::ORDERS;
+    BookManager manager(config);
+    SymbolId btc = manager.add_symbol("FEED-L3");
+    BookUpdateSubscription feed = manager.subscribe_book_updates();
+
+    ASSERT_TRUE(manager.submit(limit(btc, 1, OrderSide::BUY, 10000, 5)));
+    ASSERT_TRUE(manager.submit(limit(btc, 2, OrderSide::BUY, 10000, 3)));
+    ASSERT_TRUE(manager.submit(limit(btc, 3, OrderSide::BUY, 9900, 4)));
+    ASSERT_TRUE(manager.submit(limit(btc, 4, OrderSide::SELL, 10000, 6)));
+    ASSERT_TRUE(manager.submit(OrderCommand::cancel(btc, 3)));
+    manager.start();
+    manager.stop();
+
+    std::vector<BookUpdate> updates;
+    BookUpdate batch[64];
+    size_t count;
+    while ((count = feed.poll(batch, 64)) > 0) {
+        updates.insert(updates.end(), batch, batch + count);
+    }
+
+    using T = BookUpdateType;
+    const std::vector<T> expected = {
+        T::LEVEL, T::ORDER_ADD,                      // 1 rests
+        T::LEVEL, T::ORDER_ADD,                      // 2 joins it
+        T::LEVEL, T::ORDER_ADD,                      // 3 rests lower
+        T::ORDER_DELETE, T::ORDER_MODIFY, T::LEVEL,  // 4 fills 1 and part of 2
+        T::LEVEL, T::ORDER_DELETE,                   // 3 is cancelled
+    };
+    ASSERT_EQ(updates.size(), expected.size());
+    for (size_t i = 0; i < updates.size(); ++i) {
+        EXPECT_EQ(updates[i].type, expected[i]) << "update " << i;
+        EXPECT_EQ(updates[i].sequence, i + 1);
+    }
+    EXPECT_EQ(updates[2].quantity, 8);
+    EXPECT_EQ(updates[8].quantity, 2);
+    EXPECT_EQ(updates[9].price, 9900);
+    EXPECT_EQ(updates[9].quantity, 0);
+}
+
+// A market data subscriber that stops polling costs it updates, not the shard
+// its progress; the book update sequence shows what it missed
+TEST(BookManagerTest, MarketDataRingsDropRatherThanStall) {
+    BookManagerConfig config = two_shard_config();
+    config.num_shards = 1;
+    config.book_feed = BookFeedDepth::ORDERS;
+    config.quote_ring_capacity = 4;
+    config.book_update_ring_capacity = 8;
+    BookManager manager(config);
+    SymbolId btc = manager.add_symbol("DROP-BTC");
+    QuoteSubscription quotes = manager.subscribe_quotes();
+    BookUpdateSubscription feed = manager.subscribe_book_updates();
+
+    // Every bid is a new best bid: one quote, one order add and one level each
+    for (uint64_t id = 1; id <= 50; ++id) {
+        ASSERT_TRUE(manager.submit(limit(btc, id, OrderSide::BUY, 10000 + static_cast<Price>(id), 1)));
+    }
+    manager.start();
+    while (manager.processed() < 50) {
+        std::this_thread::yield();
+    }
+
+    BookUpdate batch[64];
+    size_t count = feed.poll(batch, 64);
+    ASSERT_EQ(count, 8);
+    for (size_t i = 0; i < count; ++i) {
+        EXPECT_EQ(batch[i].sequence, i + 1);
+    }
+    ASSERT_TRUE(manager.submit(limit(btc, 51, OrderSide::BUY, 10100, 1)));
+    manager.stop();
+
+    count = feed.poll(batch, 64);
+    ASSERT_EQ(count, 2);
+    EXPECT_EQ(batch[0].sequence, 101);
+    EXPECT_EQ(batch[1].sequence, 102);
+    EXPECT_GT(manager.book_update_overflows(), 0u);
+    EXPECT_GT(manager.quote_overflows(), 0u);
+    EXPECT_EQ(manager.execution_overflows(), 0u);
+}
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include "common/BroadcastRing.h"
+#include <thread>
+#include <vector>
+
+// The slowest subscriber gates the producer; an unsubscribed one does not
+TEST(BroadcastRingTest, SlowestSubscriberGatesProducer) {
+    BroadcastRing<int> ring(4, 2);
+    const size_t fast = ring.subscribe();
+    const size_t slow = ring.subscribe();
+    ASSERT_NE(fast, BroadcastRing<int>::kNoSubscriber);
+    ASSERT_NE(slow, BroadcastRing<int>::kNoSubscriber);
+    EXPECT_EQ(ring.subscribe(), BroadcastRing<int>::kNoSubscriber);
+
+    int values[8];
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(ring.publish(i, OverflowPolicy::DROP_NEWEST));
+    }
+    ASSERT_EQ(ring.poll(fast, values, 8), 4);
+    EXPECT_EQ(values[3], 3);
+    EXPECT_FALSE(ring.publish(4, OverflowPolicy::DROP_NEWEST));
+    EXPECT_EQ(ring.overflow_count(), 1);
+
+    // Both subscribers read the same values independently
+    ASSERT_EQ(ring.poll(slow, values, 2), 2);
+    EXPECT_EQ(values[0], 0);
+    EXPECT_EQ(values[1], 1);
+    EXPECT_TRUE(ring.publish(5, OverflowPolicy::DROP_NEWEST));
+
+    ring.unsubscribe(slow);
+    EXPECT_TRUE(ring.publish(6, OverflowPolicy::DROP_NEWEST));
+    ASSERT_EQ(ring.poll(fast, values, 8), 2);
+    EXPECT_EQ(values[0], 5);
+    EXPECT_EQ(values[1], 6);
+    EXPECT_TRUE(ring.caught_up(fast));
+
+    // A new subscriber starts at the head
+    const size_t late = ring.subscribe();
+    EXPECT_EQ(ring.poll(late, values, 8), 0);
+}
+
+// Every subscriber sees every value once and in order while the producer spins on the slowest
+TEST(BroadcastRingTest, SubscribersDrainAcrossThreads) {
+    constexpr int kCount = 200000;
+    constexpr size_t kSubscribers = 3;
+    BroadcastRing<int> ring(256, kSubscribers);
+    std::vector<size_t> ids;
+    for (size_t i = 0; i < kSubscribers; ++i) {
+        ids.push_back(ring.subscribe());
+    }
+
+    std::vector<int> mismatches(kSubscribers, 0);
+    std::vector<std::thread> readers;
+    for (size_t s = 0; s < kSubscribers; ++s) {
+        readers.emplace_back([&, s]() {
+            int batch[32];
+            int expected = 0;
+            Backoff backoff;
+            while (expected < kCount) {
+                // Subscribers read in different batch sizes to drift apart
+                const size_t count = ring.poll(ids[s], batch, 8 << s);
+                if (count == 0) {
+                    backoff.idle();
+                    continue;
+                }
+                backoff.reset();
+                for (size_t i = 0; i < count; ++i) {
+                    mismatches[s] += batch[i] != expected++;
+                }
+            }
+        });
+    }
+    for (int i = 0; i < kCount; ++i) {
+        ring.publish(i, OverflowPolicy::SPIN);
+    }
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    for (size_t s = 0; s < kSubscribers; ++s) {
+        EXPECT_EQ(mismatches[s], 0);
+    }
+}
+
+// A subscriber joining while the producer runs reads an unbroken run of values
+// from wherever it starts
+TEST(BroadcastRingTest, LateSubscriberMissesNothingAfterItsStart) {
+    constexpr int kCount = 2000;
+    for (int round = 0; round < 10; ++round) {
+        BroadcastRing<int> ring(64, 1);
+        std::thread producer([&]() {
+            for (int i = 0; i < kCount; ++i) {
+                ring.publish(i, OverflowPolicy::SPIN);
+            }
+        });
+        const size_t id = ring.subscribe();
+        ASSERT_NE(id, BroadcastRing<int>::kNoSubscriber);
+        int values[16];
+        int expected = -1;
+        while (expected != kCount - 1) {
+            const size_t count = ring.poll(id, values, 16);
+            for (size_t i = 0; i < count; ++i) {
+                if (expected >= 0) {
+                    ASSERT_EQ(values[i], expected + 1);
+                }
+                expected = values[i];
+            }
+            if (count == 0 && ring.published() == static_cast<uint64_t>(kCount) && ring.caught_up(id)) {
+                break; // Subscribed after the last value
+            }
+        }
+        producer.join();
+    }
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include "order_book/BookManager.h"
+#include "persistence/Journal.h"
+#include <filesystem>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+// Fresh directory per test, removed on exit
+class JournalTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = std::filesystem::temp_directory_path() /
+               ("journal-test-" + std::to_string(getpid()) + "-" +
+                ::testing::UnitTest::GetInstance()->current_test_info()->name());
+        std::filesystem::remove_all(dir_);
+        std::filesystem::create_directories(dir_);
+    }
+    void TearDown() override { std::filesystem::remove_all(dir_); }
+
+    std::filesystem::path dir_;
+};
+
+BookManagerConfig journaled_config(const std::string& dir) {
+    BookManagerConfig config;
+    config.num_shards = 2;
+    config.queue_capacity = 1024;
+    config.pin_threads = false;
+    config.journal_dir = dir;
+    config.journal_config.initial_records = 16;
+    return config;
+}
+
+OrderCommand limit(SymbolId symbol_id, uint64_t id, OrderSide side, Price price, uint64_t quantity) {
+    return OrderCommand::new_order(Order(id, symbol_id, OrderType::LIMIT, side, price, quantity));
+}
+
+} // namespace
+
+// Appends survive a reopen, including past the initial size, and continue the sequence
+TEST_F(JournalTest, ReopensWithRecordsIntact) {
+    JournalConfig config;
+    config.initial_records = 4;
+    const std::string path = (dir_ / "events.journal").string();
+    std::string error;
+    {
+        Journal journal(config);
+        ASSERT_TRUE(journal.open(path, error)) << error;
+        journal.append_symbol(7, "JRNL-A");
+        for (uint64_t id = 1; id <= 5; ++id) {
+            Order order(id, 7, OrderType::LIMIT, OrderSide::BUY, 100 + id, id * 10);
+            order.account_id = static_cast<AccountId>(id);
+            journal.append_order(order);
+        }
+        journal.append_cancel(7, 3);
+        Trade trade(1, 2, 9, 101.5, 4);
+        trade.symbol_id = 7;
+        trade.aggressor_side = OrderSide::SELL;
+        trade.resting_account = 3;
+        trade.aggressive_account = 5;
+        journal.append_trade(trade);
+        EXPECT_EQ(journal.size(), 8);
+    }
+
+    Journal journal(config);
+    ASSERT_TRUE(journal.open(path, error)) << error;
+    ASSERT_EQ(journal.size(), 8);
+    journal.append_cancel(7, 4);
+    EXPECT_EQ(journal.size(), 9);
+
+    std::vector<JournalRecord> records;
+    journal.for_each([&](const JournalRecord& record) { records.push_back(record); });
+    ASSERT_EQ(records.size(), 9);
+    for (size_t i = 0; i < records.size(); ++i) {
+        EXPECT_EQ(records[i].sequence, i + 1);
+    }
+    EXPECT_EQ(records[0].type, JournalRecordType::SYMBOL);
+    EXPECT_STREQ(records[0].body.symbol_name, "JRNL-A");
+    EXPECT_EQ(records[5].type, JournalRecordType::ORDER);
+    EXPECT_EQ(records[5].body.order.price, 105);
+    EXPECT_EQ(records[5].body.order.quantity, 50);
+    EXPECT_EQ(records[5].body.order.account_id, 5);
+    EXPECT_EQ(records[6].type, JournalRecordType::CANCEL);
+    EXPECT_EQ(records[6].body.order.order_id, 3);
+    EXPECT_EQ(records[7].type, JournalRecordType::TRADE);
+    EXPECT_EQ(static_cast<OrderSide>(records[7].side), OrderSide::SELL);
+    EXPECT_DOUBLE_EQ(records[7].body.trade.price, 101.5);
+    EXPECT_EQ(records[7].body.trade.aggressive_order_id, 9);
+    EXPECT_EQ(records[7].body.trade.resting_account, 3);
+    EXPECT_EQ(records[7].body.trade.aggressive_account, 5);
+}
+
+// A second manager recovers the books, modifies and trades of the first one
+TEST_F(JournalTest, BookManagerRecoversFromJournal) {
+    std::vector<Trade> live_trades;
+    {
+        BookManager manager(journaled_config(dir_.string()));
+        SymbolId btc = manager.add_symbol("JRNL-BTC");
+        SymbolId eth = manager.add_symbol("JRNL-ETH");
+        manager.on_trade([&](const Trade& trade) { live_trades.push_back(trade); });
+        manager.start();
+        ASSERT_TRUE(manager.submit(limit(btc, 1, OrderSide::BUY, 10000, 5)));
+        ASSERT_TRUE(manager.submit(limit(btc, 2, OrderSide::SELL, 10000, 2)));
+        ASSERT_TRUE(manager.submit(limit(eth, 3, OrderSide::SELL, 500, 7)));
+        ASSERT_TRUE(manager.submit(limit(eth, 4, OrderSide::BUY, 400, 1)));
+        ASSERT_TRUE(manager.submit(OrderCommand::cancel(eth, 4)));
+        ASSERT_TRUE(manager.submit(OrderCommand::modify(eth, 3, 510, 6)));
+        manager.stop();
+    }
+    ASSERT_EQ(live_trades.size(), 1);
+
+    // Registered in the opposite order, so ids differ from the journaled ones
+    BookManager manager(journaled_config(dir_.string()));
+    SymbolId eth = manager.add_symbol("JRNL-ETH");
+    SymbolId btc = manager.add_symbol("JRNL-BTC");
+    bool live_callback = false;
+    manager.on_trade([&](const Trade&) { live_callback = true; });
+
+    std::vector<Trade> recovered_trades;
+    const RecoveryStats stats = manager.recover([&](const Trade& trade) { recovered_trades.push_back(trade); });
+
+    EXPECT_FALSE(live_callback);
+    EXPECT_EQ(stats.max_order_id, 4);
+    ASSERT_EQ(recovered_trades.size(), 1);
+    EXPECT_EQ(recovered_trades[0].quantity, live_trades[0].quantity);
+    EXPECT_EQ(recovered_trades[0].resting_order_id, 1);
+    EXPECT_EQ(recovered_trades[0].symbol_id, btc);
+    EXPECT_EQ(recovered_trades[0].aggressor_side, OrderSide::SELL);
+    EXPECT_EQ(recovered_trades[0].resting_account, live_trades[0].resting_account);
+    EXPECT_EQ(recovered_trades[0].aggressive_account, live_trades[0].aggressive_account);
+
+    auto btc_bids = manager.book(btc)->get_depth(OrderSide::BUY);
+    ASSERT_EQ(btc_bids.size(), 1);
+    EXPECT_EQ(btc_bids[0].second, 3);
+    EXPECT_TRUE(manager.book(eth)->get_depth(OrderSide::BUY).empty());
+    auto eth_asks = manager.book(eth)->get_depth(OrderSide::SELL);
+    ASSERT_EQ(eth_asks.size(), 1);
+    EXPECT_DOUBLE_EQ(eth_asks[0].first, 5.10);
+    EXPECT_EQ(eth_asks[0].second, 6);
+}
@@ -0,0 +1,35 @@
+#include <gtest/gtest.h>
+#include "common/LatencyHistogram.h"
+
+// Small values are exact and percentiles pick the right rank
+TEST(LatencyHistogramTest, ExactBelowThirtyTwo) {
+    LatencyHistogram histogram;
+    for (uint64_t v = 1; v <= 20; ++v) {
+        histogram.record(v);
+    }
+    EXPECT_EQ(histogram.count(), 20);
+    EXPECT_EQ(histogram.min(), 1);
+    EXPECT_EQ(histogram.max(), 20);
+    EXPECT_EQ(histogram.percentile(50), 10);
+    EXPECT_EQ(histogram.percentile(100), 20);
+    EXPECT_DOUBLE_EQ(histogram.mean(), 10.5);
+}
+
+// Large values land within the bucket precision, tails included
+TEST(LatencyHistogramTest, RelativePrecisionAndMerge) {
+    LatencyHistogram a;
+    LatencyHistogram b;
+    for (uint64_t v = 1; v <= 10000; ++v) {
+        (v % 2 ? a : b).record(v * 1000);
+    }
+    a.merge(b);
+    EXPECT_EQ(a.count(), 10000);
+
+    const uint64_t p50 = a.percentile(50);
+    const uint64_t p999 = a.percentile(99.9);
+    EXPECT_GE(p50, 5000000u);
+    EXPECT_LE(p50, 5000000u * 104 / 100);
+    EXPECT_GE(p999, 9990000u);
+    EXPECT_LE(p999, 10000000u);
+    EXPECT_EQ(a.percentile(100), 10000000u);
+}
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include "order_book/LevelUpdateBatch.h"
+#include <vector>
+
+namespace {
+
+BookUpdate level(SymbolId symbol_id, OrderSide side, Price price, uint64_t quantity) {
+    BookUpdate update;
+    update.type = BookUpdateType::LEVEL;
+    update.symbol_id = symbol_id;
+    update.side = side;
+    update.price = price;
+    update.quantity = quantity;
+    update.order_count = quantity > 0 ? 1 : 0;
+    return update;
+}
+
+} // namespace
+
+// Levels are kept once each, in first-change order, with their latest aggregate
+TEST(LevelUpdateBatchTest, KeepsLatestUpdatePerLevel) {
+    LevelUpdateBatch batch;
+    EXPECT_TRUE(batch.empty());
+    batch.record(level(1, OrderSide::BUY, 100, 5));
+    batch.record(level(1, OrderSide::SELL, 100, 7)); // Same price, other side
+    batch.record(level(2, OrderSide::BUY, 100, 3));  // Same price, other book
+    batch.record(level(1, OrderSide::BUY, 100, 0));
+
+    const std::vector<BookUpdate>& updates = batch.updates();
+    ASSERT_EQ(updates.size(), 3);
+    EXPECT_EQ(updates[0].side, OrderSide::BUY);
+    EXPECT_EQ(updates[0].quantity, 0);
+    EXPECT_EQ(updates[0].order_count, 0);
+    EXPECT_EQ(updates[1].side, OrderSide::SELL);
+    EXPECT_EQ(updates[1].quantity, 7);
+    EXPECT_EQ(updates[2].symbol_id, 2);
+
+    batch.clear();
+    EXPECT_TRUE(batch.empty());
+    batch.record(level(1, OrderSide::BUY, 100, 9));
+    ASSERT_EQ(batch.updates().size(), 1);
+    EXPECT_EQ(batch.updates()[0].quantity, 9);
+}
+
+// A sweep through thousands of levels grows the table and still finds every
+// level, across batches
+TEST(LevelUpdateBatchTest, GrowsThroughWideSweeps) {
+    LevelUpdateBatch batch;
+    for (int round = 0; round < 3; ++round) {
+        for (Price price = 0; price < 5000; ++price) {
+            batch.record(level(4, OrderSide::SELL, 10000 + price, 1));
+        }
+        for (Price price = 0; price < 5000; ++price) {
+            batch.record(level(4, OrderSide::SELL, 10000 + price, static_cast<uint64_t>(price) + 2));
+        }
+        const std::vector<BookUpdate>& updates = batch.updates();
+        ASSERT_EQ(updates.size(), 5000);
+        for (Price price = 0; price < 5000; ++price) {
+            ASSERT_EQ(updates[price].price, 10000 + price);
+            ASSERT_EQ(updates[price].quantity, static_cast<uint64_t>(price) + 2);
+        }
+        batch.clear();
+    }
+}
@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include "common/Logger.h"
+#include <cstdio>
+#include <string>
+#include <thread>
+
+namespace {
+
+// Runs `body` with the logger writing into a temporary file and returns what was written
+template <typename Fn>
+std::string capture_log(Fn&& body) {
+    FILE* sink = std::tmpfile();
+    Logger::instance().start(sink);
+    body();
+    Logger::instance().stop();
+
+    std::string output;
+    std::rewind(sink);
+    char chunk[256];
+    size_t read;
+    while ((read = std::fread(chunk, 1, sizeof(chunk), sink)) > 0) {
+        output.append(chunk, read);
+    }
+    std::fclose(sink);
+    return output;
+}
+
+} // namespace
+
+// Records from several threads are formatted on the writer and filtered by level
+TEST(LoggerTest, FormatsRecordsAndFiltersLevels) {
+    Logger::instance().set_level(LogLevel::INFO);
+    const std::string output = capture_log([]() {
+        const std::string symbol = "LOG-TEST";
+        LOG_INFO("filled %s %d @ %.2f", symbol.c_str(), 7, 101.5);
+        LOG_DEBUG("hidden %d", 1);
+        std::thread worker([]() { LOG_WARN("from worker %u", 42u); });
+        worker.join();
+    });
+    Logger::instance().set_level(LogLevel::INFO);
+
+    EXPECT_NE(output.find("INFO  filled LOG-TEST 7 @ 101.50\n"), std::string::npos);
+    EXPECT_NE(output.find("WARN  from worker 42\n"), std::string::npos);
+    EXPECT_EQ(output.find("hidden"), std::string::npos);
+}
+
+// Strings that do not fit in one record are truncated rather than overflowing it
+TEST(LoggerTest, TruncatesLongStrings) {
+    const std::string long_text(1000, 'x');
+    const std::string output = capture_log([&]() {
+        LOG_ERROR("long %s end %d", long_text.c_str(), 5);
+    });
+
+    const size_t start = output.find("long ");
+    ASSERT_NE(start, std::string::npos);
+    EXPECT_NE(output.find(" end 5\n", start), std::string::npos);
+    EXPECT_LT(output.size(), 512u);
+}
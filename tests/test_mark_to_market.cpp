@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include "risk/MarkToMarket.h"
+#include <cmath>
+#include <random>
+
+namespace {
+
+QuoteUpdate quote(SymbolId symbol_id, double bid, double ask) {
+    QuoteUpdate update;
+    update.symbol_id = symbol_id;
+    update.best_bid = bid;
+    update.best_ask = ask;
+    update.has_bid = bid > 0.0;
+    update.has_ask = ask > 0.0;
+    return update;
+}
+
+Position position(long long net_position, double avg_entry_price, double realized_pnl) {
+    Position p;
+    p.net_position = net_position;
+    p.avg_entry_price = avg_entry_price;
+    p.realized_pnl = realized_pnl;
+    return p;
+}
+
+} // namespace
+
+// P&L follows the mid, exposure follows the position, drawdown is measured from the peak
+TEST(MarkToMarketTest, MarksPositionsToTheMid) {
+    MarkToMarket marks(16);
+    marks.on_position(1, position(10, 100.0, 5.0));
+    EXPECT_DOUBLE_EQ(marks.symbol(1).exposure, 1000.0); // At cost before any quote
+    EXPECT_DOUBLE_EQ(marks.portfolio().unrealized_pnl, 0.0);
+
+    marks.on_quote(quote(1, 104.0, 106.0));
+    EXPECT_DOUBLE_EQ(marks.symbol(1).mark_price, 105.0);
+    EXPECT_DOUBLE_EQ(marks.symbol(1).unrealized_pnl, 50.0);
+
+    marks.on_position(2, position(-4, 50.0, 0.0));
+    marks.on_quote(quote(2, 0.0, 45.0)); // Only an ask: mark at the ask
+    PortfolioMark portfolio = marks.portfolio();
+    EXPECT_DOUBLE_EQ(portfolio.unrealized_pnl, 70.0);
+    EXPECT_DOUBLE_EQ(portfolio.realized_pnl, 5.0);
+    EXPECT_DOUBLE_EQ(portfolio.gross_exposure, 1050.0 + 180.0);
+    EXPECT_DOUBLE_EQ(portfolio.net_exposure, 1050.0 - 180.0);
+    EXPECT_DOUBLE_EQ(portfolio.peak_pnl, 75.0);
+
+    marks.on_quote(quote(1, 98.0, 100.0)); // Symbol 1 now loses 10
+    portfolio = marks.portfolio();
+    EXPECT_DOUBLE_EQ(portfolio.unrealized_pnl, 10.0);
+    EXPECT_DOUBLE_EQ(portfolio.drawdown, 60.0);
+
+    marks.on_quote(quote(1, 0.0, 0.0)); // An empty book keeps the last mark
+    EXPECT_DOUBLE_EQ(marks.symbol(1).mark_price, 99.0);
+    marks.on_quote(quote(1, 110.0, 112.0));
+    portfolio = marks.portfolio();
+    EXPECT_DOUBLE_EQ(portfolio.drawdown, 0.0);
+    EXPECT_DOUBLE_EQ(portfolio.max_drawdown, 60.0);
+}
+
+// The running totals match a full revaluation after many incremental updates
+TEST(MarkToMarketTest, IncrementalTotalsMatchFullRevaluation) {
+    constexpr SymbolId kSymbols = 32;
+    MarkToMarket marks(kSymbols);
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> symbol(0, kSymbols - 1);
+    std::uniform_int_distribution<int> size(-50, 50);
+    std::uniform_real_distribution<double> price(90.0, 110.0);
+
+    for (int i = 0; i < 20000; ++i) {
+        const SymbolId id = static_cast<SymbolId>(symbol(rng));
+        if (i % 4 == 0) {
+            marks.on_position(id, position(size(rng), price(rng), price(rng) - 100.0));
+        } else {
+            const double bid = price(rng);
+            marks.on_quote(quote(id, bid, bid + 0.5));
+        }
+    }
+
+    double unrealized = 0.0;
+    double realized = 0.0;
+    double gross = 0.0;
+    double net = 0.0;
+    for (SymbolId id = 0; id < kSymbols; ++id) {
+        const SymbolMark mark = marks.symbol(id);
+        unrealized += mark.unrealized_pnl;
+        realized += mark.realized_pnl;
+        gross += std::abs(mark.exposure);
+        net += mark.exposure;
+    }
+    const PortfolioMark portfolio = marks.portfolio();
+    EXPECT_NEAR(portfolio.unrealized_pnl, unrealized, 1e-6);
+    EXPECT_NEAR(portfolio.realized_pnl, realized, 1e-6);
+    EXPECT_NEAR(portfolio.gross_exposure, gross, 1e-6);
+    EXPECT_NEAR(portfolio.net_exposure, net, 1e-6);
+}
@@ -0,0 +1,310 @@
+#include <gtest/gtest.h>
+#include "market_data/MarketDataFeed.h"
+#include "market_data/MarketDataPublisher.h"
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+BookUpdate level_update(Price price, uint64_t quantity, uint32_t order_count) {
+    BookUpdate update;
+    update.type = BookUpdateType::LEVEL;
+    update.side = OrderSide::SELL;
+    update.symbol_id = 7;
+    update.price = price;
+    update.quantity = quantity;
+    update.order_count = order_count;
+    return update;
+}
+
+int connect_client(const std::string& path) {
+    const int client = ::socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    if (client >= 0 && ::connect(client, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(client);
+        return -1;
+    }
+    return client;
+}
+
+BookUpdate order_update(BookUpdateType type, uint64_t order_id, Price price, uint64_t quantity) {
+    BookUpdate update;
+    update.type = type;
+    update.side = OrderSide::BUY;
+    update.symbol_id = 3;
+    update.order_id = order_id;
+    update.price = price;
+    update.quantity = quantity;
+    return update;
+}
+
+} // namespace
+
+// Messages keep their fixed wire sizes
+TEST(MarketDataFeedTest, FixedLayout) {
+    EXPECT_EQ(sizeof(md::PacketHeader), 14);
+    EXPECT_EQ(sizeof(md::LevelMessage), 26);
+    EXPECT_EQ(sizeof(md::OrderMessage), 30);
+    EXPECT_EQ(sizeof(md::OrderDeleteMessage), 14);
+}
+
+// Updates split across packets decode in order with contiguous sequence numbers
+TEST(MarketDataFeedTest, RoundTripAcrossPackets) {
+    std::vector<std::vector<uint8_t>> packets;
+    md::FeedEncoder encoder([&](const uint8_t* data, size_t size) { packets.emplace_back(data, data + size); },
+                            sizeof(md::PacketHeader) + 2 * sizeof(md::OrderMessage));
+
+    const std::vector<BookUpdate> sent = {
+        level_update(10100, 40, 3),
+        order_update(BookUpdateType::ORDER_ADD, 11, 9900, 5),
+        order_update(BookUpdateType::ORDER_MODIFY, 11, 9900, 2),
+        order_update(BookUpdateType::ORDER_DELETE, 11, 9900, 2),
+        level_update(10100, 0, 0),
+    };
+    for (const BookUpdate& update : sent) {
+        encoder.add(update);
+    }
+    encoder.flush();
+    encoder.flush(); // Nothing buffered, so no empty packet
+    EXPECT_EQ(encoder.next_sequence(), 6);
+    ASSERT_EQ(packets.size(), 3);
+
+    std::vector<BookUpdate> received;
+    uint64_t expected_sequence = 1;
+    for (const auto& packet : packets) {
+        uint64_t first_sequence = 0;
+        const size_t before = received.size();
+        ASSERT_TRUE(md::decode_packet(packet.data(), packet.size(), first_sequence, received));
+        EXPECT_EQ(first_sequence, expected_sequence);
+        expected_sequence += received.size() - before;
+    }
+
+    ASSERT_EQ(received.size(), sent.size());
+    for (size_t i = 0; i < sent.size(); ++i) {
+        EXPECT_EQ(received[i].type, sent[i].type);
+        EXPECT_EQ(received[i].side, sent[i].side);
+        EXPECT_EQ(received[i].symbol_id, sent[i].symbol_id);
+        EXPECT_EQ(received[i].order_id, sent[i].order_id);
+        EXPECT_EQ(received[i].order_count, sent[i].order_count);
+    }
+    EXPECT_EQ(received[0].price, 10100);
+    EXPECT_EQ(received[0].quantity, 40);
+    EXPECT_EQ(received[2].price, 9900);
+    EXPECT_EQ(received[2].quantity, 2);
+    // Deletes carry only the order's identity
+    EXPECT_EQ(received[3].price, 0);
+    EXPECT_EQ(received[3].quantity, 0);
+}
+
+// Skipped numbers end the current packet and leave a gap before the next
+TEST(MarketDataFeedTest, SkipLeavesSequenceGap) {
+    std::vector<uint64_t> first_sequences;
+    md::FeedEncoder encoder([&](const uint8_t* data, size_t size) {
+        uint64_t first_sequence = 0;
+        std::vector<BookUpdate> out;
+        ASSERT_TRUE(md::decode_packet(data, size, first_sequence, out));
+        first_sequences.push_back(first_sequence);
+    });
+    encoder.add(level_update(10000, 1, 1));
+    encoder.add(level_update(10100, 1, 1));
+    encoder.skip(3);
+    encoder.add(level_update(10200, 1, 1));
+    encoder.flush();
+
+    ASSERT_EQ(first_sequences.size(), 2);
+    EXPECT_EQ(first_sequences[0], 1);
+    EXPECT_EQ(first_sequences[1], 6);
+    EXPECT_EQ(encoder.next_sequence(), 7);
+}
+
+// Truncated, mislabelled or unknown content is refused without partial output
+TEST(MarketDataFeedTest, RejectsMalformedPackets) {
+    std::vector<uint8_t> packet;
+    md::FeedEncoder encoder([&](const uint8_t* data, size_t size) { packet.assign(data, data + size); });
+    encoder.add(level_update(10000, 1, 1));
+    encoder.add(order_update(BookUpdateType::ORDER_ADD, 1, 10000, 1));
+    encoder.flush();
+
+    std::vector<BookUpdate> out;
+    uint64_t first_sequence = 0;
+    ASSERT_TRUE(md::decode_packet(packet.data(), packet.size(), first_sequence, out));
+    out.clear();
+
+    EXPECT_FALSE(md::decode_packet(packet.data(), sizeof(md::PacketHeader) - 1, first_sequence, out));
+    EXPECT_FALSE(md::decode_packet(packet.data(), packet.size() - 1, first_sequence, out));
+
+    std::vector<uint8_t> bad = packet;
+    bad[0] = md::kFeedVersion + 1;
+    EXPECT_FALSE(md::decode_packet(bad.data(), bad.size(), first_sequence, out));
+
+    bad = packet;
+    bad[sizeof(md::PacketHeader) + sizeof(md::LevelMessage)] = 0x7f; // Unknown message type
+    EXPECT_FALSE(md::decode_packet(bad.data(), bad.size(), first_sequence, out));
+
+    bad = packet;
+    bad[sizeof(md::PacketHeader) + 1] = 9; // No such side
+    EXPECT_FALSE(md::decode_packet(bad.data(), bad.size(), first_sequence, out));
+
+    EXPECT_TRUE(out.empty());
+    EXPECT_EQ(first_sequence, 1);
+}
+
+// A client on the UNIX socket receives the manager's book updates as packets
+TEST(MarketDataFeedTest, PublishesToSocketClients) {
+    BookManagerConfig config;
+    config.num_shards = 1;
+    config.queue_capacity = 64;
+    config.pin_threads = false;
+    config.book_feed = BookFeedDepth::LEVELS;
+    BookManager manager(config);
+    SymbolId btc = manager.add_symbol("MD-FEED-BTC");
+
+    const std::string path = "/tmp/md_feed_test_" + std::to_string(::getpid()) + ".sock";
+    MarketDataPublisher publisher(manager);
+    std::string error;
+    ASSERT_TRUE(publisher.start(path, error)) << error;
+
+    const int client = ::socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    ASSERT_GE(client, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    ASSERT_EQ(::connect(client, reinterpret_cast<const sockaddr*>(&address), sizeof(address)), 0);
+    for (int i = 0; i < 2000 && publisher.clients() == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(publisher.clients(), 1);
+
+    manager.start();
+    ASSERT_TRUE(manager.submit(OrderCommand::new_order(Order(1, btc, OrderType::LIMIT, OrderSide::BUY, 10000, 5))));
+    ASSERT_TRUE(manager.submit(OrderCommand::new_order(Order(2, btc, OrderType::LIMIT, OrderSide::SELL, 10100, 2))));
+    manager.stop();
+    publisher.stop();
+
+    std::vector<BookUpdate> received;
+    uint64_t expected_sequence = 1;
+    uint8_t buffer[md::kMaxPacketSize];
+    ssize_t size;
+    while ((size = ::recv(client, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) {
+        uint64_t first_sequence = 0;
+        const size_t before = received.size();
+        ASSERT_TRUE(md::decode_packet(buffer, static_cast<size_t>(size), first_sequence, received));
+        EXPECT_EQ(first_sequence, expected_sequence);
+        expected_sequence += received.size() - before;
+    }
+    ::close(client);
+
+    // The connection asked for the book's state: still empty when the shard started
+    ASSERT_EQ(received.size(), 3);
+    EXPECT_EQ(received[0].type, BookUpdateType::BOOK_RESET);
+    EXPECT_EQ(received[0].symbol_id, btc);
+    EXPECT_EQ(received[1].symbol_id, btc);
+    EXPECT_EQ(received[1].side, OrderSide::BUY);
+    EXPECT_EQ(received[1].price, 10000);
+    EXPECT_EQ(received[1].quantity, 5);
+    EXPECT_EQ(received[2].side, OrderSide::SELL);
+    EXPECT_EQ(received[2].price, 10100);
+    EXPECT_EQ(received[2].quantity, 2);
+    EXPECT_GT(publisher.packets_sent(), 0u);
+    EXPECT_EQ(publisher.clients_dropped(), 0u);
+    EXPECT_NE(::access(path.c_str(), F_OK), 0); // stop() removes the socket file
+}
+
+// A client connecting mid-stream gets each book's reset and state in sequence
+// with the live changes, and rebuilds the book from the reset onwards
+TEST(MarketDataFeedTest, LateJoinerRebuildsFromBookReset) {
+    BookManagerConfig config;
+    config.num_shards = 1;
+    config.queue_capacity = 64;
+    config.pin_threads = false;
+    config.book_feed = BookFeedDepth::ORDERS;
+    BookManager manager(config);
+    SymbolId btc = manager.add_symbol("MD-LATE-BTC");
+
+    manager.start();
+    ASSERT_TRUE(manager.submit(OrderCommand::new_order(Order(1, btc, OrderType::LIMIT, OrderSide::BUY, 10000, 5))));
+    ASSERT_TRUE(manager.submit(OrderCommand::new_order(Order(2, btc, OrderType::LIMIT, OrderSide::SELL, 10100, 2))));
+    ASSERT_TRUE(manager.submit(OrderCommand::new_order(Order(3, btc, OrderType::LIMIT, OrderSide::SELL, 10000, 1))));
+    while (manager.processed() < 3) {
+        std::this_thread::yield();
+    }
+
+    const std::string path = "/tmp/md_late_test_" + std::to_string(::getpid()) + ".sock";
+    MarketDataPublisher publisher(manager);
+    std::string error;
+    ASSERT_TRUE(publisher.start(path, error)) << error;
+    const int client = connect_client(path);
+    ASSERT_GE(client, 0);
+
+    std::vector<BookUpdate> received;
+    uint64_t expected_sequence = 0;
+    uint8_t buffer[md::kMaxPacketSize];
+    const auto receive = [&](int flags) {
+        const ssize_t size = ::recv(client, buffer, sizeof(buffer), flags);
+        if (size <= 0) {
+            return false;
+        }
+        uint64_t first_sequence = 0;
+        const size_t before = received.size();
+        EXPECT_TRUE(md::decode_packet(buffer, static_cast<size_t>(size), first_sequence, received));
+        if (expected_sequence != 0) {
+            EXPECT_EQ(first_sequence, expected_sequence);
+        }
+        expected_sequence = first_sequence + (received.size() - before);
+        return true;
+    };
+    // Nothing else is trading, so the reset is the first thing to arrive
+    timeval timeout{5, 0};
+    ::setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    ASSERT_TRUE(receive(0));
+    ASSERT_EQ(received[0].type, BookUpdateType::BOOK_RESET);
+    EXPECT_EQ(received[0].symbol_id, btc);
+
+    ASSERT_TRUE(manager.submit(OrderCommand::new_order(Order(4, btc, OrderType::LIMIT, OrderSide::BUY, 9900, 3))));
+    ASSERT_TRUE(manager.submit(OrderCommand::cancel(btc, 2)));
+    manager.stop();
+    publisher.stop();
+    while (receive(MSG_DONTWAIT)) {
+    }
+    ::close(client);
+
+    // Levels and orders as a client rebuilds them from the reset
+    std::map<std::pair<OrderSide, Price>, uint64_t> levels;
+    std::map<uint64_t, uint64_t> orders;
+    for (const BookUpdate& update : received) {
+        switch (update.type) {
+            case BookUpdateType::BOOK_RESET:
+                levels.clear();
+                orders.clear();
+                break;
+            case BookUpdateType::LEVEL:
+                if (update.quantity == 0) {
+                    levels.erase({update.side, update.price});
+                } else {
+                    levels[{update.side, update.price}] = update.quantity;
+                }
+                break;
+            case BookUpdateType::ORDER_ADD:
+            case BookUpdateType::ORDER_MODIFY:
+                orders[update.order_id] = update.quantity;
+                break;
+            case BookUpdateType::ORDER_DELETE:
+                orders.erase(update.order_id);
+                break;
+        }
+    }
+    const std::map<std::pair<OrderSide, Price>, uint64_t> expected_levels = {
+        {{OrderSide::BUY, 10000}, 4}, {{OrderSide::BUY, 9900}, 3}};
+    const std::map<uint64_t, uint64_t> expected_orders = {{1, 4}, {4, 3}};
+    EXPECT_EQ(levels, expected_levels);
+    EXPECT_EQ(orders, expected_orders);
+    EXPECT_EQ(publisher.updates_lost(), 0u);
+}
@@ -17,9 +17,13 @@ public:
 
 uint64_t OrderBookTest::order_id_counter = 1;
 
+// Matches the default OrderBookConfig tick size
+constexpr double kTickSize = 0.01;
+
 // Helper to create a new order with a unique ID
-std::shared_ptr<Order> create_order(OrderType type, OrderSide side, double price, uint64_t quantity) {
-    return std::make_shared<Order>(OrderBookTest::order_id_counter++, "TEST-SYMBOL", type, side, price, quantity);
+Order create_order(OrderType type, OrderSide side, double price, uint64_t quantity) {
+    static const SymbolId symbol_id = SymbolTable::instance().intern("TEST-SYMBOL");
+    return Order(OrderBookTest::order_id_counter++, symbol_id, type, side, to_ticks(price, kTickSize), quantity);
 }
 
 // Test 1: Add a single limit order and check the book depth
@@ -92,7 +96,7 @@ TEST_F(OrderBookTest, PriceTimePriority) {
     
     // It should match against the best bid (101.0) first
     ASSERT_EQ(trades.size(), 1);
-    EXPECT_EQ(trades[0].resting_order_id, buy2->id); // Matched against the 101.0 order
+    EXPECT_EQ(trades[0].resting_order_id, buy2.id); // Matched against the 101.0 order
     EXPECT_EQ(trades[0].quantity, 20);
 
     // The 101.0 order should be gone, 100.0 should remain
@@ -109,7 +113,7 @@ TEST_F(OrderBookTest, CancelOrder) {
     auto depth_before = book->get_depth(OrderSide::BUY);
     ASSERT_EQ(depth_before.size(), 1);
 
-    book->cancel_order(order_to_cancel->id);
+    book->cancel_order(order_to_cancel.id);
     
     // Create a matching order to force the book to purge the cancelled one
     auto trigger_match = create_order(OrderType::LIMIT, OrderSide::SELL, 100.0, 1);
@@ -118,3 +122,504 @@ TEST_F(OrderBookTest, CancelOrder) {
     auto depth_after = book->get_depth(OrderSide::BUY);
     EXPECT_TRUE(depth_after.empty());
 }
+
+// Test 6: Cancelling from the middle of a level unlinks it at once and keeps FIFO order
+TEST_F(OrderBookTest, CancelMiddleOfLevel) {
+    auto first = create_order(OrderType::LIMIT, OrderSide::BUY, 100.0, 10);
+    auto middle = create_order(OrderType::LIMIT, OrderSide::BUY, 100.0, 20);
+    auto last = create_order(OrderType::LIMIT, OrderSide::BUY, 100.0, 30);
+    book->add_order(first);
+    book->add_order(middle);
+    book->add_order(last);
+
+    EXPECT_TRUE(book->cancel_order(middle.id));
+    EXPECT_FALSE(book->cancel_order(middle.id));
+
+    auto depth = book->get_depth(OrderSide::BUY);
+    ASSERT_EQ(depth.size(), 1);
+    EXPECT_EQ(depth[0].second, 40);
+
+    std::vector<Trade> trades;
+    book->on_trade([&](const Trade& trade) {
+        trades.push_back(trade);
+    });
+    book->add_order(create_order(OrderType::LIMIT, OrderSide::SELL, 100.0, 35));
+
+    ASSERT_EQ(trades.size(), 2);
+    EXPECT_EQ(trades[0].resting_order_id, first.id);
+    EXPECT_EQ(trades[1].resting_order_id, last.id);
+    EXPECT_EQ(trades[1].quantity, 25);
+    EXPECT_EQ(book->get_depth(OrderSide::BUY)[0].second, 5);
+
+    // Cancelling the last order removes the level entirely
+    EXPECT_TRUE(book->cancel_order(last.id));
+    EXPECT_TRUE(book->get_depth(OrderSide::BUY).empty());
+}
+
+// Test 7: Levels far outside the initial band recentre/grow the ladder without losing order
+TEST_F(OrderBookTest, LadderRecentresOnDistantPrices) {
+    book->add_order(create_order(OrderType::LIMIT, OrderSide::BUY, 100.00, 10));
+    book->add_order(create_order(OrderType::LIMIT, OrderSide::BUY, 150.00, 20));
+    book->add_order(create_order(OrderType::LIMIT, OrderSide::BUY, 99.99, 30));
+
+    auto depth = book->get_depth(OrderSide::BUY);
+    ASSERT_EQ(depth.size(), 3);
+    EXPECT_EQ(depth[0].first, 150.00);
+    EXPECT_EQ(depth[1].first, 100.00);
+    EXPECT_DOUBLE_EQ(depth[2].first, 99.99);
+
+    // Best bid falls back to the next occupied level once 150.00 is taken out
+    book->add_order(create_order(OrderType::LIMIT, OrderSide::SELL, 150.00, 20));
+    depth = book->get_depth(OrderSide::BUY);
+    ASSERT_EQ(depth.size(), 2);
+    EXPECT_EQ(depth[0].first, 100.00);
+}
+
+// Test 8: Once warmed up, order entry, matching, modifies and cancels are served from the book's pools
+TEST_F(OrderBookTest, SteadyStateOrderEntryDoesNotAllocate) {
+    auto churn = [&]() {
+        std::vector<uint64_t> resting;
+        for (int i = 0; i < 2000; ++i) {
+            auto order = create_order(OrderType::LIMIT, OrderSide::BUY, 100.0 + (i % 50) * 0.01, 10);
+            book->add_order(order);
+            resting.push_back(order.id);
+        }
+        // Cross a few levels, move half of what is left, then cancel it all
+        book->add_order(create_order(OrderType::LIMIT, OrderSide::SELL, 100.40, 1000));
+        for (size_t i = 0; i < resting.size(); i += 2) {
+            book->modify_order(resting[i], to_ticks(99.00, kTickSize), 5);
+        }
+        for (uint64_t id : resting) {
+            book->cancel_order(id);
+        }
+    };
+
+    churn();
+    const uint64_t warm = book->heap_allocations();
+    EXPECT_GT(warm, 0);
+
+    churn();
+    churn();
+    EXPECT_EQ(book->heap_allocations(), warm);
+    EXPECT_EQ(book->live_orders(), 0);
+}
+
+// Test 9: Buffer depth returns the best N levels with aggregate quantity and order count
+TEST_F(OrderBookTest, DepthIntoBufferReportsAggregates) {
+    book->add_order(create_order(OrderType::LIMIT, OrderSide::SELL, 101.00, 5));
+    book->add_order(create_order(OrderType::LIMIT, OrderSide::SELL, 101.00, 7));
+    book->add_order(create_order(OrderType::LIMIT, OrderSide::SELL, 103.50, 1));
+    book->add_order(create_order(OrderType::LIMIT, OrderSide::SELL, 250.00, 9));
+
+    DepthLevel levels[2];
+    ASSERT_EQ(book->get_depth(OrderSide::SELL, levels, 2), 2);
+    EXPECT_EQ(levels[0].price, 101.00);
+    EXPECT_EQ(levels[0].quantity, 12);
+    EXPECT_EQ(levels[0].order_count, 2);
+    EXPECT_EQ(levels[1].price, 103.50);
+    EXPECT_EQ(levels[1].order_count, 1);
+
+    // A partial fill keeps the count and reduces the cached quantity
+    book->add_order(create_order(OrderType::LIMIT, OrderSide::BUY, 101.00, 6));
+    DepthLevel all[8];
+    ASSERT_EQ(book->get_depth(OrderSide::SELL, all, 8), 3);
+    EXPECT_EQ(all[0].quantity, 6);
+    EXPECT_EQ(all[0].order_count, 1);
+    EXPECT_EQ(all[2].price, 250.00);
+    EXPECT_EQ(book->get_depth(OrderSide::BUY, all, 8), 0);
+}
+
+// Test 10: Orders that would need a wider band than max_ladder_levels are rejected
+TEST(OrderBookLadderTest, RejectsPriceBeyondMaxBand) {
+    OrderBookConfig config;
+    config.ladder_levels = 16;
+    config.max_ladder_levels = 64;
+    OrderBook book(config);
+
+    EXPECT_TRUE(book.add_order(create_order(OrderType::LIMIT, OrderSide::BUY, 1.00, 10)));
+    EXPECT_TRUE(book.add_order(create_order(OrderType::LIMIT, OrderSide::BUY, 1.50, 10)));
+    EXPECT_FALSE(book.add_order(create_order(OrderType::LIMIT, OrderSide::BUY, 2.00, 10)));
+
+    auto depth = book.get_depth(OrderSide::BUY);
+    ASSERT_EQ(depth.size(), 2);
+    EXPECT_EQ(depth[0].first, 1.50);
+}
+
+// Test 11: A market order sweeps the opposite side and never rests
+TEST_F(OrderBookTest, MarketOrderSweepsAndDropsRemainder) {
+    book->add_order(create_order(OrderType::LIMIT, OrderSide::SELL, 100.00, 5));
+    book->add_order(create_order(OrderType::LIMIT, OrderSide::SELL, 100.50, 5));
+
+    std::vector<Trade> trades;
+    book->on_trade([&](const Trade& trade) { trades.push_back(trade); });
+
+    auto market_buy = create_order(OrderType::MARKET, OrderSide::BUY, 0.0, 12);
+    EXPECT_TRUE(book->add_order(market_buy));
+
+    ASSERT_EQ(trades.size(), 2);
+    EXPECT_EQ(trades[0].price, 100.00);
+    EXPECT_EQ(trades[1].price, 100.50);
+    EXPECT_EQ(trades[1].aggressive_order_id, market_buy.id);
+    EXPECT_TRUE(book->get_depth(OrderSide::SELL).empty());
+    // The unfilled 2 are cancelled rather than left on the bid side
+    EXPECT_TRUE(book->get_depth(OrderSide::BUY).empty());
+    EXPECT_EQ(book->live_orders(), 0);
+}
+
+// Test 12: IOC fills up to its limit price and cancels the rest; FOK is all or nothing
+TEST_F(OrderBookTest, ImmediateOrCancelAndFillOrKill) {
+    book->add_order(create_order(OrderType::LIMIT, OrderSide::BUY, 100.00, 4));
+    book->add_order(create_order(OrderType::LIMIT, OrderSide::BUY, 99.00, 4));
+
+    std::vector<Trade> trades;
+    book->on_trade([&](const Trade& trade) { trades.push_back(trade); });
+
+    auto ioc = create_order(OrderType::LIMIT, OrderSide::SELL, 99.50, 6);
+    ioc.time_in_force = TimeInForce::IOC;
+    EXPECT_TRUE(book->add_order(ioc));
+    ASSERT_EQ(trades.size(), 1);
+    EXPECT_EQ(trades[0].quantity, 4);
+    EXPECT_TRUE(book->get_depth(OrderSide::SELL).empty());
+
+    // Only 4 are available at 99.00 or better, so the order is killed and
+    // nothing trades
+    auto fok = create_order(OrderType::LIMIT, OrderSide::SELL, 99.00, 5);
+    fok.time_in_force = TimeInForce::FOK;
+    const uint64_t sequence = book->sequence();
+    EXPECT_FALSE(book->add_order(fok));
+    EXPECT_EQ(trades.size(), 1);
+    EXPECT_EQ(book->sequence(), sequence);
+    auto bids = book->get_depth(OrderSide::BUY);
+    ASSERT_EQ(bids.size(), 1);
+    EXPECT_EQ(bids[0].second, 4);
+
+    fok = create_order(OrderType::LIMIT, OrderSide::SELL, 99.00, 4);
+    fok.time_in_force = TimeInForce::FOK;
+    EXPECT_TRUE(book->add_order(fok));
+    EXPECT_EQ(trades.size(), 2);
+    EXPECT_TRUE(book->get_depth(OrderSide::BUY).empty());
+    EXPECT_TRUE(book->get_depth(OrderSide::SELL).empty());
+}
+
+// Test 13: The incoming order is the aggressor and trades at the resting price,
+// with only its remainder left on the book
+TEST_F(OrderBookTest, IncomingOrderTakesRestingPrice) {
+    auto resting_sell = create_order(OrderType::LIMIT, OrderSide::SELL, 100.00, 5);
+    book->add_order(resting_sell);
+
+    std::vector<Trade> trades;
+    book->on_trade([&](const Trade& trade) { trades.push_back(trade); });
+
+    auto buy = create_order(OrderType::LIMIT, OrderSide::BUY, 101.00, 8);
+    book->add_order(buy);
+
+    ASSERT_EQ(trades.size(), 1);
+    EXPECT_EQ(trades[0].resting_order_id, resting_sell.id);
+    EXPECT_EQ(trades[0].aggressive_order_id, buy.id);
+    EXPECT_EQ(trades[0].price, 100.00);
+    EXPECT_EQ(trades[0].quantity, 5);
+
+    auto bids = book->get_depth(OrderSide::BUY);
+    ASSERT_EQ(bids.size(), 1);
+    EXPECT_EQ(bids[0].first, 101.00);
+    EXPECT_EQ(bids[0].second, 3);
+    EXPECT_EQ(book->live_orders(), 1);
+}
+
+// Test 14: Each self-trade prevention mode of the incoming order, meeting its
+// own account's ask ahead of another account's ask at the same price
+TEST_F(OrderBookTest, SelfTradePreventionModes) {
+    struct Case {
+        SelfTradePrevention mode;
+        uint64_t traded;         // Filled against the other account
+        uint64_t asks_left;
+        uint64_t bid_left;       // Incoming remainder resting
+        uint64_t resting_cut;
+        uint64_t incoming_cut;
+        size_t live_orders;
+    };
+    const Case cases[] = {
+        {SelfTradePrevention::NONE, 3, 2, 0, 0, 0, 1},
+        {SelfTradePrevention::CANCEL_RESTING, 5, 0, 3, 5, 0, 1},
+        {SelfTradePrevention::CANCEL_AGGRESSOR, 0, 10, 0, 0, 8, 2},
+        {SelfTradePrevention::CANCEL_BOTH, 0, 5, 0, 5, 8, 1},
+        {SelfTradePrevention::DECREMENT, 3, 2, 0, 5, 5, 1},
+    };
+    for (const Case& c : cases) {
+        OrderBook stp_book;
+        auto own_ask = create_order(OrderType::LIMIT, OrderSide::SELL, 100.00, 5);
+        own_ask.account_id = 1;
+        auto other_ask = create_order(OrderType::LIMIT, OrderSide::SELL, 100.00, 5);
+        other_ask.account_id = 2;
+        stp_book.add_order(own_ask);
+        stp_book.add_order(other_ask);
+
+        uint64_t traded_with_other = 0;
+        stp_book.on_trade([&](const Trade& trade) {
+            if (trade.resting_order_id == other_ask.id) {
+                traded_with_other += trade.quantity;
+            }
+        });
+        uint64_t resting_cut = 0;
+        uint64_t incoming_cut = 0;
+        stp_book.on_self_trade_cancel([&](const SelfTradeCancel& cancel) {
+            EXPECT_EQ(cancel.account_id, 1);
+            (cancel.resting ? resting_cut : incoming_cut) += cancel.quantity;
+        });
+
+        auto buy = create_order(OrderType::LIMIT, OrderSide::BUY, 100.00, 8);
+        buy.account_id = 1;
+        buy.self_trade_prevention = c.mode;
+        EXPECT_TRUE(stp_book.add_order(buy));
+
+        SCOPED_TRACE(static_cast<int>(c.mode));
+        EXPECT_EQ(traded_with_other, c.traded);
+        EXPECT_EQ(resting_cut, c.resting_cut);
+        EXPECT_EQ(incoming_cut, c.incoming_cut);
+        auto asks = stp_book.get_depth(OrderSide::SELL);
+        EXPECT_EQ(asks.empty() ? 0 : asks[0].second, c.asks_left);
+        auto bids = stp_book.get_depth(OrderSide::BUY);
+        EXPECT_EQ(bids.empty() ? 0 : bids[0].second, c.bid_left);
+        EXPECT_EQ(stp_book.live_orders(), c.live_orders);
+    }
+}
+
+// Test 15: Shrinking an order at its price keeps its place; growing it or moving
+// its price sends it to the back of the queue
+TEST_F(OrderBookTest, ModifyKeepsPriorityOnlyForSamePriceDecrease) {
+    auto first = create_order(OrderType::LIMIT, OrderSide::BUY, 100.00, 10);
+    auto second = create_order(OrderType::LIMIT, OrderSide::BUY, 100.00, 10);
+    auto third = create_order(OrderType::LIMIT, OrderSide::BUY, 100.00, 10);
+    book->add_order(first);
+    book->add_order(second);
+    book->add_order(third);
+
+    EXPECT_TRUE(book->modify_order(first.id, first.price, 4));
+    EXPECT_TRUE(book->modify_order(second.id, second.price, 12));
+    EXPECT_TRUE(book->modify_order(third.id, to_ticks(100.01, kTickSize), 10));
+    EXPECT_TRUE(book->modify_order(third.id, to_ticks(100.00, kTickSize), 10));
+
+    DepthLevel level;
+    ASSERT_EQ(book->get_depth(OrderSide::BUY, &level, 1), 1);
+    EXPECT_EQ(level.quantity, 26);
+    EXPECT_EQ(level.order_count, 3);
+
+    std::vector<Trade> trades;
+    book->on_trade([&](const Trade& trade) { trades.push_back(trade); });
+    book->add_order(create_order(OrderType::LIMIT, OrderSide::SELL, 100.00, 26));
+
+    ASSERT_EQ(trades.size(), 3);
+    EXPECT_EQ(trades[0].resting_order_id, first.id);
+    EXPECT_EQ(trades[0].quantity, 4);
+    EXPECT_EQ(trades[1].resting_order_id, second.id);
+    EXPECT_EQ(trades[1].quantity, 12);
+    EXPECT_EQ(trades[2].resting_order_id, third.id);
+    EXPECT_EQ(book->live_orders(), 0);
+}
+
+// Test 16: A modify that crosses trades as the aggressor; bad requests change nothing
+TEST_F(OrderBookTest, ModifyCrossingPriceTradesAndRejectsBadRequests) {
+    auto ask = create_order(OrderType::LIMIT, OrderSide::SELL, 101.00, 5);
+    auto bid = create_order(OrderType::LIMIT, OrderSide::BUY, 99.00, 10);
+    book->add_order(ask);
+    book->add_order(bid);
+
+    EXPECT_FALSE(book->modify_order(bid.id, bid.price, 0));
+    EXPECT_FALSE(book->modify_order(999999, bid.price, 5));
+    EXPECT_FALSE(book->modify_order(bid.id, to_ticks(1000000.00, kTickSize), 5));
+    auto bids = book->get_depth(OrderSide::BUY);
+    ASSERT_EQ(bids.size(), 1);
+    EXPECT_EQ(bids[0].first, 99.00);
+    EXPECT_EQ(bids[0].second, 10);
+
+    std::vector<Trade> trades;
+    book->on_trade([&](const Trade& trade) { trades.push_back(trade); });
+    EXPECT_TRUE(book->modify_order(bid.id, to_ticks(101.00, kTickSize), 8));
+
+    ASSERT_EQ(trades.size(), 1);
+    EXPECT_EQ(trades[0].aggressive_order_id, bid.id);
+    EXPECT_EQ(trades[0].resting_order_id, ask.id);
+    EXPECT_EQ(trades[0].quantity, 5);
+    EXPECT_TRUE(book->get_depth(OrderSide::SELL).empty());
+    bids = book->get_depth(OrderSide::BUY);
+    ASSERT_EQ(bids.size(), 1);
+    EXPECT_EQ(bids[0].first, 101.00);
+    EXPECT_EQ(bids[0].second, 3);
+
+    // A fully filled modify leaves nothing behind
+    book->add_order(create_order(OrderType::LIMIT, OrderSide::SELL, 102.00, 3));
+    EXPECT_TRUE(book->modify_order(bid.id, to_ticks(102.00, kTickSize), 3));
+    EXPECT_EQ(book->live_orders(), 0);
+    EXPECT_FALSE(book->modify_order(bid.id, to_ticks(102.00, kTickSize), 1));
+}
+
+// Test 17: The depth snapshot changes only when published and carries the
+// best levels, the last trade and the book sequence
+TEST_F(OrderBookTest, PublishesDepthSnapshotOnRequest) {
+    EXPECT_EQ(book->depth_snapshot().sequence, 0);
+    for (int i = 0; i < 25; ++i) {
+        book->add_order(create_order(OrderType::LIMIT, OrderSide::BUY, 100.00 - i * 0.01, 10));
+    }
+    book->add_order(create_order(OrderType::LIMIT, OrderSide::SELL, 101.00, 7));
+    EXPECT_EQ(book->depth_snapshot().bid_count, 0);
+
+    book->publish_depth_snapshot();
+    DepthSnapshot snapshot = book->depth_snapshot();
+    EXPECT_EQ(snapshot.sequence, book->sequence());
+    ASSERT_EQ(snapshot.bid_count, DepthSnapshot::kLevels);
+    EXPECT_DOUBLE_EQ(snapshot.bids[0].price, 100.00);
+    EXPECT_DOUBLE_EQ(snapshot.bids[DepthSnapshot::kLevels - 1].price, 99.81);
+    ASSERT_EQ(snapshot.ask_count, 1);
+    EXPECT_EQ(snapshot.asks[0].quantity, 7);
+    EXPECT_EQ(snapshot.last_trade_quantity, 0);
+
+    book->add_order(create_order(OrderType::LIMIT, OrderSide::BUY, 101.00, 3));
+    EXPECT_EQ(book->depth_snapshot().sequence, snapshot.sequence);
+    book->publish_depth_snapshot();
+    snapshot = book->depth_snapshot();
+    EXPECT_EQ(snapshot.sequence, book->sequence());
+    EXPECT_EQ(snapshot.asks[0].quantity, 4);
+    EXPECT_DOUBLE_EQ(snapshot.last_trade_price, 101.00);
+    EXPECT_EQ(snapshot.last_trade_quantity, 3);
+
+    // A refused cancel changes nothing, so the sequence holds
+    EXPECT_FALSE(book->cancel_order(999999));
+    EXPECT_EQ(book->sequence(), snapshot.sequence);
+}
+
+// Test 18: Book updates carry each level's new aggregate and, per order, adds,
+// partial fills and removals; a sweep reports a level once
+TEST_F(OrderBookTest, ReportsLevelAndOrderUpdates) {
+    std::vector<BookUpdate> updates;
+    book->on_book_update([&](const BookUpdate& update) { updates.push_back(update); }, true);
+
+    auto first = create_order(OrderType::LIMIT, OrderSide::BUY, 100.00, 10);
+    auto second = create_order(OrderType::LIMIT, OrderSide::BUY, 100.00, 5);
+    book->add_order(first);
+    book->add_order(second);
+    book->add_order(create_order(OrderType::LIMIT, OrderSide::SELL, 100.00, 12));
+    book->cancel_order(second.id);
+
+    const Price price = to_ticks(100.00, kTickSize);
+    ASSERT_EQ(updates.size(), 9);
+    auto expect_level = [&](size_t i, uint64_t quantity, uint32_t order_count) {
+        EXPECT_EQ(updates[i].type, BookUpdateType::LEVEL);
+        EXPECT_EQ(updates[i].side, OrderSide::BUY);
+        EXPECT_EQ(updates[i].price, price);
+        EXPECT_EQ(updates[i].quantity, quantity);
+        EXPECT_EQ(updates[i].order_count, order_count);
+    };
+    auto expect_order = [&](size_t i, BookUpdateType type, uint64_t order_id, uint64_t quantity) {
+        EXPECT_EQ(updates[i].type, type);
+        EXPECT_EQ(updates[i].order_id, order_id);
+        EXPECT_EQ(updates[i].price, price);
+        EXPECT_EQ(updates[i].quantity, quantity);
+    };
+    expect_level(0, 10, 1);
+    expect_order(1, BookUpdateType::ORDER_ADD, first.id, 10);
+    expect_level(2, 15, 2);
+    expect_order(3, BookUpdateType::ORDER_ADD, second.id, 5);
+    expect_order(4, BookUpdateType::ORDER_DELETE, first.id, 0);
+    expect_order(5, BookUpdateType::ORDER_MODIFY, second.id, 3);
+    expect_level(6, 3, 1);
+    expect_level(7, 0, 0);
+    expect_order(8, BookUpdateType::ORDER_DELETE, second.id, 3);
+
+    // A late subscriber rebuilds the book from its reported state
+    auto ask = create_order(OrderType::LIMIT, OrderSide::SELL, 101.00, 7);
+    book->add_order(ask);
+    updates.clear();
+    book->report_book_state();
+    ASSERT_EQ(updates.size(), 2);
+    EXPECT_EQ(updates[0].type, BookUpdateType::LEVEL);
+    EXPECT_EQ(updates[0].side, OrderSide::SELL);
+    EXPECT_EQ(updates[0].quantity, 7);
+    EXPECT_EQ(updates[1].type, BookUpdateType::ORDER_ADD);
+    EXPECT_EQ(updates[1].order_id, ask.id);
+    EXPECT_EQ(updates[1].quantity, 7);
+}
+
+// Test 19: Trade ids advance whether or not a trade callback is registered, so
+// a silent replay ends at the same next trade id as the live book
+TEST_F(OrderBookTest, NumbersTradesWithoutCallback) {
+    OrderBook silent;
+    std::vector<Trade> trades;
+    book->on_trade([&](const Trade& trade) { trades.push_back(trade); });
+
+    const std::vector<Order> orders = {
+        create_order(OrderType::LIMIT, OrderSide::SELL, 100.00, 5),
+        create_order(OrderType::LIMIT, OrderSide::SELL, 100.01, 5),
+        create_order(OrderType::LIMIT, OrderSide::BUY, 100.01, 8),
+        create_order(OrderType::MARKET, OrderSide::BUY, 0.0, 1),
+    };
+    for (const Order& order : orders) {
+        book->add_order(order);
+        silent.add_order(order);
+    }
+
+    ASSERT_EQ(trades.size(), 3);
+    EXPECT_EQ(trades.back().trade_id, 3);
+    EXPECT_EQ(silent.snapshot().next_trade_id, 4);
+    EXPECT_EQ(book->snapshot().next_trade_id, silent.snapshot().next_trade_id);
+}
+
+// Test 20: A modify to a price outside the band is refused before the order
+// leaves its level or trades through the opposite side
+TEST(OrderBookLadderTest, RejectsModifyBeyondMaxBand) {
+    OrderBookConfig config;
+    config.ladder_levels = 16;
+    config.max_ladder_levels = 64;
+    OrderBook book(config);
+    std::vector<Trade> trades;
+    book.on_trade([&](const Trade& trade) { trades.push_back(trade); });
+
+    auto low = create_order(OrderType::LIMIT, OrderSide::BUY, 1.00, 10);
+    auto high = create_order(OrderType::LIMIT, OrderSide::BUY, 1.50, 10);
+    auto ask = create_order(OrderType::LIMIT, OrderSide::SELL, 1.60, 4);
+    ASSERT_TRUE(book.add_order(low));
+    ASSERT_TRUE(book.add_order(high));
+    ASSERT_TRUE(book.add_order(ask));
+
+    // 1.70 would cross the ask, but the bids could not span 1.00 to 1.70
+    EXPECT_FALSE(book.modify_order(high.id, to_ticks(1.70, kTickSize), 6));
+    EXPECT_TRUE(trades.empty());
+    EXPECT_EQ(book.live_orders(), 3);
+    EXPECT_EQ(book.remaining_quantity(high.id), 10);
+    auto bids = book.get_depth(OrderSide::BUY);
+    ASSERT_EQ(bids.size(), 2);
+    EXPECT_EQ(bids[0].first, 1.50);
+    EXPECT_EQ(bids[0].second, 10);
+    EXPECT_EQ(book.get_depth(OrderSide::SELL).size(), 1);
+
+    // Within the band the same modify trades and rests the remainder
+    EXPECT_TRUE(book.modify_order(high.id, to_ticks(1.60, kTickSize), 6));
+    ASSERT_EQ(trades.size(), 1);
+    EXPECT_EQ(trades[0].quantity, 4);
+    EXPECT_EQ(book.remaining_quantity(high.id), 2);
+}
+
+// Test 21: A crossing modify whose self-trade prevention cancels the order is
+// still applied: the call succeeds, the cut is reported and nothing rests
+TEST_F(OrderBookTest, ModifyCancelledBySelfTradePreventionIsApplied) {
+    auto ask = create_order(OrderType::LIMIT, OrderSide::SELL, 101.00, 5);
+    ask.account_id = 9;
+    auto bid = create_order(OrderType::LIMIT, OrderSide::BUY, 99.00, 4);
+    bid.account_id = 9;
+    bid.self_trade_prevention = SelfTradePrevention::CANCEL_BOTH;
+    ASSERT_TRUE(book->add_order(ask));
+    ASSERT_TRUE(book->add_order(bid));
+
+    std::vector<Trade> trades;
+    std::vector<SelfTradeCancel> cancels;
+    book->on_trade([&](const Trade& trade) { trades.push_back(trade); });
+    book->on_self_trade_cancel([&](const SelfTradeCancel& cancel) { cancels.push_back(cancel); });
+    EXPECT_TRUE(book->modify_order(bid.id, to_ticks(101.00, kTickSize), 4));
+
+    EXPECT_TRUE(trades.empty());
+    ASSERT_EQ(cancels.size(), 2);
+    EXPECT_EQ(book->remaining_quantity(bid.id), 0);
+    EXPECT_EQ(book->remaining_quantity(ask.id), 0);
+    EXPECT_EQ(book->live_orders(), 0);
+    // Gone, so a further modify is refused
+    EXPECT_FALSE(book->modify_order(bid.id, to_ticks(99.00, kTickSize), 4));
+}
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include "order_book/OrderIndex.h"
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+OrderHandle handle_for(uint64_t order_id) {
+    return OrderHandle{static_cast<uint32_t>(order_id * 7), static_cast<uint32_t>(order_id)};
+}
+
+} // namespace
+
+// Ids can be added once, found until erased, and erased once
+TEST(OrderIndexTest, InsertFindErase) {
+    OrderIndex index(4, std::pmr::new_delete_resource());
+    EXPECT_TRUE(index.empty());
+    EXPECT_FALSE(index.find(1).valid());
+
+    EXPECT_TRUE(index.insert(1, handle_for(1)));
+    EXPECT_TRUE(index.insert(2, handle_for(2)));
+    EXPECT_FALSE(index.insert(1, handle_for(3)));
+    EXPECT_EQ(index.size(), 2);
+    EXPECT_EQ(index.find(1).index, handle_for(1).index);
+    EXPECT_TRUE(index.contains(2));
+
+    EXPECT_EQ(index.erase(1).generation, handle_for(1).generation);
+    EXPECT_FALSE(index.erase(1).valid());
+    EXPECT_FALSE(index.contains(1));
+    EXPECT_TRUE(index.contains(2));
+    EXPECT_EQ(index.size(), 1);
+}
+
+// Grows past its initial size and stays consistent with a reference map under
+// the sliding window of ids a busy book sees, with random cancels in between
+TEST(OrderIndexTest, MatchesReferenceUnderChurn) {
+    OrderIndex index(16, std::pmr::new_delete_resource());
+    std::unordered_map<uint64_t, OrderHandle> reference;
+    std::vector<uint64_t> live;
+    std::mt19937_64 rng(3);
+    uint64_t next_id = 1;
+
+    for (int step = 0; step < 200000; ++step) {
+        if (live.size() < 5000 && (live.empty() || rng() % 3 != 0)) {
+            const uint64_t id = next_id;
+            next_id += 1 + rng() % 3;
+            ASSERT_TRUE(index.insert(id, handle_for(id)));
+            reference.emplace(id, handle_for(id));
+            live.push_back(id);
+        } else {
+            const size_t victim = rng() % live.size();
+            ASSERT_EQ(index.erase(live[victim]).index, reference[live[victim]].index);
+            reference.erase(live[victim]);
+            live[victim] = live.back();
+            live.pop_back();
+        }
+    }
+
+    ASSERT_EQ(index.size(), reference.size());
+    EXPECT_LE(2 * index.size(), index.capacity());
+    for (const auto& [id, handle] : reference) {
+        ASSERT_EQ(index.find(id).index, handle.index) << id;
+    }
+    for (uint64_t id = 1; id < next_id; ++id) {
+        ASSERT_EQ(index.contains(id), reference.count(id) == 1) << id;
+    }
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include "market_data/OrderMessageParser.h"
+#include <string>
+#include <vector>
+
+namespace {
+
+SymbolId intern_test_symbol() {
+    return SymbolTable::instance().intern("PARSER-TEST");
+}
+
+} // namespace
+
+// Direct limit messages decode in any key order and ignore unknown scalar keys
+TEST(OrderMessageParserTest, ParsesDirectLimitOrder) {
+    const SymbolId id = intern_test_symbol();
+    ParsedOrder order{};
+    ASSERT_TRUE(OrderMessageParser::parse(
+        R"({"quantity": 25, "side": "sell", "venue": "sim", "price": 101.25, "symbol": "PARSER-TEST", "type": "limit"})",
+        order));
+    EXPECT_EQ(order.symbol_id, id);
+    EXPECT_EQ(order.type, OrderType::LIMIT);
+    EXPECT_EQ(order.side, OrderSide::SELL);
+    EXPECT_DOUBLE_EQ(order.price, 101.25);
+    EXPECT_EQ(order.quantity, 25);
+    EXPECT_EQ(order.account_id, 0);
+    EXPECT_EQ(order.self_trade_prevention, SelfTradePrevention::NONE);
+}
+
+// The subscribe echo carries the order as an escaped JSON string
+TEST(OrderMessageParserTest, ParsesSubscribeEcho) {
+    const SymbolId id = intern_test_symbol();
+    ParsedOrder order{};
+    ASSERT_TRUE(OrderMessageParser::parse(
+        R"({"type":"subscribe","symbol":"{\"type\":\"limit\",\"symbol\":\"PARSER-TEST\",\"side\":\"buy\",\"price\":99.5,\"quantity\":3,\"account\":2,\"stp\":\"cancel_both\"}"})",
+        order));
+    EXPECT_EQ(order.symbol_id, id);
+    EXPECT_EQ(order.side, OrderSide::BUY);
+    EXPECT_DOUBLE_EQ(order.price, 99.5);
+    EXPECT_EQ(order.quantity, 3);
+    EXPECT_EQ(order.account_id, 2);
+    EXPECT_EQ(order.self_trade_prevention, SelfTradePrevention::CANCEL_BOTH);
+}
+
+// Anything outside the schema is left to the general JSON parser
+TEST(OrderMessageParserTest, RejectsMessagesOutsideSchema) {
+    intern_test_symbol();
+    ParsedOrder order{};
+    // Unknown symbol
+    EXPECT_FALSE(OrderMessageParser::parse(
+        R"({"type":"limit","symbol":"NOT-LISTED","side":"buy","price":1,"quantity":1})", order));
+    // Not a limit order
+    EXPECT_FALSE(OrderMessageParser::parse(
+        R"({"type":"heartbeat","symbol":"PARSER-TEST"})", order));
+    // Quoted numbers, nested values, missing fields and truncated input
+    EXPECT_FALSE(OrderMessageParser::parse(
+        R"({"type":"limit","symbol":"PARSER-TEST","side":"buy","price":"1.5","quantity":1})", order));
+    EXPECT_FALSE(OrderMessageParser::parse(
+        R"({"type":"limit","symbol":"PARSER-TEST","side":"buy","price":1.5,"quantity":1,"meta":{}})", order));
+    EXPECT_FALSE(OrderMessageParser::parse(
+        R"({"type":"limit","symbol":"PARSER-TEST","side":"buy","price":1.5})", order));
+    EXPECT_FALSE(OrderMessageParser::parse(
+        R"({"type":"limit","symbol":"PARSER-TEST","side":"buy","price":1.5,"quantity":1)", order));
+    EXPECT_FALSE(OrderMessageParser::parse(
+        R"({"type":"limit","symbol":"PARSER-TEST","side":"buy","price":1.5,"quantity":-1})", order));
+    // Optional fields that are present but malformed
+    EXPECT_FALSE(OrderMessageParser::parse(
+        R"({"type":"limit","symbol":"PARSER-TEST","side":"buy","price":1.5,"quantity":1,"account":-1})", order));
+    EXPECT_FALSE(OrderMessageParser::parse(
+        R"({"type":"limit","symbol":"PARSER-TEST","side":"buy","price":1.5,"quantity":1,"stp":"sometimes"})", order));
+    // A plain subscribe echo carries no order
+    EXPECT_FALSE(OrderMessageParser::parse(R"({"type":"subscribe","symbol":"BTC-USD"})", order));
+}
+
+// Cached symbol lookups stay correct with more symbols than cache slots, and a
+// symbol interned after a failed lookup is found on the next frame
+TEST(OrderMessageParserTest, ResolvesSymbolsThroughCache) {
+    std::vector<SymbolId> ids;
+    for (int i = 0; i < 40; ++i) {
+        ids.push_back(SymbolTable::instance().intern("CACHE-" + std::to_string(i)));
+    }
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 40; ++i) {
+            const std::string payload = R"({"type":"limit","symbol":"CACHE-)" + std::to_string(i) +
+                                        R"(","side":"buy","price":1,"quantity":1})";
+            ParsedOrder order{};
+            ASSERT_TRUE(OrderMessageParser::parse(payload, order));
+            EXPECT_EQ(order.symbol_id, ids[i]);
+        }
+    }
+
+    const std::string late = R"({"type":"limit","symbol":"CACHE-LATE","side":"sell","price":1,"quantity":1})";
+    ParsedOrder order{};
+    EXPECT_FALSE(OrderMessageParser::parse(late, order));
+    const SymbolId late_id = SymbolTable::instance().intern("CACHE-LATE");
+    ASSERT_TRUE(OrderMessageParser::parse(late, order));
+    EXPECT_EQ(order.symbol_id, late_id);
+}
@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+#include "order_book/BookManager.h"
+#include "risk/OrderReservations.h"
+#include <vector>
+
+namespace {
+
+BookManagerConfig status_config() {
+    BookManagerConfig config;
+    config.queue_capacity = 1024;
+    config.pin_threads = false;
+    config.report_order_status = true;
+    return config;
+}
+
+Order order_for(SymbolId symbol_id, uint64_t id, AccountId account_id, OrderSide side, Price price, uint64_t quantity,
+                TimeInForce tif = TimeInForce::GTC) {
+    Order order(id, symbol_id, OrderType::LIMIT, side, price, quantity);
+    order.account_id = account_id;
+    order.time_in_force = tif;
+    return order;
+}
+
+// The order handler's path: risk check, then route; a dropped order gives back its reservation
+void route(BookManager& books, RiskEngine& risk, const Order& order) {
+    ASSERT_EQ(risk.check_pre_trade_risk(order), RejectReason::NONE);
+    ASSERT_TRUE(books.submit(OrderCommand::new_order(order)));
+}
+
+// A replace is checked as a fresh GTC order for the new size, then sent as a modify
+void replace(BookManager& books, RiskEngine& risk, const Order& order) {
+    ASSERT_EQ(risk.check_pre_trade_risk(order), RejectReason::NONE);
+    OrderCommand modify = OrderCommand::modify(order.symbol_id, order.id, order.price, order.quantity);
+    modify.account_id = order.account_id;
+    modify.side = order.side;
+    ASSERT_TRUE(books.submit(modify));
+}
+
+void drain(ExecutionSubscription& feed, OrderReservations& reservations) {
+    std::vector<ExecutionReport> reports(256);
+    size_t count;
+    while ((count = feed.poll(reports.data(), reports.size())) > 0) {
+        for (size_t i = 0; i < count; ++i) {
+            reservations.on_execution(reports[i]);
+        }
+    }
+}
+
+} // namespace
+
+// Cancels, replaces and book refusals all hand back exactly what they reserved
+TEST(OrderReservationsTest, CancelAndReplaceReturnExposureToZero) {
+    BookManager books(status_config());
+    const SymbolId symbol = books.add_symbol("RESERVE-CANCEL");
+    RiskEngine risk(1000.0);
+    OrderReservations reservations(risk);
+    ExecutionSubscription feed = books.subscribe_executions();
+
+    books.start();
+    route(books, risk, order_for(symbol, 1, 1, OrderSide::BUY, 10000, 10));
+    replace(books, risk, order_for(symbol, 1, 1, OrderSide::BUY, 10000, 4));  // In-place size cut
+    replace(books, risk, order_for(symbol, 1, 1, OrderSide::BUY, 10100, 6));  // Reprice, re-queued
+    route(books, risk, order_for(symbol, 2, 1, OrderSide::SELL, 10500, 5));
+    route(books, risk, order_for(symbol, 2, 1, OrderSide::SELL, 10600, 7));   // Duplicate id, refused
+    route(books, risk, order_for(symbol, 3, 1, OrderSide::SELL, 1 << 30, 2)); // Off the ladder, refused
+    books.stop();
+    drain(feed, reservations);
+
+    EXPECT_EQ(risk.open_quantity(1, symbol, OrderSide::BUY), 6);
+    EXPECT_EQ(risk.open_quantity(1, symbol, OrderSide::SELL), 5);
+    EXPECT_EQ(reservations.reserved(symbol, 1), 6);
+    EXPECT_EQ(reservations.reserved(symbol, 2), 5);
+    EXPECT_EQ(reservations.size(), 2);
+}
+
+// Cancelling after a replace leaves nothing reserved
+TEST(OrderReservationsTest, CancelAfterReplaceReleasesEverything) {
+    BookManager books(status_config());
+    const SymbolId symbol = books.add_symbol("RESERVE-REPLACE");
+    RiskEngine risk(1000.0);
+    OrderReservations reservations(risk);
+    ExecutionSubscription feed = books.subscribe_executions();
+
+    books.start();
+    route(books, risk, order_for(symbol, 1, 1, OrderSide::BUY, 10000, 10));
+    replace(books, risk, order_for(symbol, 1, 1, OrderSide::BUY, 10000, 3));
+    replace(books, risk, order_for(symbol, 1, 1, OrderSide::BUY, 9900, 12));
+    ASSERT_TRUE(books.submit(OrderCommand::cancel(symbol, 1)));
+    // A modify of an order that is gone gives back what its check reserved
+    replace(books, risk, order_for(symbol, 1, 1, OrderSide::BUY, 9900, 8));
+    books.stop();
+    drain(feed, reservations);
+
+    EXPECT_EQ(risk.open_quantity(1, symbol, OrderSide::BUY), 0);
+    EXPECT_EQ(reservations.size(), 0);
+}
+
+// Fills release the resting order's reservation; an IOC aggressor never
+// reserved anything, so it cannot eat into its account's other orders
+TEST(OrderReservationsTest, FillsReleaseOnlyWhatTheOrderReserved) {
+    BookManager books(status_config());
+    const SymbolId symbol = books.add_symbol("RESERVE-FILLS");
+    RiskEngine risk(1000.0);
+    OrderReservations reservations(risk);
+    ExecutionSubscription feed = books.subscribe_executions();
+
+    books.start();
+    route(books, risk, order_for(symbol, 1, 1, OrderSide::BUY, 9000, 5));
+    route(books, risk, order_for(symbol, 2, 2, OrderSide::SELL, 10000, 8));
+    route(books, risk, order_for(symbol, 3, 1, OrderSide::BUY, 10000, 3, TimeInForce::IOC));
+    // GTC aggressor: 5 fills, the other 4 rests
+    route(books, risk, order_for(symbol, 4, 1, OrderSide::BUY, 10000, 9));
+    books.stop();
+    drain(feed, reservations);
+
+    EXPECT_EQ(risk.open_quantity(2, symbol, OrderSide::SELL), 0);
+    EXPECT_EQ(risk.open_quantity(1, symbol, OrderSide::BUY), 5 + 4);
+    EXPECT_EQ(reservations.reserved(symbol, 1), 5);
+    EXPECT_EQ(reservations.reserved(symbol, 4), 4);
+}
+
+// Orders already resting, e.g. after recovery, are reserved once
+TEST(OrderReservationsTest, ReservesRestingOrders) {
+    const SymbolId symbol = SymbolTable::instance().intern("RESERVE-RECOVERED");
+    OrderBook book;
+    ASSERT_TRUE(book.add_order(order_for(symbol, 1, 1, OrderSide::BUY, 10000, 10)));
+    ASSERT_TRUE(book.add_order(order_for(symbol, 2, 1, OrderSide::SELL, 10200, 4)));
+    ASSERT_TRUE(book.add_order(order_for(symbol, 3, 2, OrderSide::SELL, 10000, 6)));
+
+    RiskEngine risk(1000.0);
+    OrderReservations reservations(risk);
+    reservations.reserve_resting(book);
+    reservations.reserve_resting(book);
+    EXPECT_EQ(risk.open_quantity(1, symbol, OrderSide::BUY), 4);
+    EXPECT_EQ(risk.open_quantity(1, symbol, OrderSide::SELL), 4);
+    EXPECT_EQ(risk.open_quantity(2, symbol, OrderSide::SELL), 0);
+
+    ExecutionReport fill;
+    fill.trade = Trade(1, 1, 99, 100.0, 4);
+    fill.trade.symbol_id = symbol;
+    reservations.on_execution(fill);
+    EXPECT_EQ(risk.open_quantity(1, symbol, OrderSide::BUY), 0);
+    EXPECT_EQ(reservations.size(), 1);
+}
+
+// The same ids in two books are separate reservations, and fills that empty
+// them in any order leave every other one findable as the table grows
+TEST(OrderReservationsTest, TracksManyOrdersAcrossBooks) {
+    const SymbolId first = SymbolTable::instance().intern("RESERVE-MANY-A");
+    const SymbolId second = SymbolTable::instance().intern("RESERVE-MANY-B");
+    constexpr uint64_t kOrders = 500;
+    OrderBook first_book;
+    OrderBook second_book;
+    for (uint64_t id = 1; id <= kOrders; ++id) {
+        const Price offset = static_cast<Price>(id);
+        ASSERT_TRUE(first_book.add_order(order_for(first, id, 1, OrderSide::BUY, 10000 - offset, 2)));
+        ASSERT_TRUE(second_book.add_order(order_for(second, id, 1, OrderSide::SELL, 10000 + offset, 3)));
+    }
+
+    RiskEngine risk(1e9);
+    OrderReservations reservations(risk);
+    reservations.reserve_resting(first_book);
+    reservations.reserve_resting(second_book);
+    ASSERT_EQ(reservations.size(), 2 * kOrders);
+
+    // Fill every odd order of the first book
+    for (uint64_t id = 1; id <= kOrders; id += 2) {
+        ExecutionReport fill;
+        fill.trade = Trade(id, id, 10000 + id, 100.0, 2);
+        fill.trade.symbol_id = first;
+        reservations.on_execution(fill);
+    }
+    EXPECT_EQ(reservations.size(), 2 * kOrders - kOrders / 2);
+    for (uint64_t id = 1; id <= kOrders; ++id) {
+        EXPECT_EQ(reservations.reserved(first, id), id % 2 == 0 ? 2 : 0);
+        EXPECT_EQ(reservations.reserved(second, id), 3);
+    }
+    EXPECT_EQ(risk.open_quantity(1, first, OrderSide::BUY), kOrders);
+    EXPECT_EQ(risk.open_quantity(1, second, OrderSide::SELL), 3 * kOrders);
+}
@@ -0,0 +1,209 @@
+#include <gtest/gtest.h>
+#include "risk/RiskEngine.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+
+Order order_for(SymbolId symbol_id, OrderSide side, uint64_t quantity) {
+    return Order(1, symbol_id, OrderType::LIMIT, side, 10000, quantity);
+}
+
+// A fill where `buyer` aggressed against a resting sell of `seller`
+Trade fill(uint64_t id, SymbolId symbol_id, AccountId buyer, AccountId seller, double price, uint64_t quantity) {
+    Trade trade(id, id * 2, id * 2 + 1, price, quantity);
+    trade.symbol_id = symbol_id;
+    trade.aggressor_side = OrderSide::BUY;
+    trade.aggressive_account = buyer;
+    trade.resting_account = seller;
+    return trade;
+}
+
+} // namespace
+
+// Positions are tracked per account and symbol, and the limit applies to each alone
+TEST(RiskEngineTest, TracksPositionsPerSymbol) {
+    RiskEngine risk(50.0);
+    const SymbolId first = SymbolTable::instance().intern("RISK-TEST-A");
+    const SymbolId second = SymbolTable::instance().intern("RISK-TEST-B");
+
+    EXPECT_EQ(risk.check_pre_trade_risk(order_for(first, OrderSide::BUY, 30)), RejectReason::NONE);
+    risk.update_on_trade(fill(1, first, 0, 1, 100.0, 30));
+    risk.release_open_quantity(0, first, OrderSide::BUY, 30);
+    risk.update_on_trade(fill(2, first, 1, 0, 110.0, 10));
+
+    // The second order stays working, so it counts against the third
+    EXPECT_EQ(risk.check_pre_trade_risk(order_for(first, OrderSide::BUY, 30)), RejectReason::NONE);
+    EXPECT_EQ(risk.check_pre_trade_risk(order_for(first, OrderSide::BUY, 1)), RejectReason::POSITION_LIMIT);
+    EXPECT_EQ(risk.open_quantity(0, first, OrderSide::BUY), 30);
+    EXPECT_EQ(risk.check_pre_trade_risk(order_for(second, OrderSide::BUY, 50)), RejectReason::NONE);
+
+    auto position = risk.get_position(0, first);
+    ASSERT_TRUE(position);
+    EXPECT_EQ(position->account_id, 0);
+    EXPECT_EQ(position->symbol, "RISK-TEST-A");
+    EXPECT_EQ(position->net_position, 20);
+    EXPECT_DOUBLE_EQ(position->avg_entry_price, 100.0);
+    EXPECT_DOUBLE_EQ(position->realized_pnl, 100.0);
+    EXPECT_FALSE(risk.get_position(0, second));
+    EXPECT_EQ(risk.get_position(0, "RISK-TEST-A")->net_position, 20);
+
+    // Symbols past the dense array are refused rather than tracked
+    RiskEngine small(50.0, 1);
+    EXPECT_EQ(small.check_pre_trade_risk(order_for(second, OrderSide::BUY, 1)), RejectReason::UNKNOWN_SYMBOL);
+
+    risk.restore_positions({Position{2, "RISK-TEST-B", -5, 90.0, 1.5}});
+    EXPECT_FALSE(risk.get_position(0, first));
+    EXPECT_FALSE(risk.get_position(0, second));
+    EXPECT_EQ(risk.get_position(2, second)->net_position, -5);
+    ASSERT_EQ(risk.positions().size(), 1);
+}
+
+// One trade moves both counterparties, whichever side aggressed
+TEST(RiskEngineTest, UpdatesBothCounterparties) {
+    RiskEngine risk(1000.0);
+    const SymbolId symbol = SymbolTable::instance().intern("RISK-TEST-COUNTERPARTY");
+
+    risk.update_on_trade(fill(1, symbol, 0, 1, 100.0, 10));
+    Trade sell = fill(2, symbol, 0, 1, 104.0, 4);
+    sell.aggressor_side = OrderSide::SELL; // Account 0 sells into account 1's bid
+    EXPECT_EQ(sell.seller(), 0);
+    EXPECT_EQ(sell.buyer(), 1);
+    risk.update_on_trade(sell);
+
+    const auto first = risk.get_position(0, symbol);
+    const auto second = risk.get_position(1, symbol);
+    ASSERT_TRUE(first && second);
+    EXPECT_EQ(first->net_position, 6);
+    EXPECT_DOUBLE_EQ(first->realized_pnl, 16.0);
+    EXPECT_EQ(second->net_position, -6);
+    EXPECT_DOUBLE_EQ(second->realized_pnl, -16.0);
+    EXPECT_EQ(risk.positions().size(), 2);
+
+    // Trading with itself leaves an account flat
+    risk.update_on_trade(fill(3, symbol, 2, 2, 100.0, 5));
+    EXPECT_EQ(risk.get_position(2, symbol)->net_position, 0);
+
+    // A counterparty past the account table drops the whole trade
+    risk.update_on_trade(fill(4, symbol, 0, RiskEngine::kDefaultMaxAccounts, 100.0, 5));
+    EXPECT_EQ(risk.get_position(0, symbol)->net_position, 6);
+}
+
+// Each limit reports its own reason, and symbol and account limits both apply
+TEST(RiskEngineTest, RejectsWithReasonCodes) {
+    RiskEngine risk(1000.0, RiskEngine::kDefaultMaxSymbols, 4);
+    const SymbolId symbol = SymbolTable::instance().intern("RISK-TEST-LIMITS");
+    SymbolLimits limits;
+    limits.max_order_quantity = 100;
+    limits.max_order_notional = 5000.0; // 50 at a price of 100.00
+    limits.max_position = 120;
+    limits.price_collar_bps = 100;
+    limits.max_orders_per_second = 3;
+    ASSERT_TRUE(risk.set_symbol_limits(symbol, limits));
+    AccountLimits account;
+    account.max_order_quantity = 40;
+    ASSERT_TRUE(risk.set_account_limits(1, account));
+    EXPECT_FALSE(risk.set_account_limits(4, account));
+
+    // Pinned to one second so the rate window is deterministic
+    const auto second = std::chrono::system_clock::time_point(std::chrono::seconds(1700000000));
+    auto order = [&](AccountId account_id, Price price, uint64_t quantity, TimeInForce tif = TimeInForce::GTC) {
+        Order o(1, symbol, OrderType::LIMIT, OrderSide::BUY, price, quantity);
+        o.account_id = account_id;
+        o.time_in_force = tif;
+        o.timestamp = second;
+        return o;
+    };
+    EXPECT_EQ(risk.check_pre_trade_risk(order(0, 10000, 101)), RejectReason::ORDER_QUANTITY);
+    EXPECT_EQ(risk.check_pre_trade_risk(order(1, 10000, 41)), RejectReason::ORDER_QUANTITY);
+    EXPECT_EQ(risk.check_pre_trade_risk(order(0, 10000, 51)), RejectReason::ORDER_NOTIONAL);
+    EXPECT_EQ(risk.check_pre_trade_risk(order(4, 10000, 1)), RejectReason::UNKNOWN_ACCOUNT);
+
+    // The collar only applies once there is a last trade, here 100.00
+    EXPECT_EQ(risk.check_pre_trade_risk(order(0, 20000, 1, TimeInForce::IOC)), RejectReason::NONE);
+    risk.update_on_trade(fill(1, symbol, 0, 1, 100.0, 100));
+    EXPECT_EQ(risk.check_pre_trade_risk(order(0, 10101, 1, TimeInForce::IOC)), RejectReason::PRICE_COLLAR);
+    EXPECT_EQ(risk.check_pre_trade_risk(order(0, 9900, 1, TimeInForce::IOC)), RejectReason::NONE);
+
+    // IOC orders reserve nothing; a resting order's quantity stays working
+    EXPECT_EQ(risk.open_quantity(0, symbol, OrderSide::BUY), 0);
+    EXPECT_EQ(risk.check_pre_trade_risk(order(0, 10000, 10)), RejectReason::NONE);
+    EXPECT_EQ(risk.open_quantity(0, symbol, OrderSide::BUY), 10);
+    EXPECT_EQ(risk.check_pre_trade_risk(order(0, 10000, 1, TimeInForce::IOC)), RejectReason::ORDER_RATE);
+
+    // Held 100 plus 10 working leaves room for 10 more
+    Order next_second = order(0, 10000, 11);
+    next_second.timestamp += std::chrono::seconds(1);
+    EXPECT_EQ(risk.check_pre_trade_risk(next_second), RejectReason::POSITION_LIMIT);
+    next_second.quantity = 10;
+    EXPECT_EQ(risk.check_pre_trade_risk(next_second), RejectReason::NONE);
+    EXPECT_EQ(risk.open_quantity(0, symbol, OrderSide::BUY), 20);
+    risk.release_open_quantity(0, symbol, OrderSide::BUY, 100);
+    EXPECT_EQ(risk.open_quantity(0, symbol, OrderSide::BUY), 0);
+}
+
+// An account throttled by its own rate limit leaves the symbol's budget to others
+TEST(RiskEngineTest, ThrottledAccountKeepsSymbolBudget) {
+    RiskEngine risk(1000.0, RiskEngine::kDefaultMaxSymbols, 4);
+    const SymbolId symbol = SymbolTable::instance().intern("RISK-TEST-RATE");
+    SymbolLimits limits;
+    limits.max_orders_per_second = 5;
+    ASSERT_TRUE(risk.set_symbol_limits(symbol, limits));
+    AccountLimits throttled;
+    throttled.max_orders_per_second = 2;
+    ASSERT_TRUE(risk.set_account_limits(1, throttled));
+
+    const auto second = std::chrono::system_clock::time_point(std::chrono::seconds(1700000000));
+    auto order = [&](AccountId account_id) {
+        Order o(1, symbol, OrderType::LIMIT, OrderSide::BUY, 10000, 1);
+        o.account_id = account_id;
+        o.time_in_force = TimeInForce::IOC;
+        o.timestamp = second;
+        return o;
+    };
+    int admitted = 0;
+    for (int i = 0; i < 10; ++i) {
+        admitted += risk.check_pre_trade_risk(order(1)) == RejectReason::NONE;
+    }
+    EXPECT_EQ(admitted, 2);
+
+    // The symbol allows five a second; account 1 used two of them
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(risk.check_pre_trade_risk(order(2)), RejectReason::NONE);
+    }
+    EXPECT_EQ(risk.check_pre_trade_risk(order(2)), RejectReason::ORDER_RATE);
+}
+
+// Readers on other threads always see a position the writer actually stored
+TEST(RiskEngineTest, ReadersSeeConsistentPositions) {
+    RiskEngine risk(1e12);
+    const SymbolId symbol = SymbolTable::instance().intern("RISK-TEST-SEQ");
+    constexpr int kTrades = 100000;
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+
+    // Every fill is a buy at 100, so any consistent copy has avg 100 and no P&L
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 2; ++r) {
+        readers.emplace_back([&]() {
+            while (!done.load(std::memory_order_acquire)) {
+                if (auto position = risk.get_position(0, symbol)) {
+                    torn += position->avg_entry_price != 100.0 || position->realized_pnl != 0.0 ||
+                            position->net_position <= 0;
+                }
+                torn += risk.check_pre_trade_risk(order_for(symbol, OrderSide::BUY, 1)) != RejectReason::NONE;
+            }
+        });
+    }
+    for (int i = 0; i < kTrades; ++i) {
+        risk.update_on_trade(fill(i, symbol, 0, 1, 100.0, 1));
+    }
+    done.store(true, std::memory_order_release);
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(torn.load(), 0);
+    EXPECT_EQ(risk.get_position(0, symbol)->net_position, kTrades);
+}
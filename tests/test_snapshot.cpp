@@ -0,0 +1,224 @@
+#include <gtest/gtest.h>
+#include "order_book/BookManager.h"
+#include "persistence/Snapshot.h"
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+// Fresh directory per test, removed on exit
+class SnapshotTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = std::filesystem::temp_directory_path() /
+               ("snapshot-test-" + std::to_string(getpid()) + "-" +
+                ::testing::UnitTest::GetInstance()->current_test_info()->name());
+        std::filesystem::remove_all(dir_);
+        std::filesystem::create_directories(dir_);
+    }
+    void TearDown() override { std::filesystem::remove_all(dir_); }
+
+    std::filesystem::path dir_;
+};
+
+BookManagerConfig journaled_config(const std::string& dir) {
+    BookManagerConfig config;
+    config.num_shards = 2;
+    config.queue_capacity = 1024;
+    config.pin_threads = false;
+    config.journal_dir = dir;
+    config.journal_config.initial_records = 16;
+    return config;
+}
+
+OrderCommand limit(SymbolId symbol_id, uint64_t id, OrderSide side, Price price, uint64_t quantity) {
+    return OrderCommand::new_order(Order(id, symbol_id, OrderType::LIMIT, side, price, quantity));
+}
+
+} // namespace
+
+// A book restored from its snapshot keeps partial fills and FIFO order
+TEST_F(SnapshotTest, BookRoundTripsThroughFile) {
+    OrderBook book;
+    std::vector<Trade> trades;
+    book.on_trade([&](const Trade& trade) { trades.push_back(trade); });
+    book.add_order(Order(1, 0, OrderType::LIMIT, OrderSide::BUY, 100, 5));
+    book.add_order(Order(2, 0, OrderType::LIMIT, OrderSide::BUY, 100, 3));
+    book.add_order(Order(3, 0, OrderType::LIMIT, OrderSide::SELL, 100, 2));
+    book.add_order(Order(4, 0, OrderType::LIMIT, OrderSide::SELL, 105, 7));
+
+    Snapshot snapshot;
+    snapshot.journal_segments = {12, 34};
+    snapshot.max_order_id = 4;
+    snapshot.books.push_back(Snapshot::Book{"SNAP-BOOK", book.snapshot()});
+    snapshot.positions.push_back(Position{3, "SNAP-BOOK", -2, 1.0, 0.5});
+    const std::string path = (dir_ / "snapshot.bin").string();
+    std::string error;
+    ASSERT_TRUE(write_snapshot(path, snapshot, error)) << error;
+
+    Snapshot loaded;
+    ASSERT_TRUE(read_snapshot(path, loaded, error)) << error;
+    EXPECT_EQ(loaded.journal_segments, snapshot.journal_segments);
+    EXPECT_EQ(loaded.max_order_id, 4);
+    ASSERT_EQ(loaded.positions.size(), 1);
+    EXPECT_EQ(loaded.positions[0].account_id, 3);
+    EXPECT_EQ(loaded.positions[0].net_position, -2);
+    EXPECT_DOUBLE_EQ(loaded.positions[0].realized_pnl, 0.5);
+    ASSERT_EQ(loaded.books.size(), 1);
+
+    OrderBook restored;
+    ASSERT_TRUE(restored.restore(loaded.books[0].state));
+    EXPECT_EQ(restored.get_depth(OrderSide::BUY), book.get_depth(OrderSide::BUY));
+    EXPECT_EQ(restored.get_depth(OrderSide::SELL), book.get_depth(OrderSide::SELL));
+
+    // Order 1 (3 left) is still ahead of order 2, and trade ids carry on
+    std::vector<Trade> restored_trades;
+    restored.on_trade([&](const Trade& trade) { restored_trades.push_back(trade); });
+    restored.add_order(Order(5, 0, OrderType::LIMIT, OrderSide::SELL, 100, 4));
+    ASSERT_EQ(restored_trades.size(), 2);
+    EXPECT_EQ(restored_trades[0].resting_order_id, 1);
+    EXPECT_EQ(restored_trades[0].quantity, 3);
+    EXPECT_EQ(restored_trades[0].trade_id, trades.back().trade_id + 1);
+    EXPECT_EQ(restored_trades[1].resting_order_id, 2);
+
+    // Corruption is detected rather than loaded
+    {
+        FILE* file = std::fopen(path.c_str(), "r+b");
+        ASSERT_NE(file, nullptr);
+        std::fseek(file, 20, SEEK_SET);
+        std::fputc(0x5a, file);
+        std::fclose(file);
+    }
+    EXPECT_FALSE(read_snapshot(path, loaded, error));
+}
+
+// A restored order keeps its self-trade prevention mode, so a modify that
+// crosses its own account's order is still prevented
+TEST_F(SnapshotTest, RestoredOrdersKeepSelfTradePrevention) {
+    OrderBook book;
+    Order ask(1, 0, OrderType::LIMIT, OrderSide::SELL, 100, 5);
+    ask.account_id = 7;
+    Order bid(2, 0, OrderType::LIMIT, OrderSide::BUY, 95, 4);
+    bid.account_id = 7;
+    bid.self_trade_prevention = SelfTradePrevention::CANCEL_AGGRESSOR;
+    ASSERT_TRUE(book.add_order(ask));
+    ASSERT_TRUE(book.add_order(bid));
+
+    Snapshot snapshot;
+    snapshot.books.push_back(Snapshot::Book{"SNAP-STP", book.snapshot()});
+    const std::string path = (dir_ / "snapshot.bin").string();
+    std::string error;
+    ASSERT_TRUE(write_snapshot(path, snapshot, error)) << error;
+    Snapshot loaded;
+    ASSERT_TRUE(read_snapshot(path, loaded, error)) << error;
+    ASSERT_EQ(loaded.books.size(), 1);
+
+    OrderBook restored;
+    ASSERT_TRUE(restored.restore(loaded.books[0].state));
+    std::vector<Trade> trades;
+    restored.on_trade([&](const Trade& trade) { trades.push_back(trade); });
+    EXPECT_TRUE(restored.modify_order(bid.id, 100, 4));
+
+    // The bid is cancelled instead of trading with its own account's ask
+    EXPECT_TRUE(trades.empty());
+    EXPECT_EQ(restored.remaining_quantity(bid.id), 0);
+    EXPECT_EQ(restored.remaining_quantity(ask.id), 5);
+}
+
+// Recovery loads the snapshot and replays only the journal written after it
+TEST_F(SnapshotTest, RecoveryReplaysOnlyTheTail) {
+    {
+        BookManager manager(journaled_config(dir_.string()));
+        SymbolId btc = manager.add_symbol("SNAP-BTC");
+        SymbolId eth = manager.add_symbol("SNAP-ETH");
+        manager.start();
+        ASSERT_TRUE(manager.submit(limit(btc, 1, OrderSide::BUY, 10000, 5)));
+        ASSERT_TRUE(manager.submit(limit(btc, 2, OrderSide::SELL, 10000, 2)));
+        ASSERT_TRUE(manager.submit(limit(eth, 3, OrderSide::SELL, 500, 7)));
+        while (manager.processed() < 3) {
+            std::this_thread::yield();
+        }
+
+        std::string error;
+        ASSERT_TRUE(manager.save_snapshot(
+            [](Snapshot& snapshot) { snapshot.positions.push_back(Position{0, "SNAP-BTC", 2, 100.0, 0.0}); }, error))
+            << error;
+
+        ASSERT_TRUE(manager.submit(limit(btc, 4, OrderSide::SELL, 10000, 1)));
+        ASSERT_TRUE(manager.submit(OrderCommand::cancel(eth, 3)));
+        manager.stop();
+    }
+
+    BookManager manager(journaled_config(dir_.string()));
+    SymbolId btc = manager.add_symbol("SNAP-BTC");
+    SymbolId eth = manager.add_symbol("SNAP-ETH");
+    std::vector<Position> restored_positions;
+    std::vector<Trade> replayed_trades;
+    const RecoveryStats stats = manager.recover(
+        [&](const Trade& trade) { replayed_trades.push_back(trade); },
+        [&](const Snapshot& snapshot) { restored_positions = snapshot.positions; });
+
+    // Only the order, its trade and the cancel after the snapshot are replayed
+    EXPECT_EQ(stats.records, 3);
+    EXPECT_EQ(stats.max_order_id, 4);
+    ASSERT_EQ(restored_positions.size(), 1);
+    EXPECT_EQ(restored_positions[0].net_position, 2);
+    ASSERT_EQ(replayed_trades.size(), 1);
+    EXPECT_EQ(replayed_trades[0].aggressive_order_id, 4);
+    EXPECT_EQ(replayed_trades[0].trade_id, 2);
+
+    auto btc_bids = manager.book(btc)->get_depth(OrderSide::BUY);
+    ASSERT_EQ(btc_bids.size(), 1);
+    EXPECT_EQ(btc_bids[0].second, 2);
+    EXPECT_EQ(manager.book(eth)->live_orders(), 0);
+}
+
+// Each snapshot moves the journals to new segments and deletes the ones it
+// covers, so recovery never rereads history the snapshot already holds
+TEST_F(SnapshotTest, SnapshotStartsNewJournalSegments) {
+    const auto journal_files = [this]() {
+        std::vector<std::string> names;
+        for (const auto& entry : std::filesystem::directory_iterator(dir_)) {
+            if (entry.path().extension() == ".journal") {
+                names.push_back(entry.path().filename().string());
+            }
+        }
+        std::sort(names.begin(), names.end());
+        return names;
+    };
+    {
+        BookManager manager(journaled_config(dir_.string()));
+        SymbolId btc = manager.add_symbol("SEG-BTC");
+        manager.start();
+        std::string error;
+        for (uint64_t id = 1; id <= 2; ++id) {
+            ASSERT_TRUE(manager.submit(limit(btc, id, OrderSide::BUY, 10000 - static_cast<Price>(id), 1)));
+            while (manager.processed() < id) {
+                std::this_thread::yield();
+            }
+            ASSERT_TRUE(manager.save_snapshot(nullptr, error)) << error;
+        }
+        EXPECT_EQ(journal_files(), (std::vector<std::string>{"shard-0-2.journal", "shard-1-2.journal"}));
+        ASSERT_TRUE(manager.submit(OrderCommand::cancel(btc, 1)));
+        manager.stop();
+    }
+
+    BookManager manager(journaled_config(dir_.string()));
+    SymbolId btc = manager.add_symbol("SEG-BTC");
+    const RecoveryStats stats = manager.recover(nullptr);
+
+    // Only the cancel after the second snapshot is replayed
+    EXPECT_EQ(stats.records, 1);
+    EXPECT_EQ(stats.max_order_id, 2);
+    auto bids = manager.book(btc)->get_depth(OrderSide::BUY);
+    ASSERT_EQ(bids.size(), 1);
+    EXPECT_DOUBLE_EQ(bids[0].first, 99.98);
+
+    // Journaling carries on in the newest segment
+    manager.start();
+    manager.stop();
+    EXPECT_EQ(journal_files(), (std::vector<std::string>{"shard-0-2.journal", "shard-1-2.journal"}));
+}
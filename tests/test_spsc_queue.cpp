@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+#include "common/SpscQueue.h"
+#include <thread>
+#include <vector>
+
+// A full ring drops the newest value and counts the overflow
+TEST(SpscQueueTest, DropNewestCountsOverflow) {
+    SpscQueue<int> queue(4);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.push(i, OverflowPolicy::DROP_NEWEST));
+    }
+    EXPECT_FALSE(queue.push(99, OverflowPolicy::DROP_NEWEST));
+    EXPECT_FALSE(queue.push(100, OverflowPolicy::DROP_NEWEST));
+    EXPECT_EQ(queue.overflow_count(), 2);
+
+    int values[8];
+    ASSERT_EQ(queue.try_pop_batch(values, 8), 4);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(values[i], i);
+    }
+    EXPECT_TRUE(queue.empty());
+}
+
+// Batches drained on another thread see every value exactly once and in order
+TEST(SpscQueueTest, BatchDrainAcrossThreads) {
+    constexpr int kCount = 200000;
+    SpscQueue<int> queue(1024);
+
+    std::thread producer([&]() {
+        for (int i = 0; i < kCount; ++i) {
+            queue.push(i, OverflowPolicy::SPIN);
+        }
+    });
+
+    std::vector<int> batch(64);
+    int expected = 0;
+    Backoff backoff;
+    while (expected < kCount) {
+        const size_t count = queue.try_pop_batch(batch.data(), batch.size());
+        if (count == 0) {
+            backoff.idle();
+            continue;
+        }
+        backoff.reset();
+        for (size_t i = 0; i < count; ++i) {
+            ASSERT_EQ(batch[i], expected++);
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(queue.empty());
+}
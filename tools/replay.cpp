@@ -0,0 +1,256 @@
+#include "common/LatencyHistogram.h"
+#include "common/Logger.h"
+#include "order_book/OrderBook.h"
+#include "replay/OrderFlow.h"
+#include "risk/RiskEngine.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Headless driver: replays a recorded order flow straight into per-symbol
+// OrderBooks and the RiskEngine as fast as possible, without the websocket,
+// and reports per-stage latency plus a checksum of the resulting trades.
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Stage {
+    explicit Stage(const char* stage_name) : name(stage_name) {}
+
+    const char* name;
+    LatencyHistogram latency;
+    double seconds = 0;
+};
+
+uint64_t elapsed_ns(Clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+}
+
+void print_stage(const Stage& stage) {
+    const LatencyHistogram& h = stage.latency;
+    std::printf("  %-22s %10llu ops %12.0f ops/s   p50 %6llu ns  p99 %6llu ns  p99.9 %7llu ns  max %8llu ns\n",
+                stage.name, static_cast<unsigned long long>(h.count()),
+                stage.seconds > 0 ? static_cast<double>(h.count()) / stage.seconds : 0.0,
+                static_cast<unsigned long long>(h.percentile(50)), static_cast<unsigned long long>(h.percentile(99)),
+                static_cast<unsigned long long>(h.percentile(99.9)), static_cast<unsigned long long>(h.max()));
+}
+
+void usage() {
+    std::fprintf(stderr,
+                 "Usage: ReplayTool <flow.csv> [--tick-size X] [--max-position N] [--expect-checksum HEX] [--log]\n"
+                 "       ReplayTool --generate <flow.csv> <events> [--seed N]\n");
+}
+
+int generate(int argc, char** argv) {
+    if (argc < 4) {
+        usage();
+        return 2;
+    }
+    uint64_t seed = 42;
+    for (int i = 4; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--seed") == 0) {
+            seed = std::strtoull(argv[i + 1], nullptr, 10);
+        }
+    }
+    const size_t count = std::strtoull(argv[3], nullptr, 10);
+    const auto flow = generate_order_flow(count, seed, {"BTC-USD", "ETH-USD", "SOL-USD"});
+    if (!save_order_flow(argv[2], OrderBookConfig().tick_size, flow)) {
+        std::fprintf(stderr, "Cannot write %s\n", argv[2]);
+        return 1;
+    }
+    std::printf("Wrote %zu events to %s\n", flow.size(), argv[2]);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage();
+        return 2;
+    }
+    if (std::strcmp(argv[1], "--generate") == 0) {
+        return generate(argc, argv);
+    }
+
+    OrderBookConfig book_config;
+    book_config.synchronized = false; // One thread drives every book
+    double max_position = 1e18;
+    const char* expected_checksum = nullptr;
+    bool keep_logging = false;
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--tick-size") == 0 && i + 1 < argc) {
+            book_config.tick_size = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--max-position") == 0 && i + 1 < argc) {
+            max_position = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--expect-checksum") == 0 && i + 1 < argc) {
+            expected_checksum = argv[++i];
+        } else if (std::strcmp(argv[i], "--log") == 0) {
+            keep_logging = true;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    // The risk engine logs every check at INFO, which would dominate the timings
+    if (keep_logging) {
+        Logger::instance().start();
+    } else {
+        Logger::instance().set_level(LogLevel::WARN);
+    }
+
+    Stage load{"load + decode"};
+    std::vector<OrderCommand> flow;
+    std::string error;
+    const auto load_start = Clock::now();
+    if (!load_order_flow(argv[1], book_config.tick_size, flow, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    const uint64_t load_ns = elapsed_ns(load_start);
+    load.seconds = static_cast<double>(load_ns) * 1e-9;
+
+    Stage risk_check{"risk check"};
+    Stage book_add{"book add (+ matching)"};
+    Stage book_cancel{"book cancel"};
+    Stage book_modify{"book modify"};
+    Stage risk_update{"risk update per trade"};
+
+    RiskEngine risk(max_position);
+    TradeChecksum checksum;
+    std::vector<std::unique_ptr<OrderBook>> books(SymbolTable::instance().size());
+    // Trades are reported synchronously from add_order, so the command being
+    // applied identifies the aggressor
+    const OrderCommand* current = nullptr;
+
+    // Quantity each accepted resting order still has working, so fills and
+    // cancels can hand it back to the risk engine's open-order exposure
+    struct Working {
+        AccountId account_id;
+        OrderSide side;
+        uint64_t quantity;
+    };
+    std::unordered_map<uint64_t, Working> working;
+    auto release_working = [&](uint64_t order_id, uint64_t quantity) {
+        auto it = working.find(order_id);
+        if (it == working.end()) {
+            return;
+        }
+        quantity = std::min(quantity, it->second.quantity);
+        risk.release_open_quantity(it->second.account_id, current->symbol_id, it->second.side, quantity);
+        if ((it->second.quantity -= quantity) == 0) {
+            working.erase(it);
+        }
+    };
+
+    auto on_trade = [&](const Trade& trade) {
+        checksum.add(trade);
+        const auto start = Clock::now();
+        risk.update_on_trade(trade);
+        risk_update.latency.record(elapsed_ns(start));
+        release_working(trade.resting_order_id, trade.quantity);
+        release_working(trade.aggressive_order_id, trade.quantity);
+    };
+
+    uint64_t rejected = 0;
+    uint64_t self_trade_cuts = 0;
+    const auto replay_start = Clock::now();
+    for (const OrderCommand& command : flow) {
+        current = &command;
+        std::unique_ptr<OrderBook>& book = books[command.symbol_id];
+        if (!book) {
+            book = std::make_unique<OrderBook>(book_config);
+            book->on_trade(on_trade);
+            book->on_self_trade_cancel([&](const SelfTradeCancel& cancel) {
+                ++self_trade_cuts;
+                release_working(cancel.order_id, cancel.quantity);
+            });
+        }
+
+        if (command.type == CommandType::CANCEL) {
+            const auto start = Clock::now();
+            book->cancel_order(command.order_id);
+            book_cancel.latency.record(elapsed_ns(start));
+            release_working(command.order_id, UINT64_MAX);
+            continue;
+        }
+        if (command.type == CommandType::MODIFY) {
+            // A smaller order hands the difference back up front so any fills
+            // from a crossing reprice come out of the new size; increases are
+            // not re-checked against the limits here
+            auto it = working.find(command.order_id);
+            if (it != working.end() && command.quantity < it->second.quantity) {
+                release_working(command.order_id, it->second.quantity - command.quantity);
+            }
+            const auto start = Clock::now();
+            book->modify_order(command.order_id, command.price, command.quantity);
+            book_modify.latency.record(elapsed_ns(start));
+            continue;
+        }
+
+        const Order order = command.to_order();
+        auto start = Clock::now();
+        const bool passed = risk.check_pre_trade_risk(order) == RejectReason::NONE;
+        risk_check.latency.record(elapsed_ns(start));
+        if (!passed) {
+            ++rejected;
+            continue;
+        }
+        // A duplicate id is refused by the book, so only its own reservation goes back
+        const bool rests = order.type == OrderType::LIMIT && order.time_in_force == TimeInForce::GTC;
+        const bool tracked =
+            rests && working.emplace(order.id, Working{order.account_id, order.side, order.quantity}).second;
+        start = Clock::now();
+        const bool added = book->add_order(order);
+        book_add.latency.record(elapsed_ns(start));
+        if (!added) {
+            ++rejected;
+            if (tracked) {
+                release_working(order.id, UINT64_MAX);
+            } else if (rests) {
+                risk.release_open_quantity(order.account_id, order.symbol_id, order.side, order.quantity);
+            }
+        }
+    }
+    const double replay_seconds = static_cast<double>(elapsed_ns(replay_start)) * 1e-9;
+    if (keep_logging) {
+        Logger::instance().stop();
+    }
+
+    // Stage throughput is measured against the time spent inside that stage
+    for (Stage* stage : {&risk_check, &book_add, &book_cancel, &book_modify, &risk_update}) {
+        stage->seconds = stage->latency.mean() * static_cast<double>(stage->latency.count()) * 1e-9;
+    }
+
+    std::printf("Replayed %zu events from %s in %.3f s (%.0f events/s end to end)\n", flow.size(), argv[1],
+                replay_seconds, replay_seconds > 0 ? static_cast<double>(flow.size()) / replay_seconds : 0.0);
+    std::printf("  %-22s %10zu events %9.0f events/s\n", load.name, flow.size(),
+                load.seconds > 0 ? static_cast<double>(flow.size()) / load.seconds : 0.0);
+    print_stage(risk_check);
+    print_stage(book_add);
+    print_stage(book_cancel);
+    print_stage(book_modify);
+    print_stage(risk_update);
+    std::printf("Rejected orders: %llu\n", static_cast<unsigned long long>(rejected));
+    std::printf("Self-trade prevention cuts: %llu\n", static_cast<unsigned long long>(self_trade_cuts));
+    std::printf("Trades: %llu, checksum: %016llx\n", static_cast<unsigned long long>(checksum.count()),
+                static_cast<unsigned long long>(checksum.value()));
+
+    if (expected_checksum) {
+        const uint64_t expected = std::strtoull(expected_checksum, nullptr, 16);
+        if (expected != checksum.value()) {
+            std::fprintf(stderr, "Checksum mismatch: expected %016llx\n", static_cast<unsigned long long>(expected));
+            return 1;
+        }
+        std::printf("Checksum matches.\n");
+    }
+    return 0;
+}